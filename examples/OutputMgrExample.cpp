@@ -19,6 +19,9 @@ using std::cout;
 using std::endl;
 #include <exception>
 #include <memory>
+#include <algorithm>
+#include <vector>
+#include <map>
 
 #include "MTBMPI.h"
 using mtbmpi::StrVec;
@@ -75,9 +78,9 @@ class WorkTask : public mtbmpi::TaskAdapterBase		// Does the work
 	// try to make the tasks finish in order of their rank
 	mtbmpi::Sleep( 1e5 * GetParent().GetID() );
 
-	std::ostringstream os;
-	os << "results: ratio * id = " << ( ratio * parent.GetID() );
-	SendToOutput( os.str() );
+	SendToOutput( ratio * parent.GetID() );
+	if ( !parent.IsHosted() )	// a task thread of a TaskHost cannot stream
+	    StreamToOutput( 3 * 1024 * 1024 + parent.GetID() );
 
 	state = mtbmpi::State_Completed;
 	return state;
@@ -109,17 +112,23 @@ class WorkTask : public mtbmpi::TaskAdapterBase		// Does the work
 	parent.SendMsgToLog ( msg );
     }
 
-    void SendToOutput ( std::string const & msg )
+    void SendToOutput ( double const result )
     {
-	static int const tag = mtbmpi::Tag_TaskResults;
-	int const destID = GetParent().GetBlackboardID();
-
-	std::string outputMsg = msg;
-	mtbmpi::LogMessage logMsg;
-	logMsg.Message( outputMsg, parent.GetID() );
+	// binary record: rank, result
+	mtbmpi::BinaryWriter writer;
+	writer << parent.GetID() << result;
+	parent.SendResultRecord( writer.Data(), writer.Size() );	// through the host, if hosted
+    }
 
-	mtbmpi::comm.Send ( outputMsg.data(), outputMsg.size(), MPI::CHAR, destID, tag );
-	mtbmpi::CheckErrorMPI( className );
+    void StreamToOutput ( long long const numBytes )
+    {
+	// a large result is sent in chunks, without copying it to the Blackboard in one message
+	std::vector<char> block ( 64 * 1024, static_cast<char>( parent.GetID() ) );
+	mtbmpi::ResultStream stream ( mtbmpi::resultComm, GetParent().GetBlackboardID() );
+	stream.Begin( parent.GetID(), numBytes );
+	for ( long long sent = 0; sent < numBytes; sent += block.size() )
+	    stream.Write( block.data(), std::min<long long>( block.size(), numBytes - sent ) );
+	stream.End();
     }
 };
 
@@ -156,6 +165,36 @@ class OutputSink : public mtbmpi::OutputAdapterBase		// Writes output from tasks
     {
 	cout << msg << endl;
     }
+
+  private:
+
+    // streams from several tasks can be interleaved; key = source rank
+    std::map< int, std::pair<long long, long long> > streams;	// bytes, checksum
+
+    virtual void DoBeginResult ( int const source, long long const streamID, long long const totalSize )
+    {
+	streams[source] = std::make_pair( 0LL, 0LL );
+    }
+
+    virtual void DoAcceptResultChunk (
+	int const source, long long const streamID, long long const offset,
+	char const * const data, std::size_t const size )
+    {
+	std::pair<long long, long long> & stream = streams[source];
+	stream.first += size;
+	for ( std::size_t i = 0; i < size; ++i )
+	    stream.second += data[i];
+    }
+
+    virtual void DoEndResult ( int const source, long long const streamID, bool const isComplete )
+    {
+	std::ostringstream os;
+	os << "result stream " << streamID << " from rank " << source
+	   << ( isComplete ? ": complete: " : ": incomplete: " )
+	   << streams[source].first << " bytes, checksum " << streams[source].second;
+	Write( os.str() );
+	streams.erase( source );
+    }
 };
 
 class OutputFactory : public mtbmpi::OutputFactoryBase		// Makes OutputSink
@@ -183,15 +222,22 @@ class OutputMgr : public mtbmpi::OutputMgr			// Receives output from tasks
     {
     }
 
-    virtual void HandleOutputMessage (
-	MPI::Intracomm & comm,			// MPI communicator with message
-	MPI::Status const & status )		// Status contains source ID and message tag
+    virtual void HandleOutputRecord (
+	int const source,			// rank of sender
+	int const tag,				// message tag
+	char const * const data,		// message bytes
+	int const size )			// number of bytes
     {
-	MPI::Status recvStatus;
-	int const count = status.Get_count (MPI::CHAR);
-	std::string buffer( count + 1, mtbmpi::NULL_CHAR );
-	mtbmpi::comm.Recv( &buffer[0], count, MPI::CHAR, status.Get_source(), status.Get_tag(), recvStatus );
-	std::string msg (buffer.begin(), buffer.begin() + count);
+	int id = 0;
+	double result = 0.0;
+	mtbmpi::BinaryReader reader ( data, size );
+	reader >> id >> result;
+
+	std::ostringstream os;
+	os << "results: ratio * id = " << result;
+	std::string msg = os.str();
+	mtbmpi::LogMessage logMsg;
+	logMsg.Message( msg, id );
 	pOutput->Write( msg );
     }
 
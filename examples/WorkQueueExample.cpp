@@ -0,0 +1,185 @@
+//------------------------------------------------------------------------------------------------------------
+// File: WorkQueueExample.cpp
+// Example of the MTBMPI MPI framework running a work queue (task farm):
+// many more work items than work tasks.
+// Build:
+//	mpicxx -I../src -o WorkQueueExample -g WorkQueueExample.cpp  ../build/cmake/libmtbmpi.debug.a
+// Run:
+//	mpiexec -n 4 ./WorkQueueExample [number of work items]
+//	mpiexec -n 40 ./WorkQueueExample 1000 --mtbmpi-subcontroller-tasks=8
+//
+// project	Master-Task-Blackboard MPI Framework
+// author	Thomas E. Hilinski <https://github.com/tehilinski>
+// copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+// 		This software library, including source code and documentation,
+// 		is licensed under the Apache License version 2.0.
+// 		See "LICENSE.md" for more information.
+//------------------------------------------------------------------------------------------------------------
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <exception>
+#include <memory>
+#include <cstdlib>
+
+#include "MTBMPI.h"
+using mtbmpi::StrVec;
+
+//------------------------------------------------------------------------------------------------------------
+//	Task
+//------------------------------------------------------------------------------------------------------------
+
+class WorkTask : public mtbmpi::TaskAdapterBase			// Does the work for one item
+{
+  public:
+
+    typedef mtbmpi::State		State;
+
+    WorkTask (
+      mtbmpi::Task & useParent,
+      std::string const & taskName,
+      StrVec const & cmdLineArgs)
+      : mtbmpi::TaskAdapterBase (useParent, taskName, cmdLineArgs),
+	limit ( 0 )
+    {
+    }
+
+  private:
+
+    long limit;
+
+    virtual State DoInitializeTask ()
+    {
+	// the work item's 1st string is the loop limit
+	mtbmpi::WorkItem const & item = parent.GetWorkItem();
+	if ( item.GetArgs().empty() )
+	    return mtbmpi::State_Error;
+	limit = std::atol( item.GetArgs()[0].c_str() );
+	return mtbmpi::State_Initialized;
+    }
+
+    virtual State DoStartTask ()
+    {
+	// do something time consuming
+	float sumA = 0.0f;
+	float sumI = 0.0f;
+	for ( long i = 0; i < limit; ++i )
+	{
+	    float a = i;
+	    a = (a * a) / (float)(limit - 1.0f) + 0.5f;
+	    sumA += a;
+	    sumI += (float)i;
+	}
+	float const ratio = sumA / sumI;
+
+	std::ostringstream os;
+	os << "WorkTask: item " << parent.GetWorkItem().GetIndex() << ": ratio = " << ratio;
+	parent.SendMsgToLog ( os.str() );
+	return mtbmpi::State_Completed;
+    }
+
+    virtual State DoStopTask ()   { return mtbmpi::State_Terminated; }
+    virtual State DoPauseTask ()  { return mtbmpi::State_Paused; }
+    virtual State DoResumeTask () { return mtbmpi::State_Running; }
+};
+
+class WorkTaskFactory : public mtbmpi::TaskFactoryBase		// Makes WorkTask
+{
+  public:
+
+    typedef mtbmpi::TaskFactoryBase::TaskAdapterPtr	TaskAdapterPtr;
+
+    virtual TaskAdapterPtr Create (
+      mtbmpi::Task & parent,
+      std::string const & taskName,
+      StrVec const & cmdLineArgs)
+    {
+	return TaskAdapterPtr ( new WorkTask (parent, taskName, cmdLineArgs) );
+    }
+};
+
+//------------------------------------------------------------------------------------------------------------
+
+class WorkMaster : public mtbmpi::Master
+{
+  public:
+
+    WorkMaster (
+      int    argc,
+      char** argv,
+      TaskFactoryPtr     useTaskFactory,
+      std::string const  logFileName = "WorkQueueExample.log")
+      : mtbmpi::Master (
+	    argc, argv, 3, cout,
+	    useTaskFactory,					// makes Tasks
+	    std::make_shared< mtbmpi::OutputMgr_NoOp >(),	// A no-op object; no output generated
+	    std::make_shared< mtbmpi::MpiCollectiveCB_NoOp >(),
+	    logFileName )
+    {
+	Initialize ();
+    }
+
+  private:
+
+    void Initialize ()
+    {
+	if ( GetID() == GetControllerID() )
+	{
+	    if ( IsInitialized() )
+	    {
+		// fill the work queue, then run the event loop
+		StrVec const & args = GetConfiguration().GetArgs();	// without framework options
+		long const numItems = ( !args.empty() ? std::atol( args[0].c_str() ) : 100L );
+		for ( long i = 0; i < numItems; ++i )
+		{
+		    StrVec args;
+		    args.push_back( mtbmpi::ToString( 10000L * (1 + i % 10) ) );
+		    GetController().GetWorkQueue().Add( args );
+		}
+		GetController().Activate();	// event loop
+	    }
+	}
+    }
+
+    // Derived class actions called by controller
+    virtual void DoActionsBeforeTasks () {}
+    virtual void DoActionsAtInitTasks () {}
+    virtual void DoActionsBeforeTasksStart () {}
+    virtual void DoActionsAfterTasks ()  {}
+    virtual void DoActionsWhileActive () {}
+};
+
+//------------------------------------------------------------------------------------------------------------
+
+int main (int argc, char **argv)
+{
+    std::unique_ptr<WorkMaster> pMpiTask;
+    try
+    {
+    	mtbmpi::Master::TaskFactoryPtr pTaskFactory ( new WorkTaskFactory() );
+ 	pMpiTask = std::make_unique<WorkMaster>( argc, argv, pTaskFactory );
+
+	if ( pMpiTask->GetID() == mtbmpi::Master::GetBlackboardID() )
+	{
+	    cout << "\nWorkQueueExample: MTBMPI framework example of a work queue." << endl;
+	    cout << "Log file name: "
+	         << pMpiTask->GetBlackboard().GetRunLogMgr().GetFileName()
+	         << endl;
+	    cout.flush();
+	}
+    }
+    catch (std::exception const & e)
+    {
+ 	int const id = (pMpiTask.get() ? pMpiTask->GetID() : -1);
+	cout << "main: rank = " << id
+	     << "Exception: " << e.what() << endl;
+    }
+
+    if ( pMpiTask && pMpiTask->GetID() == mtbmpi::Master::GetControllerID() )
+    {
+	mtbmpi::Sleep( 100000 ); 		// try to force this to appear last
+	cout << "   all done!" << endl;
+    }
+    return 0;
+}
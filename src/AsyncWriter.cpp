@@ -0,0 +1,136 @@
+/*------------------------------------------------------------------------------------------------------------
+file		AsyncWriter.cpp
+class		mtbmpi::AsyncWriter
+brief 		Writer thread which drains a bounded queue of records into a sink.
+details
+		The writer yields while the queue is briefly empty, then sleeps,
+		so an idle Blackboard does not use a core.
+		numWritten is released after each record is written, so the
+		producer's WaitUntilIdle sees the sink's changes.
+
+project		Master-Task-Blackboard MPI Framework
+author		Thomas E. Hilinski <https://github.com/tehilinski>
+copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#include "AsyncWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace mtbmpi {
+
+
+namespace {
+
+    int const spinsBeforeSleep = 64;	// yields while the queue is empty
+
+} // namespace
+
+
+std::size_t const AsyncWriter::defaultCapacity;
+
+
+AsyncWriter::AsyncWriter (
+    std::string const & writerName,
+    std::size_t const capacity,
+    WriteFunction writeFunction,
+    IdleFunction idleFunction)
+    : name ( writerName ),
+      queue ( std::max<std::size_t>( capacity, 2 ) ),
+      write ( writeFunction ),
+      idle ( idleFunction ),
+      numWritten ( 0 ),
+      stopRequested ( false ),
+      numPushed ( 0 ),
+      numBlocked ( 0 ),
+      numDropped ( 0 ),
+      maxDepth ( 0 )
+{
+    writer = std::thread( &AsyncWriter::Run, this );
+}
+
+AsyncWriter::~AsyncWriter ()
+{
+    Stop ();
+}
+
+bool AsyncWriter::Push (
+    Record & record,
+    bool const mayDrop)
+{
+    if ( !queue.TryPush( record ) )
+    {
+	if ( mayDrop )
+	{
+	    ++numDropped;
+	    return false;
+	}
+	++numBlocked;
+	while ( !queue.TryPush( record ) )
+	    std::this_thread::yield();
+    }
+    ++numPushed;
+    maxDepth = std::max( maxDepth, queue.Size() );
+    return true;
+}
+
+void AsyncWriter::WaitUntilIdle () const
+{
+    while ( numWritten.load( std::memory_order_acquire ) < numPushed )
+	std::this_thread::yield();
+}
+
+void AsyncWriter::Stop ()
+{
+    if ( !writer.joinable() )
+	return;
+    stopRequested.store( true );
+    writer.join();
+}
+
+std::string AsyncWriter::Summary () const
+{
+    std::ostringstream os;
+    os << name << ": " << numPushed << " records"
+       << ", max queue depth " << maxDepth << " of " << queue.Capacity()
+       << ", " << numBlocked << " blocked"
+       << ", " << numDropped << " dropped";
+    return os.str();
+}
+
+/// @cond SKIP_PRIVATE
+
+void AsyncWriter::Run ()
+{
+    Record record;
+    int spins = 0;
+    while ( true )
+    {
+	if ( queue.TryPop( record ) )
+	{
+	    write( record );
+	    numWritten.fetch_add( 1, std::memory_order_release );
+	    spins = 0;
+	    continue;
+	}
+	idle();
+	if ( stopRequested.load() )
+	{
+	    if ( queue.Size() == 0 )
+		break;
+	}
+	else if ( ++spins < spinsBeforeSleep )
+	    std::this_thread::yield();
+	else
+	    std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+    }
+}
+
+/// @endcond
+
+
+} // namespace mtbmpi
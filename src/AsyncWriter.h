@@ -0,0 +1,118 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		AsyncWriter.h
+@class		mtbmpi::AsyncWriter
+@brief 		Writer thread which drains a bounded queue of records into a sink.
+@details
+		Used by the Blackboard when the option `--mtbmpi-async-blackboard[=RECORDS]`
+		is given: the Blackboard's MPI thread receives messages and pushes
+		records into a BoundedQueue, and an AsyncWriter thread writes them
+		to the RunLogMgr or to the OutputMgr. The write function is called
+		for each record in order, and the idle function is called while the
+		queue is empty, so the sink can flush a batch of records on its own schedule.
+
+		Backpressure: when the queue is full, Push waits for the writer,
+		so the Blackboard stops receiving and senders wait in MPI;
+		or, if the record may be dropped, Push discards it.
+		The counters of records pushed, blocked pushes, dropped records,
+		and the largest queue depth are given by Summary.
+
+		The write and idle functions must not call MPI.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_AsyncWriter_h
+#define INC_mtbmpi_AsyncWriter_h
+
+#include "BoundedQueue.h"
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace mtbmpi {
+
+
+class AsyncWriter
+{
+  public:
+
+    /// A record from a message
+    struct Record
+    {
+	int source;			///< rank which sent the record
+	int tag;			///< message tag
+	std::string data;		///< text or bytes
+    };
+
+    typedef std::function<void (Record const &)>	WriteFunction;
+    typedef std::function<void ()>			IdleFunction;
+
+    static std::size_t const defaultCapacity = 4096;	///< records in the queue
+
+    /// Constructor; starts the writer thread
+    AsyncWriter (
+      std::string const & writerName,	///< name for the summary
+      std::size_t const capacity,	///< records in the queue
+      WriteFunction writeFunction,	///< called for each record
+      IdleFunction idleFunction );	///< called while the queue is empty
+
+    /// Destructor; calls Stop
+    ~AsyncWriter ();
+
+    /// Move a record into the queue.
+    /// If the queue is full, waits for the writer, or if mayDrop,
+    /// discards the record and returns false.
+    bool Push (
+      Record & record,			///< moved into the queue
+      bool const mayDrop = false );	///< discard if the queue is full
+
+    /// Wait until the writer has written all records pushed so far
+    void WaitUntilIdle () const;
+
+    /// Write the remaining records and end the writer thread
+    void Stop ();
+
+    unsigned long long GetNumPushed () const { return numPushed; }	///< records pushed
+    unsigned long long GetNumBlocked () const { return numBlocked; }	///< pushes which waited
+    unsigned long long GetNumDropped () const { return numDropped; }	///< records discarded
+    std::size_t GetMaxDepth () const { return maxDepth; }		///< largest queue depth
+
+    /// One line with the counters
+    std::string Summary () const;
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    std::string const name;
+    BoundedQueue<Record> queue;
+    WriteFunction write;
+    IdleFunction idle;
+    std::atomic<unsigned long long> numWritten;	// writer thread
+    std::atomic<bool> stopRequested;
+    unsigned long long numPushed;		// producer counters
+    unsigned long long numBlocked;
+    unsigned long long numDropped;
+    std::size_t maxDepth;
+    std::thread writer;
+
+    void Run ();			// writer thread
+
+    // functions that should not be used; are not defined
+    AsyncWriter (AsyncWriter const & object);
+    AsyncWriter & operator= (AsyncWriter const & object);
+
+    /// @endcond
+};
+
+
+} // namespace mtbmpi
+
+#endif // INC_mtbmpi_AsyncWriter_h
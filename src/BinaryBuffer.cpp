@@ -0,0 +1,124 @@
+/*------------------------------------------------------------------------------------------------------------
+file		BinaryBuffer.cpp
+class		mtbmpi::BinaryWriter, mtbmpi::BinaryReader
+brief 		Binary serialization of values for sending as MPI::BYTE messages.
+details
+		BinaryWriter appends values to a byte buffer, and BinaryReader
+		reads them back in the same order, so that numeric data is sent
+		as raw bytes instead of being formatted as text.
+
+project		Master-Task-Blackboard MPI Framework
+author		Thomas E. Hilinski <https://github.com/tehilinski>
+copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#include "BinaryBuffer.h"
+#include "ErrorHandling.h"
+#include "MatchedProbe.h"
+#include <stdexcept>
+#include <sstream>
+
+namespace mtbmpi {
+
+
+//--------------------------------------- BinaryWriter ---------------------------------------
+
+BinaryWriter & BinaryWriter::Write (
+    std::string const & value)
+{
+    Write( static_cast<std::uint64_t>( value.size() ) );
+    return WriteBytes( value.data(), value.size() );
+}
+
+BinaryWriter & BinaryWriter::WriteBytes (
+    void const * const data,
+    size_type const size)
+{
+    if ( size > 0 )
+    {
+	char const * const bytes = static_cast<char const *>(data);
+	buffer.insert( buffer.end(), bytes, bytes + size );
+    }
+    return *this;
+}
+
+void BinaryWriter::Send (
+    MPI::Intracomm & comm,
+    int const destination,
+    int const tag) const
+{
+    CheckNotHostedTaskThread( "mtbmpi::BinaryWriter::Send" );
+    comm.Send ( buffer.data(), buffer.size(), MPI::BYTE, destination, tag );
+    CheckErrorMPI( "mtbmpi::BinaryWriter" );
+}
+
+//--------------------------------------- BinaryReader ---------------------------------------
+
+BinaryReader & BinaryReader::Read (
+    std::string & value)
+{
+    std::uint64_t length = 0;
+    Read( length );
+    CheckAvailable( length );
+    value.assign( data + position, length );
+    position += length;
+    return *this;
+}
+
+BinaryReader & BinaryReader::ReadBytes (
+    void * const dest,
+    size_type const numBytes)
+{
+    CheckAvailable( numBytes );
+    if ( numBytes > 0 )
+	std::memcpy( dest, data + position, numBytes );
+    position += numBytes;
+    return *this;
+}
+
+/// @cond SKIP_PRIVATE
+
+void BinaryReader::CheckAvailable (
+    size_type const numBytes) const
+{
+    if ( numBytes > size - position )
+    {
+	std::ostringstream os;
+	os << "mtbmpi::BinaryReader: read of " << numBytes
+	   << " bytes at position " << position
+	   << " is past the end of the data (" << size << " bytes)";
+	throw std::runtime_error( os.str() );
+    }
+}
+
+/// @endcond
+
+//--------------------------------------- functions ---------------------------------------
+
+int ReceiveBytes (
+    MPI::Intracomm & comm,
+    MPI::Status const & status,
+    std::vector<char> & buffer)
+{
+    int const count = status.Get_count( MPI::BYTE );
+    buffer.resize( count );
+    comm.Recv ( buffer.data(), count, MPI::BYTE, status.Get_source(), status.Get_tag() );
+    return count;
+}
+
+int ReceiveBytes (
+    MPI_Message & message,
+    MPI::Status const & status,
+    std::vector<char> & buffer)
+{
+    int const count = status.Get_count( MPI::BYTE );
+    buffer.resize( count );
+    Mrecv ( buffer.data(), count, MPI::BYTE, message );
+    return count;
+}
+
+
+} // namespace mtbmpi
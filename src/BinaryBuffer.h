@@ -0,0 +1,209 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		BinaryBuffer.h
+@class		mtbmpi::BinaryWriter
+@class		mtbmpi::BinaryReader
+@brief 		Binary serialization of values for sending as MPI::BYTE messages.
+@details
+		BinaryWriter appends values to a byte buffer, and BinaryReader
+		reads them back in the same order, so that numeric data is sent
+		as raw bytes instead of being formatted as text.
+		Values can be any trivially-copyable type (int, double, POD structs),
+		std::string, and std::vector of trivially-copyable types.
+		The byte order is the sender's; MTBMPI assumes all processes
+		in a job have the same architecture.
+
+		A task sends a record to the Blackboard's OutputMgr:
+@code
+		mtbmpi::BinaryWriter writer;
+		writer << taskID << siteName << yearlyValues;	// int, string, vector<double>
+		writer.Send( mtbmpi::resultComm, GetParent().GetBlackboardID(), mtbmpi::Tag_TaskResults );
+@endcode
+		and the OutputMgr's HandleOutputRecord decodes it:
+@code
+		mtbmpi::BinaryReader reader ( data, size );
+		reader >> taskID >> siteName >> yearlyValues;
+@endcode
+		For fixed-layout structs sent without a BinaryWriter, see StructDatatype.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_BinaryBuffer_h
+#define INC_mtbmpi_BinaryBuffer_h
+
+#include "mpi.h"
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+namespace mtbmpi {
+
+
+class BinaryWriter
+{
+  public:
+
+    typedef std::vector<char>		Buffer;
+    typedef Buffer::size_type		size_type;
+
+    BinaryWriter () {}
+
+    /// Constructor; reserves buffer space
+    explicit BinaryWriter (
+      size_type const capacity )		///< bytes to reserve
+      { buffer.reserve( capacity ); }
+
+    /// Append a trivially-copyable value
+    template < class T >
+    BinaryWriter & Write ( T const & value )
+      {
+	static_assert( std::is_trivially_copyable<T>::value,
+		       "BinaryWriter: type must be trivially copyable" );
+	return WriteBytes( &value, sizeof(T) );
+      }
+
+    /// Append a string: length, then characters
+    BinaryWriter & Write ( std::string const & value );
+
+    /// Append a C string as a std::string
+    BinaryWriter & Write ( char const * const value ) { return Write( std::string(value) ); }
+
+    /// Append a vector of trivially-copyable values: count, then values
+    template < class T >
+    BinaryWriter & Write ( std::vector<T> const & values )
+      {
+	static_assert( std::is_trivially_copyable<T>::value,
+		       "BinaryWriter: vector element type must be trivially copyable" );
+	Write( static_cast<std::uint64_t>( values.size() ) );
+	return WriteBytes( values.data(), values.size() * sizeof(T) );
+      }
+
+    /// Append raw bytes
+    BinaryWriter & WriteBytes (
+      void const * const data,			///< bytes to append
+      size_type const size );			///< number of bytes
+
+    template < class T >
+    BinaryWriter & operator<< ( T const & value ) { return Write( value ); }	///< same as Write
+    BinaryWriter & operator<< ( char const * const value ) { return Write( value ); }	///< same as Write
+
+    char const * Data () const { return buffer.data(); }	///< serialized bytes
+    size_type Size () const { return buffer.size(); }		///< number of bytes
+    Buffer const & GetBuffer () const { return buffer; }	///< serialized bytes
+    void Clear () { buffer.clear(); }				///< remove data; keeps capacity
+
+    /// Send the buffer as MPI::BYTE
+    void Send (
+      MPI::Intracomm & comm,			///< communicator
+      int const destination,			///< destination rank
+      int const tag ) const;			///< message tag
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+    Buffer buffer;
+    /// @endcond
+};
+
+
+class BinaryReader
+{
+  public:
+
+    typedef std::size_t		size_type;
+
+    /// Constructor; the data is not copied, and must remain valid while reading
+    BinaryReader (
+      char const * const useData,		///< serialized bytes
+      size_type const useSize )			///< number of bytes
+      : data ( useData ),
+	size ( useSize ),
+	position ( 0 )
+      {
+      }
+
+    /// Constructor; the buffer is not copied, and must remain valid while reading
+    explicit BinaryReader (
+      std::vector<char> const & buffer )	///< serialized bytes
+      : data ( buffer.data() ),
+	size ( buffer.size() ),
+	position ( 0 )
+      {
+      }
+
+    /// Read a trivially-copyable value; throws std::runtime_error if past the end
+    template < class T >
+    BinaryReader & Read ( T & value )
+      {
+	static_assert( std::is_trivially_copyable<T>::value,
+		       "BinaryReader: type must be trivially copyable" );
+	return ReadBytes( &value, sizeof(T) );
+      }
+
+    /// Read a string
+    BinaryReader & Read ( std::string & value );
+
+    /// Read a vector of trivially-copyable values
+    template < class T >
+    BinaryReader & Read ( std::vector<T> & values )
+      {
+	static_assert( std::is_trivially_copyable<T>::value,
+		       "BinaryReader: vector element type must be trivially copyable" );
+	std::uint64_t count = 0;
+	Read( count );
+	CheckAvailable( count <= Remaining() / sizeof(T) ? count * sizeof(T) : Remaining() + 1 );
+	values.resize( count );
+	return ReadBytes( values.data(), count * sizeof(T) );
+      }
+
+    /// Read raw bytes
+    BinaryReader & ReadBytes (
+      void * const dest,			///< receives the bytes
+      size_type const numBytes );		///< number of bytes
+
+    template < class T >
+    BinaryReader & operator>> ( T & value ) { return Read( value ); }	///< same as Read
+
+    bool AtEnd () const { return position >= size; }		///< true if all data was read
+    size_type GetPosition () const { return position; }	///< bytes read
+    size_type Remaining () const { return size - position; }	///< bytes not read
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    char const * const data;
+    size_type const size;
+    size_type position;
+
+    void CheckAvailable ( size_type const numBytes ) const;
+
+    /// @endcond
+};
+
+/// Receive a probed message as bytes into a buffer which is resized to fit.
+/// @return number of bytes received
+int ReceiveBytes (
+    MPI::Intracomm & comm,			///< communicator with the message
+    MPI::Status const & status,			///< status from Probe
+    std::vector<char> & buffer );		///< receives the message
+
+/// Receive a message matched by Mprobe or Improbe as bytes
+/// into a buffer which is resized to fit.
+/// @return number of bytes received
+int ReceiveBytes (
+    MPI_Message & message,			///< from the matched probe
+    MPI::Status const & status,			///< status from the matched probe
+    std::vector<char> & buffer );		///< receives the message
+
+
+} // namespace mtbmpi
+
+#endif // INC_mtbmpi_BinaryBuffer_h
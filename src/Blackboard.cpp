@@ -4,13 +4,35 @@ class		mtbmpi::Blackboard
 brief		The Blackboard is the information sink for the concurrency processes.
 details
 		Blackboard does not act upon any MPI processes, but can accept information
-		from them. This object runs in its own MPI process.
+		from them. This object runs in its own MPI process,
+		or in a thread of the Controller's process.
 
 		There are two output sinks: RunLogMgr and OutputMgr.
-		RunLogMgr gets messages tagged as Tag_LogMessage and Tag_ErrorMessage.
+		RunLogMgr gets messages tagged as Tag_LogMessage, Tag_ErrorMessage and Tag_LogRecord.
 		OutputMgr gets messages tagged as Tag_TaskResults.
 		RunLogMgr is always created internally. OutputMgr is optional.
 
+		Result streams (see ResultStream) are reassembled per source rank,
+		and each chunk is passed to the OutputMgr as it arrives.
+		Each stream may have at most the credit window of chunks in flight,
+		so the memory used for a stream is bounded by credits * chunk size.
+
+		With a SharedLog, log messages and result records arrive in
+		Tag_LogBatch messages from each node's forwarder.
+		When stopping, the Blackboard waits for each forwarder's last batch.
+
+		With a ResultWindow, tasks put result records into the Blackboard's
+		RMA window, and the Blackboard receives only a short Tag_ResultRecord notice.
+
+		With writer threads, only the MPI thread calls MPI; WriteLog and
+		WriteOutput move the records to the AsyncWriter queues.
+
+		The main loop receives control messages first, then a batch of
+		bulk messages. Only the stop tags are control tags: the result stream
+		tags must keep their order with the chunks of the same stream.
+		The Controller's Tag_StopBlackboard is a bulk message on logComm,
+		so that it is received after the Controller's last log lines.
+
 project		Master-Task-Blackboard MPI Framework
 author		Thomas E. Hilinski <https://github.com/tehilinski>
 copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
@@ -25,7 +47,15 @@ copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
 #include "State.h"
 #include "versionMTBMPI.h"
 #include <algorithm>
+#include <sstream>
 #include "UtilitiesMPI.h"
+#include "BinaryBuffer.h"
+#include "MatchedProbe.h"
+#include "SharedLog.h"
+#include "ResultWindow.h"
+#include "ParallelLog.h"
+#include "LocalLog.h"
+#include <functional>
 
 // define the following to write diagnostics to std::cout
 // #define DBG_MPI_BLACKBOARD
@@ -39,15 +69,53 @@ copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
 namespace mtbmpi {
 
 
+namespace {
+
+    // tags of the control messages on comm; not probed when sharing the
+    // Controller's rank, where they are the Controller's requests;
+    // Tag_StopBlackboard arrives on logComm, after the Controller's last log line
+    int const controlTags[] = { Tag_RequestStop, Tag_RequestStopTask };
+
+    inline bool IsStopTag ( int const tag )
+    {
+	return tag == Tag_StopBlackboard || tag == Tag_RequestStop || tag == Tag_RequestStopTask;
+    }
+
+    // communicators of the bulk messages, probed in turn;
+    // comm is first, as the one not probed when sharing the Controller's rank
+    MPI::Intracomm * const bulkComms[] = { &mtbmpi::comm, &mtbmpi::logComm, &mtbmpi::resultComm };
+    std::size_t const numBulkComms = sizeof(bulkComms) / sizeof(bulkComms[0]);
+
+    // messages received at stop; bounded so that a rank which keeps sending
+    // cannot delay the stop confirmation indefinitely
+    int const maxStopDrain = 1 << 16;
+
+} // namespace
+
+
+int const Blackboard::defaultBulkBatchSize;
+
+
 Blackboard::Blackboard (
     IDNum const myID,				// rank: my process
     IDNum const controllerID,			// rank:controller
     OutputMgrPtr useOutputMgr,			// output manager
     std::string const & logFileNameRoot)	// optional log file name
     : TaskID( myID ),
-      defaultLogFileName ( versionMTBMPI.ProductNameShort() + std::string("_Log") ),
       idController (controllerID),
-      pOutputMgr ( useOutputMgr )
+      pOutputMgr ( useOutputMgr ),
+      maxResultChunkSize ( defaultResultChunkSize ),
+      resultCreditWindow ( defaultResultCredits ),
+      bulkBatchSize ( defaultBulkBatchSize ),
+      tagStats ( Tag_LAST - Tag_FIRST ),
+      batchCounts ( Tag_LAST - Tag_FIRST, 0 ),
+      maxBatchTime ( Clock::duration::zero() ),
+      stopTime ( Clock::duration::zero() ),
+      nextComm ( 0 ),
+      emptyPolls ( 0 ),
+      sharesRank ( myID == controllerID ),
+      asyncCapacity ( 0 ),
+      dropLogMessages ( false )
 {
     std::string const logFileName =
 	( logFileNameRoot.empty() ?
@@ -56,7 +124,8 @@ Blackboard::Blackboard (
     #ifdef DBG_MPI_BLACKBOARD
 	cout << "Blackboard log file: " << logFileName << endl;
     #endif
-    pRunLogMgr.reset( new RunLogMgr (logFileName) );
+    // with MPI-IO logging, the Blackboard's lines go to the shared file
+    pRunLogMgr.reset( new RunLogMgr (logFileName, RunLogMgr::defaultBufferSize, ParallelLog::GetActive()) );
     #ifdef DBG_MPI_BLACKBOARD
     // startup msg
     {
@@ -81,117 +150,693 @@ Blackboard::~Blackboard ()
     }
     #endif
 
+    if ( pOutputMgr )
+	pOutputMgr->SetRecordSink( OutputMgr::RecordSink() );	// refers to this
     pRunLogMgr.reset();
 }
 
+void Blackboard::SetResultFlowControl (
+    int const maxChunkSize,
+    int const creditWindow)
+{
+    maxResultChunkSize = std::max( 1, maxChunkSize );
+    resultCreditWindow = std::max( 1, creditWindow );
+}
+
+void Blackboard::SetAsyncWriters (
+    std::size_t const capacity,
+    bool const dropLogs)
+{
+    asyncCapacity = capacity;
+    dropLogMessages = dropLogs;
+}
+
+void Blackboard::SetBulkBatchSize (
+    int const messages)
+{
+    bulkBatchSize = std::max( 1, messages );
+}
+
+Blackboard::TagStats const & Blackboard::GetTagStats (
+    int const tag) const
+{
+    return tagStats[ TagIndex( tag ) ];
+}
+
 void Blackboard::Activate ()
 {
-    while (true)
+    StartWriters ();
+    bool isActive = true;
+    while ( isActive )
     {
 	// Wait for messages from tasks.
 	// Perform action according to type of message.
+	// Control messages first, so that bulk traffic cannot delay a stop.
+	MPI_Message message;
 	MPI::Status status;
-	mtbmpi::comm.Probe ( MPI_ANY_SOURCE, MPI_ANY_TAG, status );
+	if ( ProbeControl( message, status ) )
+	    isActive = ProcessMessage( mtbmpi::comm, message, status );
+	else
+	    isActive = ReceiveBulkBatch();
+    }
+}
+
+/// @cond SKIP_PRIVATE
+
+bool Blackboard::ProbeControl (
+    MPI_Message & message,
+    MPI::Status & status)
+{
+    // the Controller's requests on its own rank are not for the Blackboard
+    if ( sharesRank )
+	return false;
+    for ( int const tag : controlTags )
+    {
+	if ( Improbe( mtbmpi::comm, MPI_ANY_SOURCE, tag, message, status ) )
+	    return true;
+    }
+    return false;
+}
+
+MPI::Intracomm * Blackboard::ImprobeBulk (
+    MPI_Message & message,
+    MPI::Status & status)
+{
+    // the Controller receives the messages on comm when it shares this rank
+    std::size_t const firstComm = ( sharesRank ? 1 : 0 );
+    std::size_t const numComms = numBulkComms - firstComm;
+    for ( std::size_t i = 0; i < numComms; ++i )
+    {
+	MPI::Intracomm * const pComm = bulkComms[ firstComm + nextComm ];
+	nextComm = ( nextComm + 1 ) % numComms;
+	if ( Improbe( *pComm, MPI_ANY_SOURCE, MPI_ANY_TAG, message, status ) )
+	    return pComm;
+    }
+    return nullptr;
+}
+
+MPI::Intracomm & Blackboard::MprobeBulk (
+    MPI_Message & message,
+    MPI::Status & status)
+{
+    // MPI cannot wait on several communicators at once
+    MPI::Intracomm * pComm = ImprobeBulk( message, status );
+    int waits = 0;
+    while ( pComm == nullptr )
+    {
+	PollBackoff( waits );
+	pComm = ImprobeBulk( message, status );
+    }
+    return *pComm;
+}
+
+bool Blackboard::ReceiveBulkBatch ()
+{
+    // with no message, return to the control probe, which sees a stop request
+    MPI_Message message;
+    MPI::Status status;
+    MPI::Intracomm * pComm = ImprobeBulk( message, status );
+    if ( pComm == nullptr )
+    {
+	PollBackoff( emptyPolls );
+	return true;
+    }
+    emptyPolls = 0;
+    Clock::time_point const start = Clock::now();
+    std::fill( batchCounts.begin(), batchCounts.end(), 0u );
+    bool isActive = true;
+    int received = 0;
+    do
+    {
+	++batchCounts[ TagIndex( status.Get_tag() ) ];
+	isActive = ProcessMessage( *pComm, message, status );
+    }
+    while ( isActive && ++received < bulkBatchSize &&
+	    ( pComm = ImprobeBulk( message, status ) ) != nullptr );
+    if ( !isActive )
+	return false;
+    for ( std::size_t i = 0; i < batchCounts.size(); ++i )
+	tagStats[i].maxPerBatch = std::max( tagStats[i].maxPerBatch, batchCounts[i] );
+    maxBatchTime = std::max( maxBatchTime, Clock::now() - start );
+    return true;
+}
+
+void Blackboard::DrainPending ()
+{
+    MPI_Message message;
+    MPI::Status status;
+    MPI::Intracomm * pComm = nullptr;
+    for ( int n = 0;
+	  n < maxStopDrain && ( pComm = ImprobeBulk( message, status ) ) != nullptr;
+	  ++n )
+    {
+	if ( IsStopTag( status.Get_tag() ) )		// a repeated request
+	    Mrecv ( 0, 0, MPI::BYTE, message );
+	else
+	    ProcessMessage( *pComm, message, status );
+    }
+}
+
+void Blackboard::WriteTagStats ()
+{
+    if ( !LoggerMPI::IsEnabled( LogLevel_Debug ) )
+	return;
+    for ( std::size_t i = 0; i < tagStats.size(); ++i )
+    {
+	TagStats const & stats = tagStats[i];
+	if ( stats.messages == 0 )
+	    continue;
+	std::ostringstream oss;
+	oss << "Blackboard tag " << ( Tag_FIRST + static_cast<int>( i ) )
+	    << ": messages = " << stats.messages
+	    << ", bytes = " << stats.bytes
+	    << ", most in one batch = " << stats.maxPerBatch;
+	Message( oss.str() );
+    }
+    std::ostringstream oss;
+    oss << "Blackboard: batch size = " << bulkBatchSize
+	<< ", longest batch (seconds) = " << GetMaxBatchSeconds()
+	<< ", stop to confirmation (seconds) = " << GetStopSeconds();
+    Message( oss.str() );
+}
+
+std::size_t Blackboard::TagIndex (
+    int const tag)
+{
+    return static_cast<std::size_t>(
+	( IsMsgTagValid( tag ) ? tag : static_cast<int>( Tag_Unknown ) ) - Tag_FIRST );
+}
+
+bool Blackboard::ProcessMessage (
+    MPI::Intracomm & from,		// communicator of the message
+    MPI_Message & message,		// from the matched probe
+    MPI::Status & status)		// status from the matched probe
+{
+    TagStats & stats = tagStats[ TagIndex( status.Get_tag() ) ];
+    ++stats.messages;
+    stats.bytes += static_cast<unsigned long long>( status.Get_count( MPI::BYTE ) );
+    switch ( status.Get_tag() )
+    {
+      case Tag_TaskResults:
+      {
+	// send to output mgr to be retrieved and managed;
+	// the default HandleOutputMessage gives the record to the output writer,
+	// and an overriding one writes it in this thread, after the writer is idle
+	if ( HaveOutputMgr() )
+	{
+	    if ( !GetOutputMgr()->UsesDefaultMessageHandler() )	// or not known yet
+		WaitForOutputWriter ();
+	    GetOutputMgr()->HandleOutputMessage( message, status );
+	}
+	else
+	    DiscardMatched ( message, status );	// a matched message must be received
+	break;
+      }
+      case Tag_ResultBegin:
+      {
+	ReceiveResultBegin( from, message, status );
+	break;
+      }
+      case Tag_ResultChunk:
+      {
+	ReceiveResultChunk( from, message, status );
+	break;
+      }
+      case Tag_ResultEnd:
+      {
+	ReceiveResultEnd( from, message, status );
+	break;
+      }
+      case Tag_LogMessage:
+      {
+	ReceiveAndLogMessage( from, message, status );
+	break;
+      }
+      case Tag_ErrorMessage:
+      {
+	ReceiveAndLogError( from, message, status );
+	break;
+      }
+      case Tag_LogBatch:
+      {
+	ReceiveLogBatch( from, message, status );
+	break;
+      }
+      case Tag_LogRecord:
+      {
+	ReceiveLogRecord( from, message, status );
+	break;
+      }
+      case Tag_ResultRecord:
+      {
+	ReceiveResultRecord( from, message, status );
+	break;
+      }
+      case Tag_StopBlackboard:
+      case Tag_RequestStop:
+      case Tag_RequestStopTask:
+      {
+	#ifdef DBG_MPI_BLACKBOARD
+	cout << "Blackboard " << GetID() << ": "
+	     << "Activate: Tag_RequestStop: enter" << endl;
+	#endif
+	// mark msg as received
+	Mrecv ( 0, 0, MPI::BYTE, message );
+	Clock::time_point const stopStart = Clock::now();
+	DrainPending();
+	FlushSharedLog();
+	CloseResultStreams();
+
+	// send confirmation
+	//GetRunLogMgr().Write( "Blackboard stopped.\n" );
+	Message( "Blackboard stopped.\n" );
+	StopWriters ();
+	stopTime = Clock::now() - stopStart;
+	WriteTagStats();
+	mtbmpi::comm.Send ( 0, 0, MPI::BYTE, idController, Tag_Confirmation );
+
+	#ifdef DBG_MPI_BLACKBOARD
+	cout << "Blackboard " << GetID() << ": "
+	     << "Activate: Tag_RequestStop: done"
+	     << endl;
+	#endif
+	return false;
+      }
+      default:
+      {
+	#ifdef DBG_MPI_BLACKBOARD
+	cout << "Blackboard " << GetID() << ": "
+	     << "Activate: unhandled tag: " << status.Get_tag()
+	     << endl;
+	#endif
+	DiscardMatched ( message, status );	// a matched message must be received
+	break;
+      }
+    }
+    return true;
+}
+
+void Blackboard::FlushSharedLog ()
+{
+    SharedLog * const pSharedLog = SharedLog::GetActive();
+    if ( pSharedLog == nullptr )
+	return;
+
+    // each forwarder sends its last batch, then Tag_LogFlushed
+    std::vector<int> const & forwarderIDs = pSharedLog->GetForwarderIDs();
+    for ( std::vector<int>::const_iterator i = forwarderIDs.begin(); i != forwarderIDs.end(); ++i )
+	pSharedLog->GetControlComm().Send ( 0, 0, MPI::BYTE, *i, Tag_LogFlush );
+    std::vector<int>::size_type numFlushed = 0;
+    while ( numFlushed < forwarderIDs.size() )
+    {
+	MPI_Message message;
+	MPI::Status status;
+	MPI::Intracomm & from = MprobeBulk( message, status );
 	switch ( status.Get_tag() )
 	{
-	  case Tag_TaskResults:
-	  {
-	    // send to output mgr to be retrieved and managed
-	    if ( HaveOutputMgr() )
-		GetOutputMgr()->HandleOutputMessage( mtbmpi::comm, status );
+	  case Tag_LogFlushed:
+	    Mrecv ( 0, 0, MPI::BYTE, message );
+	    ++numFlushed;
 	    break;
-	  }
+	  case Tag_StopBlackboard:
+	  case Tag_RequestStop:
+	  case Tag_RequestStopTask:
+	    Mrecv ( 0, 0, MPI::BYTE, message );
+	    break;
+	  default:
+	    ProcessMessage( from, message, status );
+	    break;
+	}
+    }
+}
+
+void Blackboard::ReceiveLogBatch (
+    MPI::Intracomm & from,		// communicator of the message
+    MPI_Message & message,		// from the matched probe
+    MPI::Status & status)		// status from the matched probe
+{
+    ReceiveBytes( message, status, logBatch );
+    BinaryReader reader ( logBatch );
+    while ( !reader.AtEnd() )
+    {
+	int source = 0;
+	int tag = 0;
+	std::uint32_t size = 0;
+	reader >> source >> tag >> size;
+	recordText.resize( size );
+	reader.ReadBytes( &recordText[0], size );
+	switch ( tag )
+	{
 	  case Tag_LogMessage:
-	  {
-	    ReceiveAndLogMessage(status);
+	    WriteLog( recordText, Tag_LogMessage, dropLogMessages );
 	    break;
-	  }
 	  case Tag_ErrorMessage:
-	  {
-	    ReceiveAndLogError( status );
+	    LogError( recordText );
+	    break;
+	  case Tag_LogRecord:
+	    WriteLogRecord( recordText );
+	    break;
+	  case Tag_TaskResults:
+	    WriteOutput( source, recordText.data(), size );
 	    break;
-	  }
-	  case Tag_StopBlackboard:
-	  case Tag_RequestStop:
-	  case Tag_RequestStopTask:
-	  {
-	    #ifdef DBG_MPI_BLACKBOARD
-	    cout << "Blackboard " << GetID() << ": "
-		 << "Activate: Tag_RequestStop: enter" << endl;
-	    #endif
-	    // mark msg as received
-	    mtbmpi::comm.Recv ( 0, 0, MPI::BYTE, status.Get_source(), status.Get_tag() );
-
-	    // send confirmation
-	    //GetRunLogMgr().Write( "Blackboard stopped.\n" );
-	    Message( "Blackboard stopped.\n" );
-	    mtbmpi::comm.Send ( 0, 0, MPI::BYTE, idController, Tag_Confirmation );
-
-	    #ifdef DBG_MPI_BLACKBOARD
-	    cout << "Blackboard " << GetID() << ": "
-		 << "Activate: Tag_RequestStop: done"
-		 << endl;
-	    #endif
-	    return;
-	  }
 	  default:
-	  {
-	    #ifdef DBG_MPI_BLACKBOARD
-	    cout << "Blackboard " << GetID() << ": "
-		 << "Activate: unhandled tag: " << status.Get_tag()
-		 << endl;
-	    #endif
 	    break;
-	  }
 	}
     }
 }
 
+/// @endcond
+
 /// @cond SKIP_PRIVATE
 
+void Blackboard::ReceiveLogRecord (
+    MPI::Intracomm & from,		// communicator of the message
+    MPI_Message & message,		// from the matched probe
+    MPI::Status & status)		// status from the matched probe
+{
+    int const count = status.Get_count (MPI::BYTE);
+    std::string record ( count, NULL_CHAR );
+    Mrecv( &record[0], count, MPI::BYTE, message );
+    WriteLogRecord( record );
+}
+
+void Blackboard::WriteLogRecord (
+    std::string & record)
+{
+    bool mayDrop = dropLogMessages;
+    if ( mayDrop && record.size() >= logRecordHeaderSize )
+    {
+	LogRecordHeader header;
+	DecodeLogRecordHeader( record.data(), header );
+	mayDrop = ( header.level < LogLevel_Error );
+    }
+    WriteLog( record, Tag_LogRecord, mayDrop );
+}
+
 void Blackboard::Message ( std::string const & msg )
 {
+    if ( !LoggerMPI::IsEnabled( LogLevel_Info ) )
+	return;
     std::string text = DateTimeStampPrefix();
     text += msg;
-    GetRunLogMgr().Write( text );
+    WriteLog( text );
 }
 
 void Blackboard::ReceiveAndLogMessage (
-    MPI::Status & status)		// status from Probe
+    MPI::Intracomm & from,		// communicator of the message
+    MPI_Message & message,		// from the matched probe
+    MPI::Status & status)		// status from the matched probe
 {
-    MPI::Status recvStatus;
     int const count = status.Get_count (MPI::CHAR);
     std::string buffer( count + 1, NULL_CHAR );
-    mtbmpi::comm.Recv( &buffer[0], count, MPI::CHAR, status.Get_source(), status.Get_tag(), recvStatus );
+    Mrecv( &buffer[0], count, MPI::CHAR, message );
     std::string msg (buffer.begin(), buffer.begin() + count);
     #ifdef DBG_MPI_BLACKBOARD
 	cout << "Blackboard message: " << msg << endl;
     #endif
-    GetRunLogMgr().Write( msg );
+    WriteLog( msg, Tag_LogMessage, dropLogMessages );
 }
 
 void Blackboard::ReceiveAndLogError (
-    MPI::Status & status)		// status from Probe
+    MPI::Intracomm & from,		// communicator of the message
+    MPI_Message & message,		// from the matched probe
+    MPI::Status & status)		// status from the matched probe
 {
-    MPI::Status recvStatus;
     int const count = status.Get_count (MPI::CHAR);
-    std::string buffer( count + 1, NULL_CHAR );
-    mtbmpi::comm.Recv( &buffer[0], count, MPI::CHAR, status.Get_source(), status.Get_tag(), recvStatus );
+    std::string buffer( count, NULL_CHAR );
+    Mrecv( &buffer[0], count, MPI::CHAR, message );
+    LogError( buffer );
+}
+
+void Blackboard::LogError (
+    std::string const & text)
+{
     std::string msg;
     std::string const errorPrefix = "Error: ";
-    if ( buffer.substr( 0, errorPrefix.size() ) != errorPrefix )
+    if ( text.substr( 0, errorPrefix.size() ) != errorPrefix )
 	msg = errorPrefix;
-    msg.append (buffer.begin(), buffer.begin() + count);
+    msg += text;
     #ifdef DBG_MPI_BLACKBOARD
 	cout << "Blackboard error message: " << msg << endl;
     #endif
-    GetRunLogMgr().Write( msg );
+    WriteLog( msg, Tag_ErrorMessage );
+}
+
+void Blackboard::ReceiveResultRecord (
+    MPI::Intracomm & from,		// communicator of the message
+    MPI_Message & message,		// from the matched probe
+    MPI::Status & status)		// status from the matched probe
+{
+    long long notice[2] = { 0, 0 };	// position, size
+    int const source = status.Get_source();
+    Mrecv( notice, 2, MPI::LONG_LONG, message );
+    ResultWindow * const pWindow = ResultWindow::GetActive();
+    if ( pWindow == nullptr )
+	return;
+    std::uint64_t const position = notice[0];
+    std::size_t const size = notice[1];
+    WriteOutput( source, pWindow->GetRecord( position, size ), size );
+    pWindow->Consume( position, size );	// the writer has a copy
+}
+
+void Blackboard::ReceiveResultBegin (
+    MPI::Intracomm & from,		// communicator of the message
+    MPI_Message & message,		// from the matched probe
+    MPI::Status & status)		// status from the matched probe
+{
+    long long header[3] = { 0, -1, 0 };	// stream ID, total size, requested chunk size
+    int const source = status.Get_source();
+    Mrecv( header, 3, MPI::LONG_LONG, message );
+
+    ResultStreamMap::iterator const previous = resultStreams.find( source );
+    if ( previous != resultStreams.end() )
+    {
+	std::ostringstream os;
+	os << "Error: Blackboard: result stream from rank " << source
+	   << " started before the previous stream ended.";
+	Message( os.str() );
+	// end only this rank's stream; the other ranks' streams go on
+	WaitForOutputWriter ();
+	if ( HaveOutputMgr() )
+	    GetOutputMgr()->HandleResultEnd( source, previous->second.streamID, false );
+	resultStreams.erase( previous );
+    }
+    ResultStreamState & stream = resultStreams[ source ];
+    stream.streamID = header[0];
+    stream.totalSize = header[1];
+    stream.received = 0;
+    stream.pendingCredits = 0;
+    stream.pComm = &from;
+    WaitForOutputWriter ();
+    if ( HaveOutputMgr() )
+	GetOutputMgr()->HandleResultBegin( source, stream.streamID, stream.totalSize );
+
+    // grant the window; the Blackboard decides the chunk size
+    int const chunkSize =
+	( header[2] > 0 && header[2] < maxResultChunkSize ?
+	  static_cast<int>( header[2] ) : maxResultChunkSize );
+    int const grant[2] = { resultCreditWindow, chunkSize };
+    from.Send( grant, 2, MPI::INT, source, Tag_ResultCredit );
+}
+
+void Blackboard::ReceiveResultChunk (
+    MPI::Intracomm & from,		// communicator of the message
+    MPI_Message & message,		// from the matched probe
+    MPI::Status & status)		// status from the matched probe
+{
+    int const source = status.Get_source();
+    int const size = status.Get_count( MPI::BYTE );
+    resultChunk.resize( size );
+    Mrecv( resultChunk.data(), size, MPI::BYTE, message );
+
+    ResultStreamMap::iterator i = resultStreams.find( source );
+    if ( i == resultStreams.end() )
+    {
+	std::ostringstream os;
+	os << "Error: Blackboard: result chunk from rank " << source
+	   << " without a result stream.";
+	Message( os.str() );
+	SendResultCredit( from, source, 1 );	// the sender waits for it
+	return;
+    }
+    ResultStreamState & stream = i->second;
+    WaitForOutputWriter ();
+    if ( HaveOutputMgr() )
+	GetOutputMgr()->HandleResultChunk(
+		source, stream.streamID, stream.received, resultChunk.data(), size );
+    stream.received += size;
+
+    // return credits in batches of half the window
+    ++stream.pendingCredits;
+    if ( stream.pendingCredits >= std::max( 1, resultCreditWindow / 2 ) )
+    {
+	SendResultCredit( *stream.pComm, source, stream.pendingCredits );
+	stream.pendingCredits = 0;
+    }
+}
+
+void Blackboard::ReceiveResultEnd (
+    MPI::Intracomm & from,		// communicator of the message
+    MPI_Message & message,		// from the matched probe
+    MPI::Status & status)		// status from the matched probe
+{
+    int const source = status.Get_source();
+    long long bytesSent = 0;
+    Mrecv( &bytesSent, 1, MPI::LONG_LONG, message );
+
+    ResultStreamMap::iterator i = resultStreams.find( source );
+    if ( i != resultStreams.end() )
+    {
+	ResultStreamState const & stream = i->second;
+	bool const isComplete =
+	    stream.received == bytesSent &&
+	    ( stream.totalSize < 0 || stream.totalSize == stream.received );
+	if ( !isComplete )
+	{
+	    std::ostringstream os;
+	    os << "Error: Blackboard: result stream " << stream.streamID
+	       << " from rank " << source
+	       << " is incomplete: received " << stream.received << " bytes";
+	    Message( os.str() );
+	}
+	WaitForOutputWriter ();
+	if ( HaveOutputMgr() )
+	    GetOutputMgr()->HandleResultEnd( source, stream.streamID, isComplete );
+	resultStreams.erase( i );
+    }
+    SendResultCredit( from, source, 0 );	// acknowledges the end
+}
+
+void Blackboard::SendResultCredit (
+    MPI::Intracomm & to,
+    int const destination,
+    int const credits)
+{
+    int const grant[2] = { credits, 0 };
+    to.Send( grant, 2, MPI::INT, destination, Tag_ResultCredit );
+}
+
+void Blackboard::CloseResultStreams ()
+{
+    WaitForOutputWriter ();
+    for ( ResultStreamMap::const_iterator i = resultStreams.begin(); i != resultStreams.end(); ++i )
+    {
+	if ( HaveOutputMgr() )
+	    GetOutputMgr()->HandleResultEnd( i->first, i->second.streamID, false );
+    }
+    resultStreams.clear();
+}
+
+void Blackboard::StartWriters ()
+{
+    if ( asyncCapacity == 0 )
+	return;
+    RunLogMgrPtr pLog = pRunLogMgr;
+    pLogWriter.reset( new AsyncWriter (
+	"Blackboard log writer", asyncCapacity,
+	[pLog] (AsyncWriter::Record const & record)
+	{
+	    if ( record.tag == Tag_LogRecord )
+		pLog->WriteRecord( record.data.data(), record.data.size() );
+	    else if ( record.tag == Tag_ErrorMessage )
+		pLog->WriteError( record.data );
+	    else
+		pLog->Write( record.data );
+	},
+	[pLog] () { pLog->FlushIfDue(); } ) );
+    if ( HaveOutputMgr() )
+    {
+	OutputMgrPtr pOutput = pOutputMgr;
+	pOutputWriter.reset( new AsyncWriter (
+	    "Blackboard output writer", asyncCapacity,
+	    [pOutput] (AsyncWriter::Record const & record)
+	    {
+		pOutput->HandleOutputRecord( record.source, record.tag,
+					     record.data.data(), static_cast<int>( record.data.size() ) );
+	    },
+	    [] () {} ) );
+	pOutputMgr->SetRecordSink (
+	    [this] ( int const source, char const * const data, std::size_t const size )
+	    {
+		WriteOutput( source, data, size );
+	    } );
+    }
+}
+
+void Blackboard::StopWriters ()
+{
+    if ( pOutputWriter )
+    {
+	pOutputMgr->SetRecordSink( OutputMgr::RecordSink() );
+	pOutputWriter->Stop();
+	Message( pOutputWriter->Summary() );
+	pOutputWriter.reset();
+    }
+    if ( pLogWriter )
+    {
+	std::string text = DateTimeStampPrefix();
+	text += pLogWriter->Summary();
+	pLogWriter->Stop();
+	pLogWriter.reset();
+	GetRunLogMgr().Write( text );
+    }
+}
+
+void Blackboard::WriteLog (
+    std::string & text,
+    MsgTags const tag,
+    bool const mayDrop)
+{
+    LocalLog * const pLocalLog = LocalLog::GetActive();
+    if ( pLocalLog != nullptr && tag != Tag_LogRecord )
+    {
+	pLocalLog->Append( text, tag == Tag_ErrorMessage );	// merged at the end
+	return;
+    }
+    if ( pLogWriter )
+    {
+	AsyncWriter::Record record;
+	record.source = GetID();
+	record.tag = tag;
+	record.data.swap( text );
+	pLogWriter->Push( record, mayDrop );
+    }
+    else if ( tag == Tag_LogRecord )
+	GetRunLogMgr().WriteRecord( text.data(), text.size() );
+    else if ( tag == Tag_ErrorMessage )
+	GetRunLogMgr().WriteError( text );
+    else
+	GetRunLogMgr().Write( text );
+}
+
+void Blackboard::WriteOutput (
+    int const source,
+    char const * const data,
+    std::size_t const size)
+{
+    if ( pOutputWriter )
+    {
+	AsyncWriter::Record record;
+	record.source = source;
+	record.tag = Tag_TaskResults;
+	record.data.assign( data, size );
+	pOutputWriter->Push( record );
+    }
+    else if ( HaveOutputMgr() )
+	GetOutputMgr()->HandleOutputRecord( source, Tag_TaskResults, data, static_cast<int>( size ) );
+}
+
+void Blackboard::WaitForOutputWriter () const
+{
+    if ( pOutputWriter )
+	pOutputWriter->WaitUntilIdle();
 }
 
 std::string Blackboard::CreateLogFileName (
     std::string const & logFileNameRoot)
 {
     // log file name has the form: logFileNameRoot.DATE.TIME.txt
+    // rotated log files: logFileNameRoot.DATE.TIME.NNN.txt (see RunLogMgr::RotatedFileName)
 
     char const dot = '.';
     char const dash = '-';
@@ -203,7 +848,9 @@ std::string Blackboard::CreateLogFileName (
     std::string time = TimeStr();
     std::replace (time.begin(), time.end(), colon, dash);
 
-    std::string name = ( logFileNameRoot.empty() ? defaultLogFileName : logFileNameRoot );
+    std::string name = ( logFileNameRoot.empty() ?
+			 versionMTBMPI.ProductNameShort() + std::string("_Log") :
+			 logFileNameRoot );
     name += dot;
     name += date;
     name += dot;
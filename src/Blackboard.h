@@ -4,12 +4,79 @@
 @brief		The Blackboard is the information broker for the concurrency processes.
 @details
 		Blackboard does not act upon any MPI processes, but can accept information
-		from them. This object runs in its own MPI process.
+		from them. This object runs in its own MPI process, or, with the option
+		`--mtbmpi-blackboard-thread`, in a thread of the Controller's process.
 
 		There are two output sinks: RunLogMgr and OutputMgr.
-		RunLogMgr gets messages tagged as Tag_LogMessage and Tag_ErrorMessage.
+		RunLogMgr gets messages tagged as Tag_LogMessage, Tag_ErrorMessage and Tag_LogRecord.
 		OutputMgr gets messages tagged as Tag_TaskResults.
 		RunLogMgr is always created internally. OutputMgr is optional.
+
+		Result streams (see ResultStream) are reassembled per source rank,
+		one open stream per rank, and each chunk is passed to the OutputMgr
+		as it arrives. A chunk without a stream is logged as an error,
+		and its credit is returned, so that the sender does not wait.
+		Each stream may have at most the credit window of chunks in flight,
+		so the memory used for a stream is bounded by credits * chunk size.
+
+		With a SharedLog, log messages and result records arrive in
+		Tag_LogBatch messages from each node's forwarder.
+		When stopping, the Blackboard waits for each forwarder's last batch.
+		With a LogBatcher, each rank sends its log messages in Tag_LogBatch messages.
+		With binary log records, messages arrive as Tag_LogRecord, directly or
+		in batches, and the RunLogMgr writes them to a binary log file.
+		With a ParallelLog, the ranks write their log messages to the log file
+		themselves, and the RunLogMgr writes the Blackboard's lines to it.
+		With a LocalLog, the Blackboard's own lines go to its local file,
+		and the RunLogMgr writes the merged lines of all ranks at the end.
+
+		With a ResultWindow, tasks put result records into the Blackboard's
+		RMA window, and the Blackboard receives only a short Tag_ResultRecord notice.
+
+		With the option `--mtbmpi-async-blackboard[=RECORDS]`, the Blackboard's
+		MPI thread only receives: log messages and result records are pushed
+		into bounded queues, and AsyncWriter threads write them to the
+		RunLogMgr and to OutputMgr::HandleOutputRecord. The default
+		OutputMgr::HandleOutputMessage pushes the record to the output queue;
+		an OutputMgr which overrides it is called by the MPI thread after the
+		output writer is idle. Result stream chunks are passed to the OutputMgr by
+		the MPI thread after the output writer has written the records before them.
+		With `--mtbmpi-async-drop-logs`, log messages are discarded
+		instead of waiting when the log queue is full.
+		The queue counters are written to the log when the Blackboard stops.
+
+		Stop requests on comm are control messages, which bulk traffic cannot
+		delay: the main loop checks for them with an Improbe of each control tag,
+		then receives at most a batch of other messages (default 64,
+		option `--mtbmpi-blackboard-batch=N`) before it checks again.
+		The Controller sends Tag_StopBlackboard on logComm instead,
+		after its last log message, so that the Blackboard receives the
+		Controller's log messages before its stop: MPI keeps the order of
+		messages only within a communicator. Before it confirms the stop,
+		the Blackboard receives the messages which are already waiting,
+		so that messages sent before the stop request are written.
+		GetTagStats has the counts of messages and bytes by tag, and the
+		most messages of a tag received in one batch, which is the depth of
+		that tag's queue when the Blackboard is behind. With the log level
+		debug, the counts and the stop timing are written to the log at stop.
+
+		Messages arrive on the communicators of their traffic class
+		(see TrafficComms.h). The control requests are probed on comm only;
+		the batches take turns among comm, logComm and resultComm, so
+		that no class of messages holds back the others. Each message
+		is received, and answered, on the communicator it arrived on,
+		except the stop, which is confirmed on comm.
+		Messages are matched with MPI_Improbe and received with MPI_Mrecv,
+		so each is matched once; HandleOutputMessage gets the handle.
+
+		When the Blackboard shares its rank with the Controller, the Controller
+		receives the messages on comm, so the Blackboard does not probe comm;
+		its batches take turns between logComm and resultComm, and results
+		must then be sent on resultComm. The Controller
+		discards results and log messages sent on comm, and logs an error.
+		When no bulk message is waiting, the main loop returns to the
+		control probe; after a number of empty passes it sleeps briefly
+		between passes, so that an idle Blackboard does not use a core.
 @internal
 project		Master-Task-Blackboard MPI Framework
 @author		Thomas E. Hilinski <https://github.com/tehilinski>
@@ -27,9 +94,14 @@ project		Master-Task-Blackboard MPI Framework
 #include "SendsMsgsToLog.h"
 #include "RunLogMgr.h"
 #include "OutputMgr.h"
+#include "AsyncWriter.h"
+#include "MsgTags.h"
 #include "timeutil.h"
 #include <string>
 #include <memory>
+#include <map>
+#include <vector>
+#include <chrono>
 
 namespace mtbmpi {
 
@@ -41,6 +113,7 @@ namespace mtbmpi {
 
 	typedef std::shared_ptr<RunLogMgr>		RunLogMgrPtr;
 	typedef std::shared_ptr<OutputMgr>		OutputMgrPtr;
+	typedef std::shared_ptr<AsyncWriter>		AsyncWriterPtr;
 
 	/// Constructor
 	Blackboard (
@@ -59,32 +132,175 @@ namespace mtbmpi {
 
 	RunLogMgr & GetRunLogMgr () const { return *pRunLogMgr; }	///< Get the logfile manager
 
+	/// Name of a new log file: logFileNameRoot.DATE.TIME.txt;
+	/// the root is MTBMPI_Log if it is empty.
+	static std::string CreateLogFileName (
+	  std::string const & logFileNameRoot);
+
 	bool HaveOutputMgr () const { return pOutputMgr.get() != nullptr; }
 
 	OutputMgrPtr GetOutputMgr () const { return pOutputMgr; }	///< Get the output manager
 
+	/// Set the result stream flow control; call before Activate
+	void SetResultFlowControl (
+	  int const maxChunkSize,			///< maximum bytes per chunk
+	  int const creditWindow );			///< maximum chunks in flight per stream
+
+	/// Use writer threads for the log and the output; call before Activate
+	void SetAsyncWriters (
+	  std::size_t const capacity,			///< records per queue; 0 = no writer threads
+	  bool const dropLogs );			///< discard log messages if the queue is full
+
+	/// Set the most bulk messages received between checks for control messages;
+	/// call before Activate
+	void SetBulkBatchSize (
+	  int const messages );
+
+	/// Counts of the messages received with one tag
+	struct TagStats
+	{
+	    unsigned long long messages;	///< messages received
+	    unsigned long long bytes;		///< bytes received
+	    unsigned int maxPerBatch;		///< most received in one batch
+	    TagStats () : messages (0), bytes (0), maxPerBatch (0) {}
+	};
+
+	/// Counts of the messages received with a tag; updated by the main loop
+	TagStats const & GetTagStats (
+	  int const tag ) const;			///< a MsgTags value
+
+	/// Longest time of one batch of bulk messages, in seconds;
+	/// the longest a control message waited to be seen
+	double GetMaxBatchSeconds () const
+	  { return std::chrono::duration<double>( maxBatchTime ).count(); }
+
+	/// Time from receiving the stop request to sending the confirmation,
+	/// in seconds; zero until stopped
+	double GetStopSeconds () const
+	  { return std::chrono::duration<double>( stopTime ).count(); }
+
+	static int const defaultBulkBatchSize = 64;		///< messages between control checks
+	static int const defaultResultChunkSize = 1 << 20;	///< bytes per result chunk
+	static int const defaultResultCredits = 4;		///< result chunks in flight per stream
+
       private:
 
 	/// @cond SKIP_PRIVATE
 
-	std::string const defaultLogFileName;
-
 	IDNum const idController;		// rank controller
 	RunLogMgrPtr pRunLogMgr;
 	OutputMgrPtr pOutputMgr;
 
+	// result streams
+	struct ResultStreamState
+	{
+	    long long streamID;
+	    long long totalSize;	// -1 if not known
+	    long long received;		// bytes received
+	    int pendingCredits;		// consumed chunks not yet credited
+	    MPI::Intracomm * pComm;	// communicator of the stream
+	};
+	typedef std::map<int, ResultStreamState>	ResultStreamMap;	// key = source rank
+
+	int maxResultChunkSize;
+	int resultCreditWindow;
+	ResultStreamMap resultStreams;
+	std::vector<char> resultChunk;		// reused chunk buffer
+	std::vector<char> logBatch;		// reused shared log batch buffer
+	std::string recordText;			// reused shared log record
+
+	// prioritized receiving
+	typedef std::chrono::steady_clock	Clock;
+	int bulkBatchSize;			// messages between control checks
+	std::vector<TagStats> tagStats;		// index = tag - Tag_FIRST
+	std::vector<unsigned int> batchCounts;	// index = tag - Tag_FIRST
+	Clock::duration maxBatchTime;
+	Clock::duration stopTime;
+	std::size_t nextComm;			// the bulk communicator probed next
+	int emptyPolls;				// consecutive passes with no message
+	bool const sharesRank;			// a thread of the Controller's rank
+
+	// writer threads
+	std::size_t asyncCapacity;		// 0 = write in the MPI thread
+	bool dropLogMessages;			// if the log queue is full
+	AsyncWriterPtr pLogWriter;
+	AsyncWriterPtr pOutputWriter;
+
+	void StartWriters ();
+	void StopWriters ();			// at stop; writes the counters to the log
+	void WriteLog (				// to the log writer or the RunLogMgr
+	  std::string & text,			// moved to the log writer
+	  MsgTags const tag = Tag_LogMessage,	// or Tag_ErrorMessage, Tag_LogRecord
+	  bool const mayDrop = false );
+	void WriteOutput (			// to the output writer or the OutputMgr
+	  int const source,
+	  char const * const data,
+	  std::size_t const size );
+	void WaitForOutputWriter () const;	// before calling the OutputMgr directly
+
+	bool ProcessMessage (			// returns false to stop
+	  MPI::Intracomm & from,		// communicator of the message
+	  MPI_Message & message,		// from the matched probe
+	  MPI::Status & status);		// status from the matched probe
+
+	bool ProbeControl (			// Improbe each control tag
+	  MPI_Message & message,		// the matched control message
+	  MPI::Status & status);		// status of a control message
+	MPI::Intracomm * ImprobeBulk (		// null if no message is waiting
+	  MPI_Message & message,		// the matched message
+	  MPI::Status & status);		// status of the message
+	MPI::Intracomm & MprobeBulk (		// waits for a message
+	  MPI_Message & message,		// the matched message
+	  MPI::Status & status);		// status of the message
+	bool ReceiveBulkBatch ();		// returns false to stop; true if none
+	void DrainPending ();			// at stop; messages already waiting
+	void WriteTagStats ();			// at stop; to the log if debug
+	static std::size_t TagIndex (
+	  int const tag);
+
+	void ReceiveLogBatch (
+	  MPI::Intracomm & from,
+	  MPI_Message & message,
+	  MPI::Status & status);		// status from Probe
+
+	void ReceiveLogRecord (			// binary log record
+	  MPI::Intracomm & from,
+	  MPI_Message & message,
+	  MPI::Status & status);		// status from Probe
+	void WriteLogRecord (
+	  std::string & record );		// moved to the log writer
+
+	void ReceiveResultRecord (		// record is in the ResultWindow
+	  MPI::Intracomm & from,
+	  MPI_Message & message,
+	  MPI::Status & status);		// status from Probe
+
+	void FlushSharedLog ();			// at stop; wait for forwarders' last batches
+
+	void LogError (
+	  std::string const & text);
+
+	void ReceiveResultBegin ( MPI::Intracomm & from, MPI_Message & message, MPI::Status & status );
+	void ReceiveResultChunk ( MPI::Intracomm & from, MPI_Message & message, MPI::Status & status );
+	void ReceiveResultEnd ( MPI::Intracomm & from, MPI_Message & message, MPI::Status & status );
+	void SendResultCredit (
+	  MPI::Intracomm & to,
+	  int const destination,
+	  int const credits );
+	void CloseResultStreams ();		// at stop; ends streams which are still open
 
 	void Message ( std::string const & msg );
 
 	void ReceiveAndLogMessage(
+	  MPI::Intracomm & from,
+	  MPI_Message & message,
 	  MPI::Status & status);		// status from Probe
 
 	void ReceiveAndLogError (
+	  MPI::Intracomm & from,
+	  MPI_Message & message,
 	  MPI::Status & status);		// status from Probe
 
-	std::string CreateLogFileName (
-	  std::string const & logFileNameRoot);
-
 	// functions that should not be used; are not defined
 	Blackboard (Blackboard const & object);
 	Blackboard & operator= (Blackboard const & object);
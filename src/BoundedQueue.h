@@ -0,0 +1,150 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		BoundedQueue.h
+@class		mtbmpi::BoundedQueue
+@brief 		Bounded lock-free multi-producer, multi-consumer queue.
+@details
+		A fixed array of cells, each with a sequence number
+		(D. Vyukov's bounded MPMC queue). A producer claims a cell by
+		advancing the enqueue position, moves the item in, and publishes it
+		by setting the cell's sequence; a consumer does the reverse.
+		TryPush and TryPop do not wait: they return false if the queue
+		is full or empty, so the caller decides how to wait or whether to drop.
+		The capacity is rounded up to a power of 2.
+		T must be default-constructible and movable.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_BoundedQueue_h
+#define INC_mtbmpi_BoundedQueue_h
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace mtbmpi {
+
+
+template < class T >
+class BoundedQueue
+{
+  public:
+
+    /// Constructor
+    explicit BoundedQueue (
+      std::size_t const minCapacity )	///< rounded up to a power of 2
+      : capacity ( RoundUp( minCapacity ) ),
+	mask ( capacity - 1 ),
+	cells ( new Cell [ capacity ] ),
+	enqueuePos ( 0 ),
+	dequeuePos ( 0 )
+      {
+	for ( std::size_t i = 0; i < capacity; ++i )
+	    cells[i].sequence.store( i, std::memory_order_relaxed );
+      }
+
+    /// Move item into the queue; returns false if the queue is full
+    bool TryPush ( T & item )
+      {
+	Cell * cell = nullptr;
+	std::size_t position = enqueuePos.load( std::memory_order_relaxed );
+	while ( true )
+	{
+	    cell = &cells[ position & mask ];
+	    std::size_t const sequence = cell->sequence.load( std::memory_order_acquire );
+	    std::ptrdiff_t const diff =
+		static_cast<std::ptrdiff_t>( sequence ) - static_cast<std::ptrdiff_t>( position );
+	    if ( diff == 0 )
+	    {
+		if ( enqueuePos.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) )
+		    break;
+	    }
+	    else if ( diff < 0 )
+		return false;				// full
+	    else
+		position = enqueuePos.load( std::memory_order_relaxed );
+	}
+	cell->data = std::move( item );
+	cell->sequence.store( position + 1, std::memory_order_release );
+	return true;
+      }
+
+    /// Move the oldest item out of the queue; returns false if the queue is empty
+    bool TryPop ( T & item )
+      {
+	Cell * cell = nullptr;
+	std::size_t position = dequeuePos.load( std::memory_order_relaxed );
+	while ( true )
+	{
+	    cell = &cells[ position & mask ];
+	    std::size_t const sequence = cell->sequence.load( std::memory_order_acquire );
+	    std::ptrdiff_t const diff =
+		static_cast<std::ptrdiff_t>( sequence ) - static_cast<std::ptrdiff_t>( position + 1 );
+	    if ( diff == 0 )
+	    {
+		if ( dequeuePos.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) )
+		    break;
+	    }
+	    else if ( diff < 0 )
+		return false;				// empty
+	    else
+		position = dequeuePos.load( std::memory_order_relaxed );
+	}
+	item = std::move( cell->data );
+	cell->sequence.store( position + mask + 1, std::memory_order_release );
+	return true;
+      }
+
+    /// Number of items in the queue; approximate while other threads use it
+    std::size_t Size () const
+      {
+	std::size_t const pushed = enqueuePos.load( std::memory_order_relaxed );
+	std::size_t const popped = dequeuePos.load( std::memory_order_relaxed );
+	return ( pushed > popped ? pushed - popped : 0 );
+      }
+
+    std::size_t Capacity () const { return capacity; }
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    struct Cell
+    {
+	std::atomic<std::size_t> sequence;
+	T data;
+    };
+
+    static std::size_t RoundUp ( std::size_t const n )
+      {
+	std::size_t size = 2;
+	while ( size < n )
+	    size <<= 1;
+	return size;
+      }
+
+    std::size_t const capacity;
+    std::size_t const mask;
+    std::unique_ptr<Cell[]> cells;
+    char padding1 [64];			// positions are on separate cache lines
+    std::atomic<std::size_t> enqueuePos;
+    char padding2 [64];
+    std::atomic<std::size_t> dequeuePos;
+
+    // functions that should not be used; are not defined
+    BoundedQueue (BoundedQueue const & object);
+    BoundedQueue & operator= (BoundedQueue const & object);
+
+    /// @endcond
+};
+
+
+} // namespace mtbmpi
+
+#endif // INC_mtbmpi_BoundedQueue_h
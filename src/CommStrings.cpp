@@ -14,9 +14,11 @@ copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
 #include "CommStrings.h"
 #include "MsgTags.h"
 #include "Master.h"
+#include "MatchedProbe.h"
 #include <stdexcept>
 #include <sstream>
-#include <cassert>
+#include <cstring>
+#include <limits>
 
 // DEBUGGING
 // #define DEBUG_CommStrings 1
@@ -27,15 +29,6 @@ copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
   using std::endl;
 #endif
 
-// for mpi versions that do NOT have exceptions enabled, define this:
-#if defined(OMPI_HAVE_CXX_EXCEPTION_SUPPORT)
-  #undef CommStrings_DO_ERROR_CHECKS
-#elif defined(MPICH)
-  #undef CommStrings_DO_ERROR_CHECKS
-#else
-  #define CommStrings_DO_ERROR_CHECKS
-#endif
-
 inline std::string MakeMyName (
     std::string const className,
     unsigned int const id)
@@ -59,8 +52,11 @@ CommStrings::CommStrings (
     : idParent     ( parentID ),
       logger       ( useLogger ),
       comm         ( useComm ),
-      asyncBuffers ( comm.GetComm().Get_size(), TBuffer() ),
-      sendCount    ( 0 )
+      asyncBuffers ( comm.GetComm().Get_size() ),
+      sendCount    ( 0 ),
+      scatterRoot  ( -1 ),
+      scatterCount ( 0 ),
+      dataRequest  ( MPI_REQUEST_NULL )
 {
 }
 
@@ -70,96 +66,65 @@ CommStrings::~CommStrings ()
     asyncBuffers.clear();
 }
 
-/// @cond SKIP_PRIVATE
-
-void CommStrings::PrepareData (
-    StrVec & strVec,		// strings to send
-    int & numChars)		// returns sum of strVec sizes
+int CommStrings::Pack (
+    StrVec const & strVec,
+    std::vector<char> & buffer)
 {
-    numChars = 0;
-    // append delimiter to lines so destination can split
-    StrVec::iterator iSV = strVec.begin();
-    while ( iSV != strVec.end() )
-    {
-	iSV->push_back ( CommStrings::lineDelimiter );
-	numChars += iSV->size();
-	++iSV;
-    }
+    buffer.clear();
+    return AppendPacked( strVec, buffer );
 }
 
-int CommStrings::PackData (
+/// @cond SKIP_PRIVATE
+
+int CommStrings::AppendPacked (
     StrVec const & strVec,
-    int const numCharsInArray,
-    TBuffer & buffer)
+    TBufferData & buffer)
 {
-    std::string const myName = MakeMyName( "CommStrings::PackData", idParent );
-    #ifdef DEBUG_CommStrings
+    // size the buffer once, then copy each line and its delimiter
+    TBufferData::size_type numChars = 0;
+    for ( StrVec::const_iterator iSV = strVec.begin(); iSV != strVec.end(); ++iSV )
+	numChars += iSV->size() + 1;
+    TBufferData::size_type const start = buffer.size();
+    if ( start + numChars > static_cast<TBufferData::size_type>( std::numeric_limits<int>::max() ) )
+	throw std::runtime_error( "CommStrings::Pack: strings exceed the maximum MPI message size." );
+    buffer.resize( start + numChars );
+    char * dest = buffer.data() + start;
+    for ( StrVec::const_iterator iSV = strVec.begin(); iSV != strVec.end(); ++iSV )
     {
-	std::ostringstream oss;
-	oss << myName
-	     << "parent task ID = " << idParent
-	     << ": packing data"
-	     << ": number of lines = " << strVec.size()
-	     << ": # chars = " << numCharsInArray;
-	logger.Message( oss.str() );
+	if ( !iSV->empty() )
+	    std::memcpy( dest, iSV->data(), iSV->size() );
+	dest += iSV->size();
+	*dest++ = lineDelimiter;
     }
-    #endif
+    return static_cast<int>( numChars );
+}
 
-    // make an buffer to hold packed data
-    int const sizePacked = MPI::CHAR.Pack_size( numCharsInArray, comm.GetComm() );
-    assert( sizePacked >= numCharsInArray );
-    buffer.second = sizePacked;
-    TBufferData & bufferData = buffer.first;
-    bufferData.assign( sizePacked, NULL_CHAR );
-    // add data to bufferData
-    int position = 0;
-    StrVec::const_iterator iSV = strVec.begin();
-    while ( iSV != strVec.end() )
+/// @endcond
+
+void CommStrings::Unpack (
+    char const * const data,
+    int const size,
+    StrVec & strVec)
+{
+    // one scan for the delimiters; a final line without a delimiter is kept
+    char const * line = data;
+    char const * const end = data + size;
+    while ( line < end )
     {
-	//----- DEBUG START
-//	std::string const findThis = "nc,10291";
-//	std::string const line = *iSV;
-//	if ( line.find( findThis ) != std::string::npos )
-//	{
-//	    std::ostringstream oss;
-//	    oss << myName << "DEBUG found \"" << findThis << "\"\n  Line = " << line
-//	    	<< "\n  line length = " << line.size()
-//	    	<< "\n  Packing buffer Pack_size = " << sizePacked;
-//	    logger.Message( oss.str() );
-//	}
-	//----- DEBUG END
-
-	MPI::CHAR.Pack(
-	    iSV->data(), iSV->size(),		// pack this
-	    &bufferData[0], sizePacked,		// store here
-	    position,				// where in buf
-	    comm.GetComm() );			// communicator
-	CheckErrorMPI( myName );
-	#ifdef CommStrings_DO_ERROR_CHECKS
-	  // doesn't work on crayxt
-	  if ( position == 0 )     // oops
-	  {
-	      std::ostringstream oss;
-	      oss << myName
-		  << "parent task ID = " << idParent
-		  << ": MPI::CHAR.Pack error msg: " << GetErrorString();
-	      throw std::runtime_error( oss.str() );
-	  }
-	#else
-	  // hopefully exception is thrown upon error
-	#endif
-	++iSV;
+	char const * delimiter =
+	    static_cast<char const *>( std::memchr( line, lineDelimiter, end - line ) );
+	if ( delimiter == nullptr )
+	    delimiter = end;
+	if ( delimiter > line )
+	    strVec.emplace_back( line, delimiter );
+	line = delimiter + 1;
     }
-    assert(position <= sizePacked);
-    return position;
 }
 
-/// @endcond
-
 void CommStrings::Isend (
     IDNum const destinationID,		// destination task ID
     MsgTags const msgTag,		// tag ID for message
-    StrVec & strVec )			// strings to send
+    StrVec const & strVec )		// strings to send
 {
     // send buffer
     std::string const myName = MakeMyName( "CommStrings::Isend", idParent );
@@ -175,29 +140,24 @@ void CommStrings::Isend (
     }
     #endif
 
-    // Pack the data into an MPI::PACKED buffer
-    // first = buffer data, second = size
-
-    int numCharsInArray = 0;
-    PrepareData( strVec, numCharsInArray );
-
     // store buffer until WaitAll is done
-    //asyncBuffers.push_back( TBuffer() );
-    //TBuffer & buffer = asyncBuffers.back();
-    TBuffer & buffer = asyncBuffers[ sendCount ];
-    int const packedSize = PackData( strVec, numCharsInArray, buffer );
-    assert( packedSize >= numCharsInArray );
+    if ( sendCount == static_cast<int>( asyncBuffers.size() ) )
+	asyncBuffers.resize( sendCount + 1 );
+    TBufferData & buffer = asyncBuffers[ sendCount ];
+    int const size = Pack( strVec, buffer );
 
     #ifdef DEBUG_CommStrings
+    {
 	std::ostringstream oss;
-	oss << myName << "enter"
+	oss << myName
 	     << ": destination ID = " << destinationID
-	     << ": buffer size (bytes) = " << buffer.second;
+	     << ": buffer size (bytes) = " << size;
 	logger.Message( oss.str() );
+    }
     #endif
 
     MPI::Request newRequest =
-	comm.GetComm().Isend( buffer.first.data(), buffer.second, MPI::PACKED, destinationID, msgTag );
+	comm.GetComm().Isend( buffer.data(), size, MPI::CHAR, destinationID, msgTag );
     requests.push_back( newRequest );
     CheckErrorMPI( myName );	// error check for when MPI exceptions are turned off
     ++sendCount;
@@ -246,95 +206,28 @@ void CommStrings::Receive (
 	std::ostringstream oss;
 	oss << myName
 	    << ": source ID = " << sourceID
-	    << ": comm.Probe";
+	    << ": Mprobe";
 	logger.Message( oss.str() );
     }
     #endif
+    MPI_Message message;
     MPI::Status status;
-    comm.GetComm().Probe( sourceID, msgTag, status );
-    //int const sizePacked = status.Get_count(MPI::PACKED);
-    int const sizePacked = status.Get_count(MPI::CHAR);
-    int const maxLineLength = 2048;      // max size of cmd-line expected
-    // unpack message
-    if ( sizePacked > 0 )
-    {
-	TBufferData buffer ( sizePacked, NULL_CHAR );
-	comm.GetComm().Recv( &buffer[0], buffer.size(), MPI::CHAR, status.Get_source(), status.Get_tag() );
-	CheckErrorMPI( myName );	// error check for when MPI exceptions are turned off
-	#ifdef DEBUG_CommStrings
-	{
-	    std::ostringstream oss;
-	    oss << myName
-		<< ": source ID = " << sourceID
-		<< ": Recv finished. Size = " << sizePacked;
-	    logger.Message( oss.str() );
-	}
-	#endif
-
-	int posPacked = 0;
-	int posUnpacked = 0;
-	TBufferData bufUnpacked (maxLineLength, NULL_CHAR);
-	while ( posPacked < sizePacked && posUnpacked < maxLineLength )
-	{
-	    MPI::CHAR.Unpack (
-		    buffer.data(), sizePacked,		// packed data
-		    &bufUnpacked[posUnpacked], 1,	// unpacked data, 1 char per iter
-		    posPacked,				// where in buffer
-		    comm.GetComm() );			// communicator
-
-	    // extract string
-	    TBufferData::iterator iNow = bufUnpacked.begin() + posUnpacked;
-	    bool const atEnd = ( posPacked == sizePacked || posUnpacked == maxLineLength );
-	    if ( *iNow == lineDelimiter || atEnd )
-	    {
-		// store cmd-line list in config
-		std::string const line ( bufUnpacked.begin(), iNow );
-		#ifdef DEBUG_CommStrings
-		{
-		    std::ostringstream oss;
-		    oss << myName
-			 << ": source ID = " << sourceID
-			 << ": new line = " << line;
-		    logger.Message( oss.str() );
-		}
-		#endif
-		if ( !line.empty() )
-		    strVec.push_back ( line );
-
-		//----- DEBUG START
-//		std::string const findThis = "nc,10291";
-//		if ( line.find( findThis ) != std::string::npos )
-//		{
-//		    std::ostringstream oss;
-//		    oss << myName
-//			<< "DEBUG found \"" << findThis << "\"\n  Line = " << line
-//			<< "\n  sizePacked = " << sizePacked
-//			<< "  posPacked = " << posPacked
-//			<< "  posUnpacked = " << posUnpacked;
-//		    logger.Message( oss.str() );
-//		}
-		//----- DEBUG END
-
-		std::fill ( bufUnpacked.begin(), bufUnpacked.end(), NULL_CHAR );
-		posUnpacked = 0;
-	    }
-	    else // unpack next char
-		++posUnpacked;
-	}
-    }
-    else // sizePacked == 0
+    Mprobe( comm.GetComm(), sourceID, msgTag, message, status );
+    int const size = status.Get_count( MPI::CHAR );
+    recvBuffer.resize( size );
+    Mrecv( recvBuffer.data(), size, MPI::CHAR, message );
+    CheckErrorMPI( myName );	// error check for when MPI exceptions are turned off
+    #ifdef DEBUG_CommStrings
     {
-	comm.GetComm().Recv ( 0, 0, MPI::PACKED, status.Get_source(), status.Get_tag() );
-	#ifdef DEBUG_CommStrings
-	{
-	    std::ostringstream oss;
-	    oss << myName
-		 << ": source ID = " << sourceID
-		 << ": Recv finished. Size = 0";
-	    logger.Message( oss.str() );
-	}
-	#endif
+	std::ostringstream oss;
+	oss << myName
+	    << ": source ID = " << sourceID
+	    << ": Recv finished. Size = " << size;
+	logger.Message( oss.str() );
     }
+    #endif
+
+    Unpack( recvBuffer.data(), size, strVec );
 }
 
 void CommStrings::WaitAll ()
@@ -368,6 +261,7 @@ void CommStrings::WaitAll ()
 	    }
 	}
 	requests.clear();
+	sendCount = 0;			// buffers can be reused
 
 	#ifdef DEBUG_CommStrings
 	{
@@ -380,4 +274,104 @@ void CommStrings::WaitAll ()
 }
 
 
+void CommStrings::Scatterv (
+    IDNum const rootID,
+    std::vector<StrVec> const & strVecs,
+    StrVec & strVec )
+{
+    Iscatterv( rootID, strVecs );
+    WaitScatterv( strVec );
+}
+
+void CommStrings::Iscatterv (
+    IDNum const rootID,
+    std::vector<StrVec> const & strVecs )
+{
+    std::string const myName = MakeMyName( "CommStrings::Iscatterv", idParent );
+    if ( IsScattering() )
+	throw std::runtime_error( myName + "previous scatter is not finished." );
+
+    MPI::Intracomm & intracomm = comm.GetComm();
+    int const commSize = intracomm.Get_size();
+    bool const isRoot = ( intracomm.Get_rank() == rootID );
+    if ( isRoot )
+    {
+	if ( static_cast<int>( strVecs.size() ) != commSize )
+	{
+	    std::ostringstream oss;
+	    oss << myName << "number of string arrays (" << strVecs.size()
+		<< ") != communicator size (" << commSize << ")";
+	    throw std::runtime_error( oss.str() );
+	}
+	// one buffer; each rank's strings are contiguous
+	scatterBuffer.clear();
+	scatterCounts.resize( commSize );
+	scatterDispls.resize( commSize );
+	for ( int rank = 0; rank < commSize; ++rank )
+	{
+	    scatterDispls[rank] = static_cast<int>( scatterBuffer.size() );
+	    scatterCounts[rank] = AppendPacked( strVecs[rank], scatterBuffer );
+	}
+    }
+    #ifdef DEBUG_CommStrings
+    {
+	std::ostringstream oss;
+	oss << myName << "root = " << rootID;
+	if ( isRoot )
+	    oss << ": buffer size (bytes) = " << scatterBuffer.size();
+	logger.Message( oss.str() );
+    }
+    #endif
+
+    // receivers need their counts before posting the data scatter;
+    // the counts are small, so they are scattered here, and every rank
+    // posts the data scatter here, in the same order of collectives
+    int result = MPI_Scatter (
+	    scatterCounts.data(), 1, MPI_INT, &scatterCount, 1, MPI_INT,
+	    rootID, intracomm );
+    if ( result == MPI_SUCCESS )
+    {
+	recvBuffer.resize( scatterCount );
+	result = MPI_Iscatterv (
+	    scatterBuffer.data(), scatterCounts.data(), scatterDispls.data(), MPI_CHAR,
+	    recvBuffer.data(), scatterCount, MPI_CHAR,
+	    rootID, intracomm, &dataRequest );
+    }
+    if ( result == MPI_SUCCESS )
+	scatterRoot = rootID;
+    else
+    {
+	std::ostringstream oss;
+	oss << myName << "MPI error " << result;
+	throw std::runtime_error( oss.str() );
+    }
+}
+
+void CommStrings::WaitScatterv (
+    StrVec & strVec )
+{
+    std::string const myName = MakeMyName( "CommStrings::WaitScatterv", idParent );
+    if ( !IsScattering() )
+	throw std::runtime_error( myName + "Iscatterv was not called." );
+
+    int const result = MPI_Wait( &dataRequest, MPI_STATUS_IGNORE );
+    scatterRoot = -1;
+    if ( result != MPI_SUCCESS )
+    {
+	std::ostringstream oss;
+	oss << myName << "MPI error " << result;
+	throw std::runtime_error( oss.str() );
+    }
+    #ifdef DEBUG_CommStrings
+    {
+	std::ostringstream oss;
+	oss << myName << "received size (bytes) = " << scatterCount;
+	logger.Message( oss.str() );
+    }
+    #endif
+
+    Unpack( recvBuffer.data(), scatterCount, strVec );
+}
+
+
 } // namespace mtbmpi
@@ -2,6 +2,15 @@
 @file		CommStrings.h
 @class		mtbmpi::CommStrings
 @brief 		Sends an array of strings to specified tasks, using the specified MPI communicator.
+@details
+		The strings are sent as one contiguous MPI::CHAR buffer,
+		each followed by CommStrings::lineDelimiter.
+		There is no limit on the length of a string.
+		Strings should not contain the delimiter, and empty strings are not received.
+
+		Scatterv and Iscatterv are collective over the communicator:
+		the root packs a string array for each rank into one buffer,
+		and each rank receives and unpacks only its own strings.
 @example	../tests/Test_CommStrings.cpp
 @internal
 project		Master-Task-Blackboard MPI Framework
@@ -42,7 +51,7 @@ namespace mtbmpi {
 	void Isend (
 	  IDNum const destinationID,		///< destination task ID
 	  MsgTags const msgTag,			///< tag ID for message
-	  StrVec & strVec );			///< strings to send
+	  StrVec const & strVec );		///< strings to send
 
 	/// Call by receiver only; receives the string array
 	void Receive(
@@ -50,21 +59,54 @@ namespace mtbmpi {
 	  MsgTags const msgTag,			///< tag ID for message
 	  StrVec & strVec );			///< returns received strings
 
-	/// Call by sender only; call after all Sends are done
+	/// Call by sender only; call after all Sends are done.
+	/// The send buffers are then reused by the next round of Isend.
 	void WaitAll ();
 
+	/// Collective; all ranks in the communicator must call.
+	/// Sends strVecs[rank] to each rank; blocks until my strings are received.
+	void Scatterv (
+	  IDNum const rootID,			///< rank which sends; in the communicator
+	  std::vector<StrVec> const & strVecs,	///< used by root only; one per rank
+	  StrVec & strVec );			///< returns my strings
+
+	/// Collective; all ranks in the communicator must call.
+	/// Starts a nonblocking scatter; call WaitScatterv to finish.
+	/// The root's strVecs are packed, and the sizes scattered, before this returns;
+	/// every rank has then posted the data scatter.
+	void Iscatterv (
+	  IDNum const rootID,			///< rank which sends; in the communicator
+	  std::vector<StrVec> const & strVecs );	///< used by root only; one per rank
+
+	/// Finishes the scatter started by Iscatterv
+	void WaitScatterv (
+	  StrVec & strVec );			///< returns my strings
+
+	/// true if Iscatterv was called and WaitScatterv was not
+	bool IsScattering () const { return scatterRoot >= 0; }
+
 	/// number of sends == number of destination processes
 	int GetSendCount () const { return sendCount; }
 
 	static char const lineDelimiter;		///< packed data delimiter
 
+	/// Pack strings into a buffer of delimited lines; returns the buffer size
+	static int Pack (
+	  StrVec const & strVec,		///< strings to pack
+	  std::vector<char> & buffer );		///< returns packed data
+
+	/// Split a buffer of delimited lines; appends the non-empty lines to strVec
+	static void Unpack (
+	  char const * const data,		///< packed data
+	  int const size,			///< number of chars in data
+	  StrVec & strVec );			///< returns strings
+
       private:
 
 	/// @cond SKIP_PRIVATE
 
 	typedef std::vector<char>		TBufferData;	// bytes
-	typedef std::pair< TBufferData, int>	TBuffer;	// data, size
-	typedef std::vector< TBuffer >		TBufferArray;	// array of buffers
+	typedef std::vector< TBufferData >	TBufferArray;	// array of buffers
 
 	int const idParent;
 	LoggerMPI & logger;
@@ -72,15 +114,19 @@ namespace mtbmpi {
 	std::vector<MPI::Request> requests;
 	TBufferArray asyncBuffers;		// asynchronous send buffers; size = no. work processes
 	int sendCount;				// number of sends == number of destination processes
+	TBufferData recvBuffer;			// reused by Receive, WaitScatterv
 
-	int PackData (				// returns buffer, size
-	  StrVec const & strVec,
-	  int const numCmdLines,
-	  TBuffer & buffer);
+	// scatter state
+	int scatterRoot;			// root of scatter in progress, or -1
+	TBufferData scatterBuffer;		// root: packed strings for all ranks
+	std::vector<int> scatterCounts;		// root: chars for each rank
+	std::vector<int> scatterDispls;		// root: offsets into scatterBuffer
+	int scatterCount;			// chars for my rank
+	MPI_Request dataRequest;		// scatter of scatterBuffer
 
-	void PrepareData (
-	  StrVec & strVec,			///< strings to send
-	  int & numChars);			///< returns sum of strVec sizes
+	static int AppendPacked (		// returns chars appended
+	  StrVec const & strVec,
+	  TBufferData & buffer);
 
 	// unused functions
 	CommStrings (CommStrings const & rhs);
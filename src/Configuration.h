@@ -6,6 +6,47 @@
 		Converts the raw command-line arguments to a vector<string>.
 
 		The tasks and master have access to the same configuration object.
+		Every MPI process creates its configuration from the same command-line.
+
+		Command-line arguments of the form `--mtbmpi-name=value` are options
+		for the framework, and are not included in GetArgs().
+		Framework options:
+		- `--mtbmpi-subcontroller-tasks=N`	Use one sub-controller per N work tasks.
+							Default = 0 (no sub-controllers).
+		- `--mtbmpi-collective-phases`		Broadcast initialize, start and stop to all tasks.
+		- `--mtbmpi-task-threads=N`		Each work rank runs N logical tasks in threads.
+							Default = 1.
+		- `--mtbmpi-blackboard-thread`		Run the Blackboard in a thread of rank 0, so that
+							work tasks start at rank 1.
+		- `--mtbmpi-result-chunk-size=BYTES`	Result stream chunk size. Default = 1 MB.
+		- `--mtbmpi-result-credits=N`		Result stream chunks in flight. Default = 4.
+		- `--mtbmpi-blackboard-batch=N`		Bulk messages the Blackboard receives between
+							checks for stop requests. Default = 64.
+		- `--mtbmpi-shared-log[=BYTES]`		Send log messages through node-local shared memory
+							rings of BYTES per rank. Default = 64 KB.
+		- `--mtbmpi-result-window[=BYTES]`	Tasks put result records into an RMA window
+							of BYTES in the Blackboard. Default = 16 MB.
+		- `--mtbmpi-async-blackboard[=RECORDS]`	Blackboard writes the log and output in
+							threads with queues of RECORDS. Default = 4096.
+		- `--mtbmpi-async-drop-logs`		With async-blackboard, discard log messages
+							when the log queue is full.
+		- `--mtbmpi-log-flush=POLICY`		Flush the log file: `close`, `errors`, or
+							every MS milliseconds. Default = 1000.
+		- `--mtbmpi-log-max-size=BYTES`		Rotate the log file at BYTES. Default = no limit.
+		- `--mtbmpi-log-max-age=SECONDS`	Rotate the log file after SECONDS. Default = no limit.
+		- `--mtbmpi-log-batch[=BYTES]`		Send each rank's log messages in batches
+							of BYTES. Default = 16 KB.
+		- `--mtbmpi-log-batch-age=MS`		With log-batch or log-mpiio, send a batch after MS
+							milliseconds. Default = 250.
+		- `--mtbmpi-log-level=NAME`		Write log messages at or above NAME: trace, debug,
+							info, warning, error, or off. Default = info.
+		- `--mtbmpi-log-format=FORMAT`		Log file format: `text` or `binary`. Default = text.
+		- `--mtbmpi-log-mpiio[=BYTES]`		Each rank writes its log messages to the log file
+							with MPI-IO, in buffers of BYTES (default 64 KB).
+							The file is text and is not rotated.
+		- `--mtbmpi-log-local[=DIRECTORY]`	Each rank writes its log messages to a file in
+							DIRECTORY (default: TMPDIR or /tmp); the files are
+							merged into the log file at the end.
 
 		This class can be inherited and extended to provide additional processing
 		of command-line arguments.
@@ -22,6 +63,7 @@ project		Master-Task-Blackboard MPI Framework
 #define INC_mtbmpi_Configuration_h
 
 #include "UtilitiesMPI.h"
+#include <map>
 
 namespace mtbmpi {
 
@@ -29,16 +71,58 @@ namespace mtbmpi {
     {
       public:
 
+	typedef std::map<std::string, std::string>	OptionMap;	///< option name, value
+
 	/// Constructor
 	Configuration (
 	    int const argc,				///< number of command-line arguments
 	    char const * const * const argv)		///< raw command-line arguments
 	{
-	    ToStrVec (args, argv + 1, argv + argc);
+	    StrVec allArgs;
+	    ToStrVec (allArgs, argv + 1, argv + argc);
+	    for ( StrVec::const_iterator i = allArgs.begin(); i != allArgs.end(); ++i )
+	    {
+		if ( IsOption( *i ) )
+		    AddOption( *i );
+		else
+		    args.push_back( *i );
+	    }
 	}
 
 	StrVec const & GetArgs () const { return args; }
 
+	/// True if the framework option was on the command-line.
+	bool HaveOption (
+	    std::string const & name) const		///< option name without the prefix
+	{
+	    return options.find( name ) != options.end();
+	}
+
+	/// Get the value of a framework option.
+	template < class T >
+	T GetOption (
+	    std::string const & name,			///< option name without the prefix
+	    T const defaultValue) const			///< value if the option is absent
+	{
+	    OptionMap::const_iterator i = options.find( name );
+	    return ( i == options.end() ? defaultValue : FromString<T>( i->second ) );
+	}
+
+	OptionMap const & GetOptions () const { return options; }	///< all framework options
+
+	/// True if the command-line argument is a framework option.
+	static bool IsOption ( std::string const & arg )
+	{
+	    return arg.compare( 0, OptionPrefix().size(), OptionPrefix() ) == 0;
+	}
+
+	/// Prefix of framework options on the command-line.
+	static std::string const & OptionPrefix ()
+	{
+	    static std::string const prefix = "--mtbmpi-";
+	    return prefix;
+	}
+
 	virtual ~Configuration () {}
 
       private:
@@ -46,6 +130,18 @@ namespace mtbmpi {
 	/// @cond SKIP_PRIVATE
 
 	StrVec args;
+	OptionMap options;
+
+	// option has the form --mtbmpi-name=value or --mtbmpi-name
+	void AddOption ( std::string const & arg )
+	{
+	    std::string const nameValue = arg.substr( OptionPrefix().size() );
+	    std::string::size_type const posEquals = nameValue.find( '=' );
+	    if ( posEquals == std::string::npos )
+		options[ nameValue ] = "1";
+	    else
+		options[ nameValue.substr( 0, posEquals ) ] = nameValue.substr( posEquals + 1 );
+	}
 
 	// functions that should not be used; are not defined
 	Configuration (Configuration const & object);
@@ -18,7 +18,10 @@ copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
 #include "Controller.h"
 #include "Master.h"
 #include "UtilitiesMPI.h"
+#include "MatchedProbe.h"
 #include <sstream>
+#include <algorithm>
+#include <climits>
 
 // define the following to write diagnostics to std::cout
 // #define DBG_MPI_CONTROLLER
@@ -32,6 +35,22 @@ copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
 namespace mtbmpi {
 
 
+namespace {
+
+    int const maxStateReceives = 64;	// pre-posted Tag_State receives
+
+    // tags of the messages which WaitForMessage returns
+    int const requestTags[] = { Tag_StateSummary, Tag_RequestWorkItems, Tag_RequestStop,
+				Tag_RequestCmdLineArgs, Tag_RequestConfig };
+
+    // tags of the results and log messages for the Blackboard, which
+    // arrive on comm if sent as in earlier versions; when the Blackboard
+    // is a thread of the Controller's rank, it does not probe comm for them
+    int const blackboardTags[] = { Tag_TaskResults, Tag_LogMessage, Tag_ErrorMessage,
+				   Tag_LogRecord };
+
+} // namespace
+
 Controller::Controller (
     Master & useParent,			// parent of task
     IDNum const myId,			// controller (master) rank
@@ -44,7 +63,9 @@ Controller::Controller (
       parent (useParent),
       idFirstTask (firstTaskID),
       pConfig (configPtr),
-      stateBB ( State_Unknown )
+      stateBB ( State_Unknown ),
+      phasesFinished ( false ),
+      stateReceive ( mtbmpi::comm, Tag_State, 2, std::min( numTasks + 1, maxStateReceives ) )
 {
     pTracker.reset ( new Tracker (numTasks) );
     #ifdef DBG_MPI_CONTROLLER
@@ -103,7 +124,15 @@ void Controller::Activate ()
 	{
 	    if ( tasksAreCreated && !tasksAreInitialized  )
 	    {
-		InitializeAllTasks ();
+		if ( IsWorkQueueMode() )
+		{
+		    // tasks initialize and start once per work item
+		    StartWorkQueue ();
+		    tasksAreInitialized = true;
+		    tasksAreStarted = true;
+		}
+		else
+		    InitializeAllTasks ();
 		requestedInitAll = true;
 	    }
 	}
@@ -113,7 +142,7 @@ void Controller::Activate ()
 	    tasksAreStarted = true;
 	}
 
-	tasksAreStopped = GetTracker().AreAllStopped();
+	tasksAreStopped = AreAllTasksStopped();
 	#ifdef DBG_MPI_CONTROLLER
 	    cout << myName << "tasksAreStopped: "
 		 << ( tasksAreStopped ? "yes" : "no" )
@@ -135,40 +164,48 @@ void Controller::Activate ()
 	    // Change task state according to message.
 	    // When all task are done, send msg to master.
 	    #ifdef DBG_MPI_CONTROLLER
-	      cout << myName << "comm.Probe: start" << endl;
+	      cout << myName << "WaitForMessage: start" << endl;
 	    #endif
+	    MPI_Message message;
 	    MPI::Status status;
-	    mtbmpi::comm.Probe ( MPI_ANY_SOURCE, MPI_ANY_TAG, status );
+	    int const tag = ( WaitForMessage (message, status) ? status.Get_tag() : Tag_State );
 	    #ifdef DBG_MPI_CONTROLLER
-	      cout << myName << "comm.Probe: processing msg" << endl;
+	      cout << myName << "WaitForMessage: processing msg" << endl;
 	    #endif
 
-	    switch ( status.Get_tag() )
+	    switch ( tag )
 	    {
 	      case Tag_State:
-		DoActionState (status);
+		break;			// handled by WaitForMessage
+
+	      case Tag_StateSummary:
+		DoActionStateSummary (message, status);
+		break;
+
+	      case Tag_RequestWorkItems:
+		DoActionRequestWorkItems (message, status);
 		break;
 
 	      case Tag_RequestStop:
-		DoActionRequestStop (status);
+		DoActionRequestStop (message, status);
 		break;
 
 	      case Tag_RequestCmdLineArgs:
-		DoActionRequestCmdLineArgs (status);
+		DoActionRequestCmdLineArgs (message, status);
 		break;
 
 	      case Tag_RequestConfig:
-		DoActionRequestConfig (status);
+		DoActionRequestConfig (message, status);
 		break;
 
 	      default:
 		/// @todo  log unhandled message received
 		break;
 
-	    } // switch ( status.Get_tag() )
+	    } // switch ( tag )
 	} // listenForMsgs
 
-	tasksAreStopped = GetTracker().AreAllStopped();	// update
+	tasksAreStopped = AreAllTasksStopped();	// update
 	if ( tasksAreStopped )
 	{
 	    #ifdef DBG_MPI_CONTROLLER
@@ -182,8 +219,14 @@ void Controller::Activate ()
 	    std::ostringstream os;
 	    os << "Elapsed time for all tasks (seconds): " << timer.read();
 	    Log().Message( os.str() );
+	    if ( IsWorkQueueMode() )
+		LogWorkQueueSummary ();
 
+	    if ( !IsDataSent() )
+		Log().Error( "Controller: data was sent to tasks which stopped before receiving it." );
+	    FinishPhases ();
 	    StopBlackboard ();
+	    stateReceive.Close ();	// before MPI finalize
 	    listenForMsgs = false;
 	}
 
@@ -195,28 +238,196 @@ void Controller::Activate ()
     #endif
 }
 
+bool Controller::HaveSubControllers () const
+{
+    return parent.GetNumberOfSubControllers() > 0;
+}
+
+bool Controller::HaveTaskHosts () const
+{
+    return parent.GetNumberOfTaskThreads() > 1;
+}
+
+void Controller::SendData (
+    IDNum const taskID,
+    int const dataID,
+    void const * const data,
+    std::size_t const size)
+{
+    // header: total bytes, data ID; buffer must remain valid until sent
+    dataHeaders.push_back( {{ static_cast<long long>(size), dataID }} );
+    std::array<long long, 2> const & header = dataHeaders.back();
+    dataRequests.push_back (
+	mtbmpi::comm.Isend ( header.data(), 2, MPI::LONG_LONG, taskID, Tag_Data ) );
+
+    // chunks are at most INT_MAX bytes; they are sent on dataComm,
+    // so that large data does not delay the control messages
+    char const * const bytes = static_cast<char const *>(data);
+    std::size_t offset = 0;
+    while ( offset < size )
+    {
+	int const count = static_cast<int>(
+	    std::min( size - offset, static_cast<std::size_t>(INT_MAX) ) );
+	dataRequests.push_back (
+	    mtbmpi::dataComm.Isend ( bytes + offset, count, MPI::BYTE, taskID, Tag_DataChunk ) );
+	offset += count;
+    }
+}
+
+bool Controller::IsDataSent ()
+{
+    if ( !dataRequests.empty() &&
+	 MPI::Request::Testall ( dataRequests.size(), dataRequests.data() ) )
+    {
+	dataRequests.clear();
+	dataHeaders.clear();
+    }
+    return dataRequests.empty();
+}
+
+void Controller::WaitDataSent ()
+{
+    if ( dataRequests.empty() )
+	return;
+    MPI::Request::Waitall ( dataRequests.size(), dataRequests.data() );
+    dataRequests.clear();
+    dataHeaders.clear();
+}
+
 /// @cond SKIP_PRIVATE
 
-void Controller::DoActionState ( MPI::Status status )
+int Controller::GetNumberOfTaskGroups () const
+{
+    if ( HaveSubControllers() )
+	return parent.GetNumberOfSubControllers();
+    if ( HaveTaskHosts() )
+	return parent.GetNumberOfTasks();
+    return 0;
+}
+
+Controller::IDNum Controller::GetTaskGroupID (
+    int const index ) const
+{
+    return HaveSubControllers() ? parent.GetSubControllerID(index) : idFirstTask + index;
+}
+
+int Controller::GetTaskGroupNumberOfTasks (
+    int const index ) const
+{
+    return HaveSubControllers() ?
+	   parent.GetSubControllerNumberOfTasks(index) : parent.GetNumberOfTaskThreads();
+}
+
+bool Controller::WaitForMessage (
+    MPI_Message & message,
+    MPI::Status & status)
+{
+    // state reports are handled here; other messages are returned
+    // matched, so that each is matched once; Tag_State is not probed,
+    // as it is received by the ring of pre-posted receives
+    int buffer[2];
+    int source = 0;
+    int emptyPolls = 0;
+    while ( true )
+    {
+	if ( stateReceive.Receive( buffer, source ) )
+	{
+	    DoActionState ( source, buffer );
+	    return false;
+	}
+	for ( int const tag : requestTags )
+	{
+	    if ( Improbe ( mtbmpi::comm, MPI_ANY_SOURCE, tag, message, status ) )
+		return true;
+	}
+	if ( GetID() == GetBlackboardID() )
+	    DiscardBlackboardMessages ();
+	PollBackoff( emptyPolls );	// the Controller's rank may also run the Blackboard
+    }
+}
+
+void Controller::DiscardBlackboardMessages ()
+{
+    // a matched message must be received; the error shows the lost messages in the log
+    MPI_Message message;
+    MPI::Status status;
+    for ( int const tag : blackboardTags )
+    {
+	while ( Improbe ( mtbmpi::comm, MPI_ANY_SOURCE, tag, message, status ) )
+	{
+	    DiscardMatched ( message, status );
+	    std::ostringstream os;
+	    os << "Controller: discarded a message with tag " << tag
+	       << " from rank " << status.Get_source()
+	       << ", sent to the Blackboard thread on comm;"
+	       << " results must be sent on resultComm and log messages on logComm.";
+	    Log().Error( os.str() );
+	}
+    }
+}
+
+void Controller::DoActionState (
+    int const source,			// rank which sent the state
+    int const * const buffer)		// 0 = id, 1 = state
 {
     #ifdef DBG_MPI_CONTROLLER
       std::string const myName = "Controller::DoActionState: ";
       cout << myName << "Tag_State: enter: "
-	   << "task ID = " << ( status.Get_source() - idFirstTask )
+	   << "task ID = " << ( source - idFirstTask )
 	   << endl;
     #endif
 
-    if ( (TaskID::IDNum) status.Get_source() == parent.GetBlackboardID() )
+    if ( (TaskID::IDNum) source == parent.GetBlackboardID() )
 	; /// @todo anything?
-    else if ( (TaskID::IDNum) status.Get_source() >= idFirstTask )
-	SetTaskState (status);
+    else if ( (TaskID::IDNum) source >= idFirstTask )
+    {
+	Tracker::size_type taskNum = 0;
+	State const newState = SetTaskState (buffer, taskNum);
+
+	// work-queue mode: a finished item gets the task its next item
+	if ( IsWorkQueueMode() &&
+	     ( IsCompleted(newState) || IsError(newState) ) &&
+	     workQueue.ItemFinished( taskNum, IsCompleted(newState) ) )
+	{
+	    SendNextWorkItem( taskNum );
+	}
+    }
 
     #ifdef DBG_MPI_CONTROLLER
       cout << myName << "Tag_State: done" << endl;
     #endif
 }
 
-void Controller::DoActionRequestStop ( MPI::Status status )
+void Controller::DoActionStateSummary ( MPI_Message & message, MPI::Status status )
+{
+    // summary: items completed, items failed, then (task rank, state) pairs
+    int const count = status.Get_count (MPI::INT);
+    std::vector<int> buffer ( std::max( count, 2 ), 0 );
+    Mrecv ( buffer.data(), count, MPI::INT, message );
+
+    if ( IsWorkQueueMode() )
+	workQueue.ItemsFinished( buffer[0], buffer[1] );
+    for ( int i = 2; i + 1 < count; i += 2 )
+    {
+	Tracker::size_type const taskNum = buffer[i] - idFirstTask;
+	GetTracker().SetState ( taskNum, static_cast<State>( buffer[i + 1] ) );
+    }
+
+    #ifdef DBG_MPI_CONTROLLER
+      cout << "Controller::DoActionStateSummary: sub-controller "
+	   << status.Get_source() << ": "
+	   << (count - 2) / 2 << " task states" << endl;
+    #endif
+}
+
+void Controller::DoActionRequestWorkItems ( MPI_Message & message, MPI::Status status )
+{
+    int maxItems = 0;
+    Mrecv ( &maxItems, 1, MPI::INT, message );
+    SendWorkItems ( status.Get_source(), maxItems );
+}
+
+void Controller::DoActionRequestStop ( MPI_Message & message, MPI::Status status )
 {
     Log().Message("Controller: received stop request.");
     #ifdef DBG_MPI_CONTROLLER
@@ -226,9 +437,7 @@ void Controller::DoActionRequestStop ( MPI::Status status )
 
     // do a recv so message is marked as received
     char charBuffer = NULL_CHAR;
-    mtbmpi::comm.Recv (
-	    &charBuffer, 1, MPI::CHAR,
-	    status.Get_source(), Tag_RequestStop, status );
+    Mrecv ( &charBuffer, 1, MPI::CHAR, message );
 
     #ifdef DBG_MPI_CONTROLLER
       cout << myName << "Tag_RequestStop: StopAllTasks" << endl;
@@ -256,7 +465,7 @@ void Controller::DoActionRequestStop ( MPI::Status status )
     #endif
 }
 
-void Controller::DoActionRequestCmdLineArgs ( MPI::Status status )
+void Controller::DoActionRequestCmdLineArgs ( MPI_Message & message, MPI::Status status )
 {
     #ifdef DBG_MPI_CONTROLLER
       std::string const myName = "Controller::DoActionRequestCmdLineArgs: ";
@@ -265,9 +474,7 @@ void Controller::DoActionRequestCmdLineArgs ( MPI::Status status )
 
     // do a recv so message is marked as received
     char charBuffer = NULL_CHAR;
-    mtbmpi::comm.Recv (
-	    &charBuffer, 1, MPI::CHAR,
-	    status.Get_source(), Tag_RequestCmdLineArgs, status );
+    Mrecv ( &charBuffer, 1, MPI::CHAR, message );
 
     // create a buffer to hold the args to send to the task
     std::string buffer;
@@ -282,7 +489,7 @@ void Controller::DoActionRequestCmdLineArgs ( MPI::Status status )
     #endif
 }
 
-void Controller::DoActionRequestConfig ( MPI::Status status )
+void Controller::DoActionRequestConfig ( MPI_Message & message, MPI::Status status )
 {
     #ifdef DBG_MPI_CONTROLLER
       std::string const myName = "Controller::DoActionRequestConfig: ";
@@ -290,9 +497,7 @@ void Controller::DoActionRequestConfig ( MPI::Status status )
     #endif
 
     // do a recv so message is marked as received
-    mtbmpi::comm.Recv (
-	    0, 0, MPI::BYTE,
-	    status.Get_source(), Tag_RequestConfig, status );
+    Mrecv ( 0, 0, MPI::BYTE, message );
 
     /// @todo  Tag_RequestConfig
 
@@ -301,37 +506,30 @@ void Controller::DoActionRequestConfig ( MPI::Status status )
     #endif
 }
 
-void Controller::SetTaskState (
-	MPI::Status & status)		// status from Probe
+State Controller::SetTaskState (	// returns the new state
+	int const * const buffer,	// Tag_State: 0 = id, 1 = state
+	Tracker::size_type & taskNum)	// returns task index
 {
     #ifdef DBG_MPI_CONTROLLER
       std::string const myName = "Controller::SetTaskState: ";
       cout << myName << "enter" << endl;
     #endif
 
-    MPI::Datatype bufferType = MPI::INT;
-    int const bufferSize =
-	    status.Get_count (bufferType) * sizeof(int) * 2;
-	    // status.Get_count (bufferType) * bufferType.Get_extent() * 2;
-    int * buffer = new int [bufferSize];
-    mtbmpi::comm.Recv (
-	    static_cast<void *>(buffer),
-	    bufferSize, bufferType,
-	    status.Get_source(), Tag_State, status );
-
-    /// @todo assert status.Get_source() == buffer[0]
+    /// @todo assert source == buffer[0]
 
+    State taskState = State_Unknown;
     int const taskID = buffer[0];
     if ( taskID >= 0 )
     {
-	State const taskState = static_cast<State>( buffer[1] );
+	taskState = static_cast<State>( buffer[1] );
+	taskNum = taskID - idFirstTask;
 	#ifdef DBG_MPI_CONTROLLER
 	  State const previousState =
 	#endif
-	    GetTracker().SetState ( taskID - idFirstTask, taskState );
+	    GetTracker().SetState ( taskNum, taskState );
 
 	#ifdef DBG_MPI_CONTROLLER
-	    cout << myName << "task rank = " << status.Get_source()
+	    cout << myName << "task rank = " << buffer[0]
 		<< ": previous state = " << AsString(previousState)
 		<< ": new state = " << AsString(taskState)
 		<< endl;
@@ -342,11 +540,11 @@ void Controller::SetTaskState (
 	    Log().Message( os.str() );
 	#endif
     }
-    delete [] buffer;
 
     #ifdef DBG_MPI_CONTROLLER
       cout << myName << "done" << endl;
     #endif
+    return taskState;
 }
 
 
@@ -359,34 +557,7 @@ void Controller::InitializeAllTasks ()
 
     timer.start();
     parent.ActionsAtInitTasks();
-
-    std::vector<MPI::Request> requests;
-    for ( Tracker::size_type taskNum = 0; taskNum < pTracker->Size(); ++taskNum )
-    {
-	requests.push_back(
-	    mtbmpi::comm.Isend (
-		0, 0, MPI::BYTE,
-		(idFirstTask + taskNum), Tag_InitializeTask ) );
-    }
-
-    std::vector<MPI::Status> status ( requests.size() );
-    MPI::Request::Waitall ( requests.size(), requests.data(), status.data() );
-
-    // check for errors
-    for ( std::vector<MPI::Status>::const_iterator i = status.begin();
-	  i != status.end();
-	  ++i )
-    {
-	if ( i->Get_error() != MPI_SUCCESS )
-	{
-	    std::ostringstream os;
-	    os << myName << "send message error."
-	       << " Error: "  << i->Get_error()
-	       << " Tag: "    << i->Get_tag()
-	       << " Source: " << i->Get_source();
-	    Log().Error( os.str() );
-	}
-    }
+    SendToAllTasks ( Tag_InitializeTask, myName );
 
     #ifdef DBG_MPI_CONTROLLER
       cout << myName << "done" << endl;
@@ -395,7 +566,7 @@ void Controller::InitializeAllTasks ()
 
 void Controller::StartAllTasks ()
 {
-    std::string const myName = "Controller::InitializeAllTasks: ";
+    std::string const myName = "Controller::StartAllTasks: ";
     #ifdef DBG_MPI_CONTROLLER
       cout << myName << "comm.Isend: start "
 	   << pTracker->Size() << " tasks"
@@ -403,18 +574,49 @@ void Controller::StartAllTasks ()
     #endif
 
     parent.ActionsBeforeTasksStart();
+    SendToAllTasks ( Tag_StartTask, myName );
+
+    #ifdef DBG_MPI_CONTROLLER
+    cout << myName << "done" << endl;
+    #endif
+}
 
-    std::vector<MPI::Request> requests ( pTracker->Size() );
-    for ( Tracker::size_type taskNum = 0; taskNum < pTracker->Size(); ++taskNum )
+void Controller::SendToAllTasks (
+    MsgTags const tag,
+    std::string const & myName)
+{
+    // one broadcast reaches all tasks
+    if ( parent.GetTaskCommunicator() )
+    {
+	BroadcastPhase ( tag == Tag_InitializeTask ? Phase_Initialize :
+			 tag == Tag_StartTask ? Phase_Start : Phase_Stop );
+	return;
+    }
+
+    // sub-controllers and task hosts relay the message to their tasks
+    std::vector<IDNum> destinations;
+    if ( GetNumberOfTaskGroups() > 0 )
+    {
+	for ( int i = 0; i < GetNumberOfTaskGroups(); ++i )
+	    destinations.push_back( GetTaskGroupID(i) );
+    }
+    else
     {
-	requests[taskNum] = mtbmpi::comm.Isend (
+	for ( Tracker::size_type taskNum = 0; taskNum < pTracker->Size(); ++taskNum )
+	    destinations.push_back( idFirstTask + taskNum );
+    }
+
+    std::vector<MPI::Request> requests ( destinations.size() );
+    for ( std::vector<IDNum>::size_type i = 0; i < destinations.size(); ++i )
+    {
+	requests[i] = mtbmpi::comm.Isend (
 	    0, 0, MPI::BYTE,
-	    (idFirstTask + taskNum), Tag_StartTask );
+	    destinations[i], tag );
     }
 
     #ifdef DBG_MPI_CONTROLLER
     cout << myName << "Request::Waitall: "
-	 << requests.size() << " tasks"
+	 << requests.size() << " destinations"
 	 << endl;
     #endif
 
@@ -436,10 +638,134 @@ void Controller::StartAllTasks ()
 	    Log().Error( os.str() );
 	}
     }
+}
 
+void Controller::BroadcastPhase (
+    CollectivePhase const phase)
+{
     #ifdef DBG_MPI_CONTROLLER
-    cout << myName << "done" << endl;
+      cout << "Controller::BroadcastPhase: " << phase << endl;
     #endif
+
+    // buffer must remain valid until the broadcast completes
+    phaseCodes.push_back( phase );
+    phaseRequests.push_back( MPI_REQUEST_NULL );
+    MPI_Comm const taskComm = parent.GetTaskCommunicator()->GetComm();
+    int const result = MPI_Ibcast (
+	    &phaseCodes.back(), 1, MPI_INT, 0, taskComm, &phaseRequests.back() );
+    if ( result != MPI_SUCCESS )
+    {
+	std::ostringstream os;
+	os << "Controller::BroadcastPhase: MPI_Ibcast error " << result;
+	Log().Error( os.str() );
+    }
+}
+
+void Controller::FinishPhases ()
+{
+    if ( !parent.GetTaskCommunicator() || phasesFinished )
+	return;
+
+    // tasks wait for Phase_Finish before they exit
+    BroadcastPhase ( Phase_Finish );
+    MPI_Waitall ( phaseRequests.size(), phaseRequests.data(), MPI_STATUSES_IGNORE );
+    phaseRequests.clear();
+    phaseCodes.clear();
+    phasesFinished = true;
+}
+
+void Controller::StartWorkQueue ()
+{
+    #ifdef DBG_MPI_CONTROLLER
+      std::string const myName = "Controller::StartWorkQueue: ";
+      cout << myName << workQueue.Size() << " work items, "
+	   << pTracker->Size() << " tasks" << endl;
+    #endif
+
+    timer.start();
+    parent.ActionsAtInitTasks();
+    parent.ActionsBeforeTasksStart();
+
+    std::ostringstream os;
+    os << "Controller: work queue has " << workQueue.Size() << " items for "
+       << pTracker->Size() << " tasks.";
+    Log().Message( os.str() );
+
+    workQueue.SetNumberOfTasks( pTracker->Size() );
+    if ( GetNumberOfTaskGroups() > 0 )
+    {
+	// one item per task; task groups request more as needed
+	for ( int i = 0; i < GetNumberOfTaskGroups(); ++i )
+	    SendWorkItems( GetTaskGroupID(i), GetTaskGroupNumberOfTasks(i) );
+    }
+    else
+    {
+	for ( Tracker::size_type taskNum = 0; taskNum < pTracker->Size(); ++taskNum )
+	    SendNextWorkItem( taskNum );
+    }
+}
+
+void Controller::SendNextWorkItem (
+    Tracker::size_type const taskNum)
+{
+    IDNum const taskID = idFirstTask + taskNum;
+    WorkItem item;
+    if ( workQueue.Next( item ) )
+    {
+	// task is busy until it reports the item is completed
+	GetTracker().SetState( taskNum, State_Created );
+	workQueue.ItemDispatched( taskNum );
+	std::string const buffer = item.Pack();
+	mtbmpi::comm.Send (
+		buffer.data(), buffer.size(), MPI::CHAR,
+		taskID, Tag_WorkItem );
+	CheckErrorMPI( className );
+    }
+    else // queue is empty; this task is done
+    {
+	workQueue.SetTaskDone( taskNum );
+	mtbmpi::comm.Send ( 0, 0, MPI::BYTE, taskID, Tag_RequestStopTask );
+	CheckErrorMPI( className );
+    }
+}
+
+void Controller::SendWorkItems (
+    IDNum const groupID,
+    int const maxItems)
+{
+    // an empty batch tells the task group the queue is empty
+    std::string buffer;
+    workQueue.NextBatch( std::max( maxItems, 1 ), buffer );
+    mtbmpi::comm.Send (
+	    buffer.data(), buffer.size(), MPI::CHAR,
+	    groupID, Tag_WorkItems );
+    CheckErrorMPI( className );
+}
+
+bool Controller::AreAllTasksStopped () const
+{
+    if ( !IsWorkQueueMode() )
+	return GetTracker().AreAllStopped();
+
+    // work-queue mode: completed tasks are waiting for work items,
+    // so all tasks must have been sent the stop request and be terminated
+    bool const allTasksDone =
+	GetNumberOfTaskGroups() > 0 ||	// task groups send stop
+	workQueue.GetNumTasksDone() == GetTracker().Size();
+    return allTasksDone &&
+	   GetTracker().GetCount(State_Terminated) == GetTracker().Size();
+}
+
+void Controller::LogWorkQueueSummary ()
+{
+    double const seconds = timer.read();
+    std::ostringstream os;
+    os << "Work queue: items completed = " << workQueue.GetNumCompleted()
+       << ", failed = " << workQueue.GetNumFailed()
+       << ", not run = " << ( workQueue.GetNumAdded() - workQueue.GetNumFinished() )
+       << ", items/second = "
+       << ( seconds > 0.0 ? workQueue.GetNumFinished() / seconds : 0.0 );
+    Log().Message( os.str() );
 }
 
 bool Controller::StopAllTasks ()	// return true if all tasks are stopped
@@ -450,18 +776,47 @@ bool Controller::StopAllTasks ()	// return true if all tasks are stopped
       cout << myName << "checking " << GetTracker().Size() << " tasks." << endl;
     #endif
 
+    if ( parent.GetTaskCommunicator() )
+    {
+	// one broadcast reaches all tasks; stopped tasks ignore it
+	BroadcastPhase ( Phase_Stop );
+	if ( IsWorkQueueMode() )
+	{
+	    for ( Tracker::size_type taskNum = 0; taskNum < GetTracker().Size(); ++taskNum )
+		workQueue.SetTaskDone( taskNum );
+	}
+    }
+
+    if ( GetNumberOfTaskGroups() > 0 )
+    {
+	// task groups stop their tasks, and stop handing out work items
+	for ( int i = 0; i < GetNumberOfTaskGroups(); ++i )
+	{
+	    mtbmpi::comm.Send ( 0, 0, MPI::BYTE, GetTaskGroupID(i), Tag_RequestStopTask );
+	    CheckErrorMPI( className );
+	}
+    }
+
+    if ( parent.GetTaskCommunicator() || GetNumberOfTaskGroups() > 0 )
+	return AreAllTasksStopped();
+
     int taskNum = 0;		// idFirstTask - idFirstTask
     for ( Tracker::const_iterator iTask = GetTracker().Begin();
 	  iTask != GetTracker().End();
 	  ++iTask, ++taskNum )
     {
-	if ( GetTracker().GetState(taskNum) != State_Completed &&
-	     GetTracker().GetState(taskNum) != State_Terminated &&
-	     GetTracker().GetState(taskNum) != State_Error )
+	// in work-queue mode a completed task waits for its next item
+	bool const isWaiting = ( IsWorkQueueMode() && !workQueue.IsTaskDone(taskNum) );
+	if ( isWaiting ||
+	     ( GetTracker().GetState(taskNum) != State_Completed &&
+	       GetTracker().GetState(taskNum) != State_Terminated &&
+	       GetTracker().GetState(taskNum) != State_Error ) )
 	{
 	    // stop task
 	    mtbmpi::comm.Send ( 0, 0, MPI::BYTE, (idFirstTask + taskNum), Tag_RequestStopTask );
 	    CheckErrorMPI( className );
+	    if ( IsWorkQueueMode() )
+		workQueue.SetTaskDone( taskNum );
 	}
     }
 
@@ -471,7 +826,7 @@ bool Controller::StopAllTasks ()	// return true if all tasks are stopped
 	 << endl;
     #endif
 
-    return GetTracker().AreAllStopped();
+    return AreAllTasksStopped();
 }
 
 void Controller::StopBlackboard ()
@@ -486,7 +841,11 @@ void Controller::StopBlackboard ()
 	#ifdef DBG_MPI_CONTROLLER
 	Log().Message( "Controller: requesting Blackboard to stop" );
 	#endif
-	mtbmpi::comm.Send ( 0, 0, MPI::BYTE, parent.GetBlackboardID(), Tag_StopBlackboard );
+	if ( GetID() == GetBlackboardID() )
+	    DiscardBlackboardMessages ();	// sent before the tasks stopped
+	Log().Flush();		// the batch, if log messages are batched
+	// on logComm, so that the Blackboard receives the log messages before it
+	mtbmpi::logComm.Send ( 0, 0, MPI::BYTE, parent.GetBlackboardID(), Tag_StopBlackboard );
 	// wait for confirmation
 	mtbmpi::comm.Recv ( 0, 0, MPI::BYTE, parent.GetBlackboardID(), Tag_Confirmation );
 	stateBB = State_Completed;
@@ -500,9 +859,10 @@ void Controller::StopBlackboard ()
 
 void Controller::WaitUntilCanStop ()	// return when task rank == 0 can stop safely
 {
-    while ( !GetTracker().AreAllStopped() )
+    while ( !AreAllTasksStopped() )
 	Sleep();
 
+    FinishPhases ();
     if (stateBB != State_Completed)
     	StopBlackboard ();
 }
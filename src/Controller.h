@@ -6,6 +6,36 @@
 		Owns the Blackboard object.
 		Initializes, starts and stops work tasks.
 		Runs in MPI rank == 0 along with Master, and is owned by Master.
+
+		If work items are added to the WorkQueue before the event loop
+		starts, the Controller runs in work-queue mode: each task is given
+		one work item at a time, and is given the next item when it reports
+		that its current item is completed. Tasks are stopped when the queue
+		is empty. The number of items per second is logged at the end.
+
+		If the Master has sub-controllers, the Controller sends its requests
+		to the sub-controllers instead of to the tasks, and receives a summary
+		of task states from each sub-controller instead of each task's state.
+		In work-queue mode, it sends batches of work items to the sub-controllers.
+
+		If the task ranks are TaskHosts (option `--mtbmpi-task-threads=N`),
+		the Controller treats each host as a sub-controller of its N logical
+		tasks, and its Tracker has an entry for each logical task.
+
+		If the Master has a task Communicator (option `--mtbmpi-collective-phases`),
+		the initialize, start and stop requests are sent to all tasks as a
+		non-blocking broadcast of a CollectivePhase code, and a final
+		Phase_Finish is broadcast when all tasks are stopped.
+
+		SendData sends a block of bytes of any size to a task, which passes it
+		to its TaskAdapter's AcceptData. The send is non-blocking; the data
+		must not be changed until IsDataSent is true or WaitDataSent returns.
+		A task receives data only until it is completed or stopped.
+		The data header is sent on comm, in order with the requests,
+		and the data on dataComm (see TrafficComms.h).
+
+		Task state reports are received by a ring of pre-posted persistent
+		receives (PersistentReceive) instead of by Probe and Recv.
 @internal
 project		Master-Task-Blackboard MPI Framework
 @author		Thomas E. Hilinski <https://github.com/tehilinski>
@@ -23,7 +53,12 @@ project		Master-Task-Blackboard MPI Framework
 #include "Task.h"
 #include "MsgTags.h"
 #include "TimerMPI.h"
+#include "WorkQueue.h"
+#include "PersistentMsg.h"
+#include <array>
 #include <memory>
+#include <deque>
+#include <vector>
 
 namespace mtbmpi {
 
@@ -45,7 +80,7 @@ class Controller : public SendsMsgsToLog
       Master & useParent,		///< parent of task
       IDNum const myId,			///< controller (master) rank
       IDNum const blackBoardID,		///< blackboard rank
-      int const numTasks,		///< number of work processes
+      int const numTasks,		///< number of work tasks; logical tasks if hosted
       IDNum const firstTaskID,		///< rank of 1st work process
       ConfigurationPtr configPtr	///< configuration object (shares my rank)
       );	// here for doxygen bug
@@ -59,6 +94,32 @@ class Controller : public SendsMsgsToLog
 
     Configuration const & GetConfiguration () const { return *pConfig; }
 
+    /// Work items for work-queue mode; add items before calling Activate.
+    WorkQueue & GetWorkQueue () { return workQueue; }
+
+    /// True if the Controller hands out work items to tasks.
+    bool IsWorkQueueMode () const { return workQueue.IsActive(); }
+
+    /// True if the tasks are managed by sub-controllers.
+    bool HaveSubControllers () const;
+
+    /// True if the task ranks are TaskHosts of several logical tasks.
+    bool HaveTaskHosts () const;
+
+    /// Send data to a task; sent in chunks if larger than INT_MAX bytes.
+    /// The data must not be changed until IsDataSent() or WaitDataSent().
+    void SendData (
+      IDNum const taskID,		///< task rank; a task host gives it to all of its tasks
+      int const dataID,			///< ID given to the task with the data
+      void const * const data,		///< data to send
+      std::size_t const size);		///< number of bytes
+
+    /// True if all data from SendData has been sent.
+    bool IsDataSent ();
+
+    /// Wait until all data from SendData has been sent.
+    void WaitDataSent ();
+
   private:
 
     /// @cond SKIP_PRIVATE
@@ -70,25 +131,59 @@ class Controller : public SendsMsgsToLog
     ConfigurationPtr pConfig;		// configuration
     State stateBB;			// blackboard state
     TimerMPI timer;			// timer for job using MPI timer
+    WorkQueue workQueue;		// work items for work-queue mode
+    std::deque<int> phaseCodes;		// buffers of broadcast phases in flight
+    std::vector<MPI_Request> phaseRequests;	// broadcasts in flight
+    bool phasesFinished;		// Phase_Finish was broadcast
+    std::deque< std::array<long long, 2> > dataHeaders;	// Tag_Data headers in flight
+    std::vector<MPI::Request> dataRequests;	// data sends in flight
+    PersistentReceive stateReceive;	// pre-posted Tag_State receives
 
     void LogCmdLineArgs ();		// write cmd-line args to log file
 
-    void SetTaskState (
-      MPI::Status & status);		// status from Probe
+    // ranks which manage a group of tasks: sub-controllers or task hosts
+    int GetNumberOfTaskGroups () const;	// zero if none
+    IDNum GetTaskGroupID ( int const index ) const;
+    int GetTaskGroupNumberOfTasks ( int const index ) const;
+
+    bool WaitForMessage (		// false if a state report was handled
+      MPI_Message & message,		// the matched message
+      MPI::Status & status);
+    void DiscardBlackboardMessages ();	// Blackboard thread: results and logs sent on comm
+
+    State SetTaskState (		// returns the new state
+      int const * const buffer,		// Tag_State: 0 = id, 1 = state
+      Tracker::size_type & taskNum);	// returns task index
 
     void SetBlackboardState (
       State const newState );
 
     void InitializeAllTasks ();
     void StartAllTasks ();
+    void SendToAllTasks (		// zero-length msg to tasks or task groups
+      MsgTags const tag,
+      std::string const & myName);
+    void BroadcastPhase (		// non-blocking broadcast to all tasks
+      CollectivePhase const phase);
+    void FinishPhases ();		// broadcast Phase_Finish and wait
+    void StartWorkQueue ();		// give each task its first work item
+    void SendNextWorkItem (		// next item, or stop if queue is empty
+      Tracker::size_type const taskNum);
+    void SendWorkItems (		// batch of items to a task group
+      IDNum const groupID,
+      int const maxItems);
+    void LogWorkQueueSummary ();
+    bool AreAllTasksStopped () const;	// true if all tasks are stopped
     bool StopAllTasks ();
     void StopBlackboard ();		// call this only after all tasks are stopped
     void WaitUntilCanStop ();		// true if Master can stop
 
-    void DoActionState ( MPI::Status status );
-    void DoActionRequestStop ( MPI::Status status );
-    void DoActionRequestCmdLineArgs ( MPI::Status status );
-    void DoActionRequestConfig ( MPI::Status status );
+    void DoActionState ( int const source, int const * const buffer );
+    void DoActionStateSummary ( MPI_Message & message, MPI::Status status );
+    void DoActionRequestWorkItems ( MPI_Message & message, MPI::Status status );
+    void DoActionRequestStop ( MPI_Message & message, MPI::Status status );
+    void DoActionRequestCmdLineArgs ( MPI_Message & message, MPI::Status status );
+    void DoActionRequestConfig ( MPI_Message & message, MPI::Status status );
 
     // functions that should not be used; are not defined
     Controller (Controller const & object);
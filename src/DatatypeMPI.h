@@ -0,0 +1,170 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		DatatypeMPI.h
+@class		mtbmpi::StructDatatype
+@brief 		Maps fixed-layout structs to MPI derived datatypes.
+@details
+		TypeMPI<T>::Get() gives the predefined MPI datatype of a C++ arithmetic type.
+
+		StructDatatype<T> builds and commits an MPI struct datatype from the
+		members of T, so an array of T is sent as raw bytes with one MPI call:
+@code
+		struct Result { int id; double values[3]; };
+
+		mtbmpi::StructDatatype<Result> resultType;
+		resultType.Add( &Result::id ).Add( &Result::values ).Commit();
+		mtbmpi::resultComm.Send( results.data(), results.size(), resultType.Get(),
+				   GetParent().GetBlackboardID(), mtbmpi::Tag_TaskResults );
+@endcode
+		The receiver uses a StructDatatype built the same way,
+		with `status.Get_count( resultType.Get() )` records.
+		The datatype's extent is sizeof(T), so padding is handled.
+		The datatype is freed by the destructor, if MPI is not finalized.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_DatatypeMPI_h
+#define INC_mtbmpi_DatatypeMPI_h
+
+#include "mpi.h"
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace mtbmpi {
+
+
+/// Predefined MPI datatype for a C++ arithmetic type
+template < class T > struct TypeMPI;
+
+/// @cond SKIP_PRIVATE
+template <> struct TypeMPI<char>		{ static MPI::Datatype Get () { return MPI::CHAR; } };
+template <> struct TypeMPI<signed char>		{ static MPI::Datatype Get () { return MPI::SIGNED_CHAR; } };
+template <> struct TypeMPI<unsigned char>	{ static MPI::Datatype Get () { return MPI::UNSIGNED_CHAR; } };
+template <> struct TypeMPI<short>		{ static MPI::Datatype Get () { return MPI::SHORT; } };
+template <> struct TypeMPI<unsigned short>	{ static MPI::Datatype Get () { return MPI::UNSIGNED_SHORT; } };
+template <> struct TypeMPI<int>			{ static MPI::Datatype Get () { return MPI::INT; } };
+template <> struct TypeMPI<unsigned int>	{ static MPI::Datatype Get () { return MPI::UNSIGNED; } };
+template <> struct TypeMPI<long>		{ static MPI::Datatype Get () { return MPI::LONG; } };
+template <> struct TypeMPI<unsigned long>	{ static MPI::Datatype Get () { return MPI::UNSIGNED_LONG; } };
+template <> struct TypeMPI<long long>		{ static MPI::Datatype Get () { return MPI::LONG_LONG; } };
+template <> struct TypeMPI<unsigned long long>	{ static MPI::Datatype Get () { return MPI::UNSIGNED_LONG_LONG; } };
+template <> struct TypeMPI<float>		{ static MPI::Datatype Get () { return MPI::FLOAT; } };
+template <> struct TypeMPI<double>		{ static MPI::Datatype Get () { return MPI::DOUBLE; } };
+template <> struct TypeMPI<long double>		{ static MPI::Datatype Get () { return MPI::LONG_DOUBLE; } };
+template <> struct TypeMPI<bool>		{ static MPI::Datatype Get () { return MPI::BOOL; } };
+/// @endcond
+
+
+template < class T >
+class StructDatatype
+{
+  public:
+
+    static_assert( std::is_trivially_copyable<T>::value,
+		   "StructDatatype: type must be trivially copyable" );
+
+    StructDatatype ()
+      : datatype ( MPI::DATATYPE_NULL ),
+	isCommitted ( false )
+      {
+      }
+
+    /// Add a scalar member
+    template < class M >
+    StructDatatype & Add (
+      M T::* const member )			///< pointer to member
+      {
+	return AddBlock( Offset( member ), 1, TypeMPI<M>::Get() );
+      }
+
+    /// Add a fixed-size array member
+    template < class M, std::size_t N >
+    StructDatatype & Add (
+      M (T::* const member)[N] )		///< pointer to array member
+      {
+	return AddBlock( Offset( member ), static_cast<int>(N), TypeMPI<M>::Get() );
+      }
+
+    /// Create and commit the MPI datatype; call after all members are added
+    void Commit ()
+      {
+	if ( isCommitted )
+	    return;
+	if ( blockLengths.empty() )
+	    throw std::runtime_error( "StructDatatype: no members were added." );
+	MPI::Datatype const structType = MPI::Datatype::Create_struct (
+		static_cast<int>( blockLengths.size() ), blockLengths.data(),
+		displacements.data(), types.data() );
+	// extent includes trailing padding, so arrays of T are contiguous
+	datatype = structType.Create_resized( 0, sizeof(T) );
+	MPI::Datatype structTypeCopy = structType;
+	structTypeCopy.Free();
+	datatype.Commit();
+	isCommitted = true;
+      }
+
+    /// The committed MPI datatype
+    MPI::Datatype const & Get () const
+      {
+	if ( !isCommitted )
+	    throw std::runtime_error( "StructDatatype: datatype is not committed." );
+	return datatype;
+      }
+
+    bool IsCommitted () const { return isCommitted; }	///< true after Commit()
+
+    ~StructDatatype ()
+      {
+	if ( isCommitted && !MPI::Is_finalized() )
+	    datatype.Free();
+      }
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    std::vector<int> blockLengths;
+    std::vector<MPI::Aint> displacements;
+    std::vector<MPI::Datatype> types;
+    MPI::Datatype datatype;
+    bool isCommitted;
+
+    template < class M >
+    static MPI::Aint Offset ( M T::* const member )
+      {
+	T const object = T();
+	return reinterpret_cast<char const *>( &(object.*member) )
+	       - reinterpret_cast<char const *>( &object );
+      }
+
+    StructDatatype & AddBlock (
+      MPI::Aint const displacement,
+      int const length,
+      MPI::Datatype const & type )
+      {
+	if ( isCommitted )
+	    throw std::runtime_error( "StructDatatype: cannot add members after Commit." );
+	displacements.push_back( displacement );
+	blockLengths.push_back( length );
+	types.push_back( type );
+	return *this;
+      }
+
+    // functions that should not be used; are not defined
+    StructDatatype (StructDatatype const & object);
+    StructDatatype & operator= (StructDatatype const & object);
+
+    /// @endcond
+};
+
+
+} // namespace mtbmpi
+
+#endif // INC_mtbmpi_DatatypeMPI_h
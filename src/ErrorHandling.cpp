@@ -13,10 +13,19 @@ copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
 ------------------------------------------------------------------------------------------------------------*/
 
 #include "ErrorHandling.h"
+#include <stdexcept>
 
 namespace mtbmpi {
 
 
+namespace {
+
+    // true in the task threads of a TaskHost
+    thread_local bool isHostedTaskThread = false;
+
+} // namespace
+
+
 // Check for unhandled error in MPI. Throw exception if found.
 // If OpenMPI is compiled with C++ exception handling turned off, then hopefully
 // this will find an error.
@@ -38,6 +47,23 @@ void CheckErrorMPI ( std::string const origin )
     #endif
 }
 
+void SetHostedTaskThread ()
+{
+    isHostedTaskThread = true;
+}
+
+// Only the host's thread may call MPI (MPI_THREAD_FUNNELED), and the Blackboard
+// knows one result stream per rank, so a hosted task sends through its host.
+void CheckNotHostedTaskThread ( std::string const origin )
+{
+    if ( !isHostedTaskThread )
+	return;
+    std::string msg = origin;
+    msg += ": a task run by a TaskHost (option task-threads) cannot make MPI calls;"
+	   " use Task::SendResultRecord and Task::SendMsgToLog.";
+    throw std::runtime_error( msg );
+}
+
 std::string SetErrorHandler (
     MPI::Intracomm & comm,
     MPI::Errhandler const & errorHandler )
@@ -33,6 +33,14 @@ namespace mtbmpi {
 ///	@param origin	Location of the error
 void CheckErrorMPI ( std::string const origin = std::string() );
 
+/// Mark this thread as a task thread of a TaskHost, which must not make MPI calls.
+void SetHostedTaskThread ();
+
+///	Throw an exception if this thread is a task thread of a TaskHost.
+///	Call before an MPI call which a task can make directly.
+///	@param origin	Location of the MPI call
+void CheckNotHostedTaskThread ( std::string const origin );
+
 /// Get name of the MPI error handler.
 inline std::string GetErrorHandlerName (MPI::Errhandler const & errHandler )
 {
@@ -0,0 +1,324 @@
+/*------------------------------------------------------------------------------------------------------------
+file		LocalLog.cpp
+class		mtbmpi::LocalLog
+brief 		Per-rank log file on node-local storage, merged into the log file at the end.
+details
+		A record in a local file and in a merge chunk is:
+		  16 hex digits of the key, 8 hex digits of the text size,
+		  the text, and a newline.
+		The fixed-width hex key sorts as the number, and the size lets
+		a message contain newlines. A chunk has only whole records;
+		an empty chunk ends a child's stream.
+
+		The merge has no cycles: a rank waits only for its children,
+		which wait only for theirs, so the blocking sends cannot deadlock.
+
+project		Master-Task-Blackboard MPI Framework
+author		Thomas E. Hilinski <https://github.com/tehilinski>
+copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#include "LocalLog.h"
+#include "RunLogMgr.h"
+#include "MsgTags.h"
+#include "MatchedProbe.h"
+#include "timeutil.h"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+
+namespace mtbmpi {
+
+
+namespace {
+
+    std::size_t const keyDigits = 16;
+    std::size_t const sizeDigits = 8;
+    std::size_t const recordHeaderSize = keyDigits + sizeDigits;
+    char const hexDigits[] = "0123456789abcdef";
+
+    inline void PutHex ( char * dest, unsigned long long value, std::size_t const digits )
+    {
+	for ( std::size_t i = digits; i > 0; --i )
+	{
+	    dest[i - 1] = hexDigits[ value & 0xF ];
+	    value >>= 4;
+	}
+    }
+
+    inline std::size_t GetHex ( char const * src, std::size_t const digits )
+    {
+	std::size_t value = 0;
+	for ( std::size_t i = 0; i < digits; ++i )
+	{
+	    char const c = src[i];
+	    value = ( value << 4 ) |
+		    static_cast<std::size_t>( c <= '9' ? c - '0' : c - 'a' + 10 );
+	}
+	return value;
+    }
+
+    // a sorted stream of records
+    class MergeInput
+    {
+      public:
+	virtual ~MergeInput () {}
+	// gets the next record, with its header and newline; false at the end
+	virtual bool Next ( std::string & record ) = 0;
+    };
+
+    // this rank's local file
+    class FileInput : public MergeInput
+    {
+      public:
+	explicit FileInput ( std::string const & fileName )
+	  : ifs ( fileName.c_str(), std::ios::in | std::ios::binary )
+	{
+	}
+
+	bool Next ( std::string & record )
+	{
+	    char header[recordHeaderSize];
+	    if ( !ifs.read( header, recordHeaderSize ) )
+		return false;
+	    std::size_t const size = GetHex( header + keyDigits, sizeDigits );
+	    record.assign( header, recordHeaderSize );
+	    record.resize( recordHeaderSize + size + 1 );
+	    return static_cast<bool>( ifs.read( &record[recordHeaderSize], size + 1 ) );
+	}
+
+      private:
+	std::ifstream ifs;
+    };
+
+    // a child's merged stream, received in chunks as needed
+    class StreamInput : public MergeInput
+    {
+      public:
+	StreamInput ( MPI::Intracomm & useComm, int const useSource )
+	  : comm ( useComm ),
+	    source ( useSource ),
+	    position ( 0 ),
+	    done ( false )
+	{
+	}
+
+	bool Next ( std::string & record )
+	{
+	    if ( position >= chunk.size() )
+	    {
+		if ( done )
+		    return false;
+		MPI_Message message;
+		MPI::Status status;
+		Mprobe( comm, source, Tag_LogMerge, message, status );
+		int const count = status.Get_count( MPI::CHAR );
+		chunk.resize( count );
+		Mrecv( ( count > 0 ? &chunk[0] : nullptr ), count, MPI::CHAR, message );
+		position = 0;
+		if ( count == 0 )
+		{
+		    done = true;
+		    return false;
+		}
+	    }
+	    std::size_t const size = GetHex( chunk.data() + position + keyDigits, sizeDigits );
+	    std::size_t const recordSize = recordHeaderSize + size + 1;
+	    record.assign( chunk, position, recordSize );
+	    position += recordSize;
+	    return true;
+	}
+
+      private:
+	MPI::Intracomm & comm;
+	int const source;
+	std::string chunk;
+	std::size_t position;
+	bool done;
+    };
+
+} // namespace
+
+
+std::size_t const LocalLog::defaultBufferSize;
+int const LocalLog::fanIn;
+std::size_t const LocalLog::mergeChunkSize;
+LocalLog * LocalLog::pActive = nullptr;
+
+
+LocalLog::LocalLog (
+    MPI::Intracomm & useComm,
+    int const rootRank,
+    std::string const & directory)
+    : root ( rootRank ),
+      merged ( false )
+{
+    mergeComm = useComm.Dup();
+    // rank 0's time makes the file names of this run unique
+    long long runID = ( mergeComm.Get_rank() == 0 ? TimeStampNanoseconds() : 0 );
+    mergeComm.Bcast( &runID, 1, MPI::LONG_LONG, 0 );
+    char name[64];
+    std::snprintf( name, sizeof(name), "mtbmpi_log.%llx.%d",
+		   static_cast<unsigned long long>( runID ), mergeComm.Get_rank() );
+    fileName = ( directory.empty() ? DefaultDirectory() : directory );
+    fileName += '/';
+    fileName += name;
+
+    ofs.rdbuf()->pubsetbuf( nullptr, 0 );	// before open; this class buffers
+    ofs.open ( fileName.c_str(), std::ios::out | std::ios::trunc | std::ios::binary );
+    if ( !ofs.is_open() )
+    {
+	std::string msg = "Error: could not open the file\n";
+	msg += fileName;
+	msg += "\nfor output.";
+	throw std::runtime_error (msg);
+    }
+    buffer.reserve( defaultBufferSize + 1024 );
+    pActive = this;
+}
+
+LocalLog::~LocalLog ()
+{
+    if ( pActive == this )
+	pActive = nullptr;
+    if ( ofs.is_open() )
+    {
+	Flush ();
+	ofs.close();
+    }
+    if ( MPI::Is_initialized() && !MPI::Is_finalized() )
+	mergeComm.Free();
+}
+
+void LocalLog::Append (
+    std::string const & line,
+    bool const isError)
+{
+    char header[recordHeaderSize];
+    PutHex( header, static_cast<unsigned long long>( TimeStampNanoseconds() ), keyDigits );
+    PutHex( header + keyDigits, line.size(), sizeDigits );
+    buffer.append( header, recordHeaderSize );
+    buffer += line;
+    buffer += '\n';
+    if ( isError || buffer.size() >= defaultBufferSize )
+	Flush ();
+}
+
+void LocalLog::Flush ()
+{
+    if ( buffer.empty() || !ofs.is_open() )
+	return;
+    ofs.write( buffer.data(), buffer.size() );
+    ofs.flush();
+    buffer.clear();
+}
+
+void LocalLog::Merge (
+    RunLogMgr * const pLog)
+{
+    if ( merged )
+	return;
+    merged = true;
+    if ( pActive == this )
+	pActive = nullptr;
+    Flush ();
+    ofs.close();
+
+    std::vector<int> children;
+    GetChildren ( children );
+    int const parent = GetParent();
+
+    // inputs: this rank's file, then the children's streams
+    std::vector< std::unique_ptr<MergeInput> > inputs;
+    inputs.emplace_back( new FileInput( fileName ) );
+    for ( std::vector<int>::const_iterator child = children.begin(); child != children.end(); ++child )
+	inputs.emplace_back( new StreamInput( mergeComm, *child ) );
+
+    // the next record of each input; the heap has the earliest on top,
+    // and the lower input first for equal keys
+    std::vector<std::string> current ( inputs.size() );
+    auto later = [&current] ( std::size_t const a, std::size_t const b ) -> bool
+    {
+	int const order = current[a].compare( 0, keyDigits, current[b], 0, keyDigits );
+	return order > 0 || ( order == 0 && a > b );
+    };
+    std::priority_queue< std::size_t, std::vector<std::size_t>, decltype(later) > heap ( later );
+    for ( std::size_t i = 0; i < inputs.size(); ++i )
+	if ( inputs[i]->Next( current[i] ) )
+	    heap.push( i );
+
+    std::string chunk;
+    if ( parent >= 0 )
+	chunk.reserve( mergeChunkSize + 1024 );
+    while ( !heap.empty() )
+    {
+	std::size_t const i = heap.top();
+	heap.pop();
+	std::string const & record = current[i];
+	if ( parent < 0 )
+	{
+	    if ( pLog != nullptr )
+		pLog->Write( record.substr( recordHeaderSize, record.size() - recordHeaderSize - 1 ) );
+	}
+	else
+	{
+	    chunk += record;
+	    if ( chunk.size() >= mergeChunkSize )
+	    {
+		mergeComm.Send( chunk.data(), static_cast<int>( chunk.size() ), MPI::CHAR, parent, Tag_LogMerge );
+		chunk.clear();
+	    }
+	}
+	if ( inputs[i]->Next( current[i] ) )
+	    heap.push( i );
+    }
+    if ( parent >= 0 )
+    {
+	if ( !chunk.empty() )
+	    mergeComm.Send( chunk.data(), static_cast<int>( chunk.size() ), MPI::CHAR, parent, Tag_LogMerge );
+	mergeComm.Send( nullptr, 0, MPI::CHAR, parent, Tag_LogMerge );	// end
+    }
+    std::remove( fileName.c_str() );
+}
+
+std::string LocalLog::DefaultDirectory ()
+{
+    char const * const tmpDir = std::getenv( "TMPDIR" );
+    return ( tmpDir != nullptr && *tmpDir != '\0' ? std::string( tmpDir ) : std::string( "/tmp" ) );
+}
+
+/// @cond SKIP_PRIVATE
+
+// the tree is numbered from the root
+int LocalLog::GetParent () const
+{
+    int const size = mergeComm.Get_size();
+    int const position = ( mergeComm.Get_rank() - root + size ) % size;
+    if ( position == 0 )
+	return -1;
+    return ( ( position - 1 ) / fanIn + root ) % size;
+}
+
+void LocalLog::GetChildren (
+    std::vector<int> & children) const
+{
+    int const size = mergeComm.Get_size();
+    int const position = ( mergeComm.Get_rank() - root + size ) % size;
+    for ( int i = 1; i <= fanIn; ++i )
+    {
+	long const child = static_cast<long>( position ) * fanIn + i;
+	if ( child >= size )
+	    break;
+	children.push_back( static_cast<int>( ( child + root ) % size ) );
+    }
+}
+
+/// @endcond
+
+
+} // namespace mtbmpi
@@ -0,0 +1,123 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		LocalLog.h
+@class		mtbmpi::LocalLog
+@brief 		Per-rank log file on node-local storage, merged into the log file at the end.
+@details
+		Used when the option `--mtbmpi-log-local[=DIRECTORY]` is given.
+
+		Each rank writes its log lines to its own file in DIRECTORY
+		(default: the environment variable TMPDIR, or /tmp),
+		so a log message is a buffered append, with no MPI messages.
+		LoggerMPI appends the messages of tasks and controllers,
+		and the Blackboard appends its own lines.
+		Each line is stored with a key, the time of the message
+		in nanoseconds (TimeStampNanoseconds).
+
+		Merge, called by the Master's destructor before MPI is finalized,
+		merges all ranks' files by the key, in parallel:
+		the ranks form a tree with fanIn children per rank, rooted
+		at the Blackboard; each rank merges its own file with the merged
+		streams of its children, and sends its merged stream to its parent
+		in chunks. The root writes the lines, without their keys, to the
+		Blackboard's RunLogMgr, so the final log file is the one
+		Blackboard::CreateLogFileName makes, with its flush and rotation options.
+		The local files are then removed.
+
+		Lines of one rank keep their order. Lines of different ranks are
+		ordered by their times; ranks on different nodes are ordered only
+		as well as the nodes' clocks agree.
+		The log is text; the binary format is not used with it.
+		If a rank stops without the merge, its file remains in DIRECTORY.
+
+		Construction and Merge are collective over the communicator.
+		The class is not thread-safe, as LoggerMPI is not.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_LocalLog_h
+#define INC_mtbmpi_LocalLog_h
+
+#include "mpi.h"
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace mtbmpi {
+
+
+class RunLogMgr;
+
+class LocalLog
+{
+  public:
+
+    static std::size_t const defaultBufferSize = 64 * 1024;	///< bytes
+    static int const fanIn = 8;					///< children per rank in the merge
+    static std::size_t const mergeChunkSize = 256 * 1024;	///< bytes sent to the parent at once
+
+    /// Constructor; collective over useComm. Creates this rank's file.
+    LocalLog (
+      MPI::Intracomm & useComm,		///< communicator of all ranks
+      int const rootRank,		///< rank which writes the merged log
+      std::string const & directory );	///< for the local file; empty = default
+
+    /// Destructor; writes the buffer to the local file
+    ~LocalLog ();
+
+    /// The local log of this process, or null if not used
+    static LocalLog * GetActive () { return pActive; }
+
+    /// Append a line; the file is written when the buffer is full,
+    /// or after an error.
+    void Append (
+      std::string const & line,		///< formatted message, without the newline
+      bool const isError );		///< write the buffer now
+
+    /// Write the buffer to the local file
+    void Flush ();
+
+    /// Merge the local files of all ranks into the log; collective.
+    /// No lines are appended after this.
+    void Merge (
+      RunLogMgr * const pLog );		///< at the root: receives the merged lines
+
+    /// Get the name of this rank's local file
+    std::string const & GetFileName () const { return fileName; }
+
+    /// Directory for the local files if none is given
+    static std::string DefaultDirectory ();
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    static LocalLog * pActive;
+
+    MPI::Intracomm mergeComm;		// Dup of the communicator
+    int const root;
+    std::string fileName;
+    std::ofstream ofs;			// unbuffered; this class buffers
+    std::string buffer;			// lines with their keys
+    bool merged;
+
+    int GetParent () const;		// -1 at the root
+    void GetChildren ( std::vector<int> & children ) const;
+
+    // functions that should not be used; are not defined
+    LocalLog (LocalLog const & object);
+    LocalLog & operator= (LocalLog const & object);
+
+    /// @endcond
+};
+
+
+} // namespace mtbmpi
+
+#endif // INC_mtbmpi_LocalLog_h
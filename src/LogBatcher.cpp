@@ -0,0 +1,117 @@
+/*------------------------------------------------------------------------------------------------------------
+file		LogBatcher.cpp
+class		mtbmpi::LogBatcher
+brief 		Per-rank buffer which sends log messages to the Blackboard in batches.
+details
+		A Tag_LogBatch message is a series of BinaryWriter records:
+		  int source rank, int tag, uint32 size, bytes.
+		Before a buffer is sent, the previous send is completed,
+		so the other buffer is free to fill.
+
+project		Master-Task-Blackboard MPI Framework
+author		Thomas E. Hilinski <https://github.com/tehilinski>
+copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#include "LogBatcher.h"
+#include "ErrorHandling.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace mtbmpi {
+
+
+std::size_t const LogBatcher::defaultBatchSize;
+int const LogBatcher::defaultMaxAge;
+LogBatcher * LogBatcher::pActive = nullptr;
+
+
+LogBatcher::LogBatcher (
+    MPI::Intracomm & useComm,
+    int const blackboardID,
+    std::size_t const useBatchSize,
+    int const maxAgeMilliseconds)
+    : comm ( useComm ),
+      idBlackboard ( blackboardID ),
+      myRank ( useComm.Get_rank() ),
+      batchSize ( std::max<std::size_t>( useBatchSize, 256 ) ),
+      maxAge ( std::chrono::milliseconds( std::max( 0, maxAgeMilliseconds ) ) ),
+      filling ( 0 ),
+      haveInFlight ( false ),
+      numMessages ( 0 ),
+      numBatches ( 0 )
+{
+    buffers[0] = BinaryWriter( batchSize + 1024 );
+    buffers[1] = BinaryWriter( batchSize + 1024 );
+    pActive = this;
+}
+
+LogBatcher::~LogBatcher ()
+{
+    if ( pActive == this )
+	pActive = nullptr;
+    if ( MPI::Is_initialized() && !MPI::Is_finalized() )
+	Flush ();
+}
+
+void LogBatcher::Append (
+    MsgTags const tag,
+    std::string const & msg,
+    bool const isError)
+{
+    BinaryWriter & batch = buffers[filling];
+    if ( batch.Size() == 0 )
+	firstAppend = Clock::now();
+    batch << myRank << static_cast<int>( tag ) << static_cast<std::uint32_t>( msg.size() );
+    batch.WriteBytes( msg.data(), msg.size() );
+    ++numMessages;
+    if ( isError || batch.Size() >= batchSize )
+	Send ();
+    else
+	FlushIfDue ();
+}
+
+void LogBatcher::FlushIfDue ()
+{
+    if ( buffers[filling].Size() > 0 && Clock::now() - firstAppend >= maxAge )
+	Send ();
+}
+
+void LogBatcher::Flush ()
+{
+    Send ();
+    WaitInFlight ();
+}
+
+/// @cond SKIP_PRIVATE
+
+void LogBatcher::Send ()
+{
+    BinaryWriter & batch = buffers[filling];
+    if ( batch.Size() == 0 )
+	return;
+    WaitInFlight ();
+    inFlight = comm.Isend ( batch.Data(), batch.Size(), MPI::BYTE, idBlackboard, Tag_LogBatch );
+    CheckErrorMPI( "mtbmpi::LogBatcher::Send" );
+    haveInFlight = true;
+    ++numBatches;
+    filling = 1 - filling;
+    buffers[filling].Clear();		// its send is complete
+}
+
+void LogBatcher::WaitInFlight ()
+{
+    if ( haveInFlight )
+    {
+	inFlight.Wait();
+	haveInFlight = false;
+    }
+}
+
+/// @endcond
+
+
+} // namespace mtbmpi
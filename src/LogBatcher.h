@@ -0,0 +1,118 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		LogBatcher.h
+@class		mtbmpi::LogBatcher
+@brief 		Per-rank buffer which sends log messages to the Blackboard in batches.
+@details
+		Used when the option `--mtbmpi-log-batch[=BYTES]` is given.
+
+		LoggerMPI appends each formatted message to this rank's batch
+		instead of sending it with a blocking Send. The batch is sent
+		as one Tag_LogBatch message with a nonblocking Isend when it
+		reaches BYTES (default 16 KB), or when its oldest message is
+		older than `--mtbmpi-log-batch-age=MILLISECONDS` (default 250 ms).
+		There are two buffers, so the next batch fills while the previous
+		one is in flight; a send waits only if the previous batch
+		has not been received yet.
+
+		An error message sends the batch at once.
+		A task flushes its batch when it stops, and the Controller flushes
+		its batch before it stops the Blackboard.
+		The age is checked when a message is appended, and by FlushIfDue,
+		which a task calls while it waits for messages.
+
+		The batch has the same records as the SharedLog's batches,
+		so the Blackboard unpacks both the same way.
+		When the SharedLog is used, it takes the log messages instead.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_LogBatcher_h
+#define INC_mtbmpi_LogBatcher_h
+
+#include "mpi.h"
+#include "MsgTags.h"
+#include "BinaryBuffer.h"
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace mtbmpi {
+
+
+class LogBatcher
+{
+  public:
+
+    static std::size_t const defaultBatchSize = 16 * 1024;	///< bytes
+    static int const defaultMaxAge = 250;			///< milliseconds
+
+    /// Constructor; becomes this process's active batcher
+    LogBatcher (
+      MPI::Intracomm & useComm,		///< communicator with the Blackboard
+      int const blackboardID,		///< Blackboard rank
+      std::size_t const batchSize,	///< send the batch at this size
+      int const maxAgeMilliseconds );	///< send the batch at this age
+
+    /// Destructor; sends the remaining messages
+    ~LogBatcher ();
+
+    /// The batcher of this process, or null if not used
+    static LogBatcher * GetActive () { return pActive; }
+
+    /// Append a message to the batch; sends the batch if it is full or old,
+    /// or if the message is an error.
+    void Append (
+      MsgTags const tag,		///< Tag_LogMessage, Tag_ErrorMessage, or Tag_LogRecord
+      std::string const & msg,		///< formatted message or log record
+      bool const isError );		///< send the batch now
+
+    /// Send the batch if it is older than the maximum age
+    void FlushIfDue ();
+
+    /// Send the batch and wait until it is sent
+    void Flush ();
+
+    unsigned long long GetNumMessages () const { return numMessages; }	///< messages appended
+    unsigned long long GetNumBatches () const { return numBatches; }	///< batches sent
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    typedef std::chrono::steady_clock		Clock;
+
+    static LogBatcher * pActive;
+
+    MPI::Intracomm & comm;
+    int const idBlackboard;
+    int const myRank;
+    std::size_t const batchSize;
+    Clock::duration const maxAge;
+    BinaryWriter buffers[2];		// filling, and in flight
+    int filling;			// index of the buffer being filled
+    MPI::Request inFlight;		// send of the other buffer
+    bool haveInFlight;
+    Clock::time_point firstAppend;	// oldest message in the batch
+    unsigned long long numMessages;
+    unsigned long long numBatches;
+
+    void Send ();			// Isend the filling buffer and swap
+    void WaitInFlight ();
+
+    // functions that should not be used; are not defined
+    LogBatcher (LogBatcher const & object);
+    LogBatcher & operator= (LogBatcher const & object);
+
+    /// @endcond
+};
+
+
+} // namespace mtbmpi
+
+#endif // INC_mtbmpi_LogBatcher_h
@@ -0,0 +1,68 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		LogLevel.h
+@class		mtbmpi::LogLevel
+@brief 		Provides enum of log message severity levels.
+@details
+		A message is written to the log if its level is at least
+		the compile-time minimum level, MTBMPI_LOG_MIN_LEVEL,
+		and the runtime threshold set by the option `--mtbmpi-log-level=NAME`.
+		NAME is one of trace, debug, info, warning, error, or off;
+		the default threshold is info.
+
+		Define MTBMPI_LOG_MIN_LEVEL to the numeric value of a level,
+		for example `-DMTBMPI_LOG_MIN_LEVEL=2` to remove trace and debug
+		messages at compile time; the default, 0, keeps all messages.
+		It applies to the MTBMPI_LOG_* macros in LoggerMPI.h, and to
+		the library's own messages when the library is built with it.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_LogLevel_h
+#define INC_mtbmpi_LogLevel_h
+
+#include <string>
+
+#ifndef MTBMPI_LOG_MIN_LEVEL
+  #define MTBMPI_LOG_MIN_LEVEL 0
+#endif
+
+namespace mtbmpi {
+
+    /// Severity levels of log messages; values match MTBMPI_LOG_MIN_LEVEL.
+    enum LogLevel
+    {
+	LogLevel_Trace = 0,		///< detailed progress
+	LogLevel_Debug = 1,		///< task state transitions, diagnostics
+	LogLevel_Info = 2,		///< informational messages
+	LogLevel_Warning = 3,		///< warnings
+	LogLevel_Error = 4,		///< errors
+	LogLevel_Off = 5		///< threshold only: no messages
+    };
+
+    /// Get the level from its name; returns defaultLevel if not a name
+    inline LogLevel ToLogLevel (
+	std::string const & name,
+	LogLevel const defaultLevel = LogLevel_Info )
+    {
+	char const * const names[] = { "trace", "debug", "info", "warning", "error", "off" };
+	for ( int i = LogLevel_Trace; i <= LogLevel_Off; ++i )
+	{
+	    if ( name == names[i] )
+		return static_cast<LogLevel>( i );
+	}
+	if ( name == "warn" )
+	    return LogLevel_Warning;
+	return defaultLevel;
+    }
+
+
+} // namespace mtbmpi
+
+
+#endif // INC_mtbmpi_LogLevel_h
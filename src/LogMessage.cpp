@@ -2,7 +2,8 @@
 file		LogMessage.cpp
 class		mtbmpi::LogMessage
 brief 		Class to format log messages consistently.
-details		Messages can be formatted as type **Message**, **Warning**, or **Error**.
+details		Messages can be formatted as type **Trace**, **Debug**, **Message**,
+		**Warning**, or **Error**.
 		This class does not write the messages to output, rather it helps create them.
 project		Master-Task-Blackboard MPI Framework
 author		Thomas E. Hilinski <https://github.com/tehilinski>
@@ -20,6 +21,8 @@ namespace mtbmpi {
 
 /// @cond SKIP_PRIVATE
 
+std::string const LogMessage::tracePrefix   = "Trace: ";
+std::string const LogMessage::debugPrefix   = "Debug: ";
 std::string const LogMessage::warningPrefix = "Warning: ";
 std::string const LogMessage::errorPrefix   = "ERROR: ";
 
@@ -61,6 +64,54 @@ static inline std::string MakePrefix ( std::string const & taskIDstr )
 
 //--------- Make messages ----------
 
+void LogMessage::Trace ( std::string & msg )
+{
+    std::string text = DateTimeStampPrefix();
+    text += tracePrefix;
+    text += msg;
+    msg = text;
+}
+
+void LogMessage::Trace ( std::string & msg, TaskID const & taskID )
+{
+    std::string text = MakePrefix( taskID );
+    text += tracePrefix;
+    text += msg;
+    msg = text;
+}
+
+void LogMessage::Trace ( std::string & msg, std::string const & taskIDstr )
+{
+    std::string text = MakePrefix( taskIDstr );
+    text += tracePrefix;
+    text += msg;
+    msg = text;
+}
+
+void LogMessage::Debug ( std::string & msg )
+{
+    std::string text = DateTimeStampPrefix();
+    text += debugPrefix;
+    text += msg;
+    msg = text;
+}
+
+void LogMessage::Debug ( std::string & msg, TaskID const & taskID )
+{
+    std::string text = MakePrefix( taskID );
+    text += debugPrefix;
+    text += msg;
+    msg = text;
+}
+
+void LogMessage::Debug ( std::string & msg, std::string const & taskIDstr )
+{
+    std::string text = MakePrefix( taskIDstr );
+    text += debugPrefix;
+    text += msg;
+    msg = text;
+}
+
 void LogMessage::Message ( std::string & msg )
 {
     std::string text = DateTimeStampPrefix();
@@ -87,6 +138,7 @@ void LogMessage::Warning ( std::string & msg )
     std::string text = DateTimeStampPrefix();
     text += warningPrefix;
     text += msg;
+    msg = text;
 }
 
 void LogMessage::Warning ( std::string & msg, TaskID const & taskID )
@@ -2,7 +2,8 @@
 @file		LogMessage.h
 @class		mtbmpi::LogMessage
 @brief 		Class to format log messages consistently.
-@details	Messages can be formatted as type **Message**, **Warning**, or **Error**.
+@details	Messages can be formatted as type **Trace**, **Debug**, **Message**,
+		**Warning**, or **Error**.
 		This class does not write the messages to output, rather it helps create them.
 @internal
 project		Master-Task-Blackboard MPI Framework
@@ -26,6 +27,18 @@ namespace mtbmpi {
     {
 	public:
 
+	    /// Create a trace log message.
+	    /// The input value for **msg** is replaced.
+	    void Trace ( std::string & msg );
+	    void Trace ( std::string & msg, TaskID const & taskID );
+	    void Trace ( std::string & msg, std::string const & taskIDstr );
+
+	    /// Create a debug log message.
+	    /// The input value for **msg** is replaced.
+	    void Debug ( std::string & msg );
+	    void Debug ( std::string & msg, TaskID const & taskID );
+	    void Debug ( std::string & msg, std::string const & taskIDstr );
+
 	    /// Create an informational log message.
 	    /// The input value for **msg** is replaced.
 	    void Message ( std::string & msg );
@@ -48,6 +61,8 @@ namespace mtbmpi {
 
 	    /// @cond SKIP_PRIVATE
 
+	    static std::string const tracePrefix;
+	    static std::string const debugPrefix;
 	    static std::string const warningPrefix;
 	    static std::string const errorPrefix;
 
@@ -0,0 +1,225 @@
+/*------------------------------------------------------------------------------------------------------------
+file		LogRecord.cpp
+brief 		Binary log record format.
+details
+		Values are written in the writer's byte order, as with BinaryWriter.
+		The text format matches LogMessage, and Blackboard::LogError's
+		prefix of error lines.
+
+project		Master-Task-Blackboard MPI Framework
+author		Thomas E. Hilinski <https://github.com/tehilinski>
+copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#include "LogRecord.h"
+#include "LogLevel.h"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace mtbmpi {
+
+
+namespace {
+
+    char const fileMagic[8] = { 'M', 'T', 'B', 'M', 'P', 'I', 'L', 'G' };
+    std::uint32_t const fileVersion = 1;
+    std::size_t const maxDigitRun = 255;
+
+    template < class T >
+    inline char * Put ( char * dest, T const value )
+    {
+	std::memcpy( dest, &value, sizeof(T) );
+	return dest + sizeof(T);
+    }
+
+    template < class T >
+    inline char const * Get ( char const * src, T & value )
+    {
+	std::memcpy( &value, src, sizeof(T) );
+	return src + sizeof(T);
+    }
+
+    inline bool IsDigit ( char const c )
+    {
+	return c >= '0' && c <= '9';
+    }
+
+    char const * LevelPrefix ( int const level )
+    {
+	switch ( level )
+	{
+	  case LogLevel_Trace:		return "Trace: ";
+	  case LogLevel_Debug:		return "Debug: ";
+	  case LogLevel_Warning:	return "Warning: ";
+	  case LogLevel_Error:		return "ERROR: ";
+	  default:			return "";
+	}
+    }
+
+} // namespace
+
+
+void EncodeLogFileHeader (
+    char * const dest)
+{
+    char * p = dest;
+    std::memcpy( p, fileMagic, sizeof(fileMagic) );
+    p += sizeof(fileMagic);
+    p = Put( p, fileVersion );
+    Put( p, static_cast<std::uint32_t>( logRecordHeaderSize ) );
+}
+
+bool IsLogFileHeader (
+    char const * const data,
+    std::size_t const size)
+{
+    if ( size < logFileHeaderSize || std::memcmp( data, fileMagic, sizeof(fileMagic) ) != 0 )
+	return false;
+    std::uint32_t version = 0;
+    std::uint32_t headerSize = 0;
+    Get( Get( data + sizeof(fileMagic), version ), headerSize );
+    return version == fileVersion && headerSize == logRecordHeaderSize;
+}
+
+void EncodeLogRecordHeader (
+    LogRecordHeader const & header,
+    char * const dest)
+{
+    char * p = dest;
+    p = Put( p, header.time );
+    p = Put( p, header.rank );
+    p = Put( p, header.trackerID );
+    p = Put( p, header.templateID );
+    p = Put( p, header.size );
+    p = Put( p, header.level );
+    Put( p, header.kind );
+}
+
+void DecodeLogRecordHeader (
+    char const * const src,
+    LogRecordHeader & header)
+{
+    char const * p = src;
+    p = Get( p, header.time );
+    p = Get( p, header.rank );
+    p = Get( p, header.trackerID );
+    p = Get( p, header.templateID );
+    p = Get( p, header.size );
+    p = Get( p, header.level );
+    Get( p, header.kind );
+}
+
+void AppendLogRecord (
+    std::string & record,
+    LogRecordHeader header,
+    char const * const payload,
+    std::size_t const size)
+{
+    header.size = static_cast<std::uint32_t>( size );
+    char encoded[logRecordHeaderSize];
+    EncodeLogRecordHeader( header, encoded );
+    record.append( encoded, logRecordHeaderSize );
+    record.append( payload, size );
+}
+
+bool SplitLogTemplate (
+    std::string const & msg,
+    std::string & templateText,
+    std::string & args)
+{
+    templateText.clear();
+    args.clear();
+    std::string::size_type i = 0;
+    while ( i < msg.size() )
+    {
+	char const c = msg[i];
+	if ( c == templateArgMarker )
+	    return false;
+	if ( !IsDigit( c ) )
+	{
+	    templateText += c;
+	    ++i;
+	    continue;
+	}
+	std::string::size_type end = i;
+	while ( end < msg.size() && IsDigit( msg[end] ) )
+	    ++end;
+	std::size_t const length = end - i;
+	if ( length > maxDigitRun )
+	    return false;
+	templateText += templateArgMarker;
+	args += static_cast<char>( static_cast<unsigned char>( length ) );
+	args.append( msg, i, length );
+	i = end;
+    }
+    return true;
+}
+
+bool ExpandLogTemplate (
+    std::string const & templateText,
+    char const * const args,
+    std::size_t const size,
+    std::string & msg)
+{
+    msg.clear();
+    std::size_t position = 0;
+    for ( std::string::const_iterator c = templateText.begin(); c != templateText.end(); ++c )
+    {
+	if ( *c != templateArgMarker )
+	{
+	    msg += *c;
+	    continue;
+	}
+	if ( position >= size )
+	    return false;
+	std::size_t const length = static_cast<unsigned char>( args[position++] );
+	if ( position + length > size )
+	    return false;
+	msg.append( args + position, length );
+	position += length;
+    }
+    return position == size;
+}
+
+void FormatLogRecord (
+    LogRecordHeader const & header,
+    std::string const & msg,
+    std::string & line)
+{
+    line.clear();
+    if ( header.kind == LogRecord_Text )
+    {
+	line = msg;
+	return;
+    }
+    // as Blackboard::LogError
+    if ( header.level == LogLevel_Error )
+	line = "Error: ";
+    // as DateTimeStampPrefix
+    std::time_t const second = static_cast<std::time_t>( header.time / 1000000000LL );
+    std::tm lt;
+    #if defined(MSWINDOWS) && !defined(CYGWIN)
+      localtime_s ( &lt, &second );
+    #else
+      localtime_r ( &second, &lt );
+    #endif
+    char stamp[32];
+    std::strftime( stamp, sizeof(stamp), "%Y-%m-%d_%H-%M-%S: ", &lt );
+    line += stamp;
+    // as LogMessage
+    if ( header.trackerID >= 0 )
+    {
+	char tracker[32];
+	std::snprintf( tracker, sizeof(tracker), "Tracker ID %d: ", static_cast<int>( header.trackerID ) );
+	line += tracker;
+    }
+    line += LevelPrefix( header.level );
+    line += msg;
+}
+
+
+} // namespace mtbmpi
@@ -0,0 +1,120 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		LogRecord.h
+@brief 		Binary log record format.
+@details
+		Used when the option `--mtbmpi-log-format=binary` is given.
+		LoggerMPI sends each message as a Tag_LogRecord: a fixed header,
+		then the message text without the date, tracker ID or level prefixes.
+		The RunLogMgr writes a binary log file, `NAME.mtblog`:
+		a file header, then records.
+
+		Each record is a fixed header of logRecordHeaderSize bytes:
+		time (int64, nanoseconds since the epoch, from FormatTimeStamp's clock),
+		rank (int32), tracker ID (int32; -1 if none), template ID (uint32),
+		payload size (uint32), level (uint8, a LogLevel), and kind (uint8);
+		then the payload:
+		- LogRecord_Template: defines the template ID; the payload is the
+		  message text with each run of digits replaced by templateArgMarker.
+		- LogRecord_Message with a template ID: the payload is the digit runs,
+		  each a uint8 length and the digits.
+		- LogRecord_Message with template ID 0: the payload is the message text.
+		- LogRecord_Text: the payload is a formatted log line, such as the
+		  Blackboard's own messages.
+		A template is defined in each file before its first use,
+		so each rotated file can be decoded alone.
+
+		FormatLogRecord makes the same text line as the text log file.
+		The program mtbmpi-logdump converts binary log files to text.
+		This file and LogRecord.cpp do not use MPI.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_LogRecord_h
+#define INC_mtbmpi_LogRecord_h
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace mtbmpi {
+
+    /// Kinds of binary log records
+    enum LogRecordKind
+    {
+	LogRecord_Message = 0,		///< message from LoggerMPI
+	LogRecord_Text = 1,		///< formatted line
+	LogRecord_Template = 2		///< defines a message template
+    };
+
+    /// Fixed header of a binary log record
+    struct LogRecordHeader
+    {
+	std::int64_t time;		///< nanoseconds since the epoch
+	std::int32_t rank;		///< sender's rank
+	std::int32_t trackerID;		///< tracker ID, or -1 if none
+	std::uint32_t templateID;	///< message template, or 0 if none
+	std::uint32_t size;		///< bytes in the payload
+	std::uint8_t level;		///< LogLevel
+	std::uint8_t kind;		///< LogRecordKind
+    };
+
+    std::size_t const logRecordHeaderSize = 26;		///< bytes in an encoded header
+    std::size_t const logFileHeaderSize = 16;		///< bytes in the file header
+    char const templateArgMarker = '\x1F';		///< digit run in a template
+
+    /// Write the file header: magic "MTBMPILG", version, record header size
+    void EncodeLogFileHeader (
+	char * const dest );		///< logFileHeaderSize bytes
+
+    /// Is this a binary log file header?
+    bool IsLogFileHeader (
+	char const * const data,	///< file header
+	std::size_t const size );	///< bytes in data
+
+    /// Write a record header
+    void EncodeLogRecordHeader (
+	LogRecordHeader const & header,
+	char * const dest );		///< logRecordHeaderSize bytes
+
+    /// Read a record header
+    void DecodeLogRecordHeader (
+	char const * const src,		///< logRecordHeaderSize bytes
+	LogRecordHeader & header );
+
+    /// Append an encoded record to a string; sets the header size
+    void AppendLogRecord (
+	std::string & record,		///< receives the record
+	LogRecordHeader header,		///< header; size is set
+	char const * const payload,	///< payload bytes
+	std::size_t const size );	///< bytes in payload
+
+    /// Split a message into a template and its digit runs.
+    /// @return false if the message cannot be a template
+    bool SplitLogTemplate (
+	std::string const & msg,	///< message text
+	std::string & templateText,	///< receives the template
+	std::string & args );		///< receives the encoded digit runs
+
+    /// Make a message from a template and its digit runs.
+    /// @return false if the arguments do not match the template
+    bool ExpandLogTemplate (
+	std::string const & templateText,	///< template
+	char const * const args,		///< encoded digit runs
+	std::size_t const size,			///< bytes in args
+	std::string & msg );			///< receives the message text
+
+    /// Make the text log line of a message or text record, without the newline
+    void FormatLogRecord (
+	LogRecordHeader const & header,	///< record header
+	std::string const & msg,	///< message text, or the formatted line
+	std::string & line );		///< receives the line
+
+} // namespace mtbmpi
+
+#endif // INC_mtbmpi_LogRecord_h
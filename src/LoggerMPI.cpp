@@ -2,7 +2,8 @@
 file		LoggerMPI.cpp
 class		mtbmpi::LoggerMPI
 brief 		Provides logger functions with a consistent format and destination.
-details		Entries are written to the log via MPI messages.
+details		Entries are written to the log via MPI messages,
+		in batches if this rank has a LogBatcher.
 project		Master-Task-Blackboard MPI Framework
 author		Thomas E. Hilinski <https://github.com/tehilinski>
 copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
@@ -15,6 +16,13 @@ copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
 #include "LoggerMPI.h"
 #include "ErrorHandling.h"
 #include "UtilitiesMPI.h"
+#include "SharedLog.h"
+#include "LogBatcher.h"
+#include "ParallelLog.h"
+#include "LocalLog.h"
+#include "LogRecord.h"
+#include "timeutil.h"
+#include <cstdlib>
 
 namespace mtbmpi {
 
@@ -23,6 +31,11 @@ namespace mtbmpi {
 extern MPI::Intracomm comm;
 
 
+LogLevel LoggerMPI::threshold = LogLevel_Info;
+int LoggerMPI::recordRank = -1;
+bool LoggerMPI::blackboardThread = false;
+
+
 LoggerMPI::LoggerMPI (
     TaskID const blackboardID)
     : className ( "mtbmpi::LoggerMPI" ),
@@ -38,16 +51,166 @@ LoggerMPI::LoggerMPI (LoggerMPI const & rhs)
 
 /// @cond SKIP_PRIVATE
 
-void LoggerMPI::SendMsg ( std::string const & msg, MsgTags const tag )
+void LoggerMPI::SendMsg ( std::string const & msg, MsgTags const tag, bool const isError )
+{
+    ParallelLog * const pParallelLog = ( blackboardThread ? nullptr : ParallelLog::GetActive() );
+    LocalLog * const pLocalLog = ( blackboardThread ? nullptr : LocalLog::GetActive() );
+    if ( ( pParallelLog != nullptr || pLocalLog != nullptr ) && tag != Tag_LogRecord )
+    {
+	// this rank writes the line; as Blackboard::LogError
+	std::string const errorPrefix = "Error: ";
+	bool const needPrefix =
+	    ( tag == Tag_ErrorMessage && msg.compare( 0, errorPrefix.size(), errorPrefix ) != 0 );
+	std::string const & line = ( needPrefix ? errorPrefix + msg : msg );
+	bool const error = isError || tag == Tag_ErrorMessage;
+	if ( pLocalLog != nullptr )
+	    pLocalLog->Append( line, error );
+	else
+	    pParallelLog->Append( line, error );
+	return;
+    }
+    LogBatcher * const pBatcher = LogBatcher::GetActive();
+    if ( pBatcher != nullptr && SharedLog::GetActive() == nullptr )
+	pBatcher->Append( tag, msg, isError || tag == Tag_ErrorMessage );
+    else
+	SendToBlackboard( tag, msg.data(), msg.size(), idBlackboard.GetID() );
+}
+
+bool LoggerMPI::SendRecord ( LogLevel const level, std::string const & msg, int const trackerID )
 {
-    mtbmpi::comm.Send ( msg.data(), msg.size(), MPI::CHAR, idBlackboard.GetID(), tag );
-    CheckErrorMPI( className );
+    if ( recordRank < 0 )
+	return false;
+    LogRecordHeader header;
+    header.time = TimeStampNanoseconds();
+    header.rank = recordRank;
+    header.trackerID = trackerID;
+    header.templateID = 0;
+    header.size = 0;
+    header.level = static_cast<std::uint8_t>( level );
+    header.kind = LogRecord_Message;
+    std::string record;
+    record.reserve( logRecordHeaderSize + msg.size() );
+    AppendLogRecord( record, header, msg.data(), msg.size() );
+    SendMsg( record, Tag_LogRecord, level >= LogLevel_Error );
+    return true;
+}
+
+bool LoggerMPI::SendRecord ( LogLevel const level, std::string const & msg, std::string const & taskIDstr )
+{
+    if ( recordRank < 0 )
+	return false;
+    char * end = nullptr;
+    long const trackerID = std::strtol( taskIDstr.c_str(), &end, 10 );
+    if ( !taskIDstr.empty() && *end == '\0' )
+	return SendRecord( level, msg, static_cast<int>( trackerID ) );
+    std::string text = "Tracker ID ";		// not a number
+    text += taskIDstr;
+    text += ": ";
+    text += msg;
+    return SendRecord( level, text, -1 );
 }
 
 /// @endcond
 
+void LoggerMPI::Flush ()
+{
+    LogBatcher * const pBatcher = LogBatcher::GetActive();
+    if ( pBatcher != nullptr )
+	pBatcher->Flush();
+    if ( blackboardThread )
+	return;
+    ParallelLog * const pParallelLog = ParallelLog::GetActive();
+    if ( pParallelLog != nullptr )
+	pParallelLog->Flush();
+    LocalLog * const pLocalLog = LocalLog::GetActive();
+    if ( pLocalLog != nullptr )
+	pLocalLog->Flush();
+}
+
+void LoggerMPI::FlushIfDue ()
+{
+    LogBatcher * const pBatcher = LogBatcher::GetActive();
+    if ( pBatcher != nullptr )
+	pBatcher->FlushIfDue();
+    if ( blackboardThread )
+	return;
+    ParallelLog * const pParallelLog = ParallelLog::GetActive();
+    if ( pParallelLog != nullptr )
+	pParallelLog->FlushIfDue();
+}
+
+void LoggerMPI::Trace ( std::string const & msg )
+{
+    if ( !IsEnabled( LogLevel_Trace ) )
+	return;
+    if ( SendRecord( LogLevel_Trace, msg, -1 ) )
+	return;
+    std::string text = msg;
+    logMsg.Trace( text );
+    SendMsg( text, Tag_LogMessage );
+}
+
+void LoggerMPI::Trace ( std::string const & msg, TaskID const & taskID )
+{
+    if ( !IsEnabled( LogLevel_Trace ) )
+	return;
+    if ( SendRecord( LogLevel_Trace, msg, taskID.GetID() ) )
+	return;
+    std::string text = msg;
+    logMsg.Trace( text, taskID );
+    SendMsg( text, Tag_LogMessage );
+}
+
+void LoggerMPI::Trace ( std::string const & msg, std::string const & taskIDstr )
+{
+    if ( !IsEnabled( LogLevel_Trace ) )
+	return;
+    if ( SendRecord( LogLevel_Trace, msg, taskIDstr ) )
+	return;
+    std::string text = msg;
+    logMsg.Trace( text, taskIDstr );
+    SendMsg( text, Tag_LogMessage );
+}
+
+void LoggerMPI::Debug ( std::string const & msg )
+{
+    if ( !IsEnabled( LogLevel_Debug ) )
+	return;
+    if ( SendRecord( LogLevel_Debug, msg, -1 ) )
+	return;
+    std::string text = msg;
+    logMsg.Debug( text );
+    SendMsg( text, Tag_LogMessage );
+}
+
+void LoggerMPI::Debug ( std::string const & msg, TaskID const & taskID )
+{
+    if ( !IsEnabled( LogLevel_Debug ) )
+	return;
+    if ( SendRecord( LogLevel_Debug, msg, taskID.GetID() ) )
+	return;
+    std::string text = msg;
+    logMsg.Debug( text, taskID );
+    SendMsg( text, Tag_LogMessage );
+}
+
+void LoggerMPI::Debug ( std::string const & msg, std::string const & taskIDstr )
+{
+    if ( !IsEnabled( LogLevel_Debug ) )
+	return;
+    if ( SendRecord( LogLevel_Debug, msg, taskIDstr ) )
+	return;
+    std::string text = msg;
+    logMsg.Debug( text, taskIDstr );
+    SendMsg( text, Tag_LogMessage );
+}
+
 void LoggerMPI::Message ( std::string const & msg )
 {
+    if ( !IsEnabled( LogLevel_Info ) )
+	return;
+    if ( SendRecord( LogLevel_Info, msg, -1 ) )
+	return;
     std::string text = msg;
     logMsg.Message( text );
     SendMsg( text, Tag_LogMessage );
@@ -55,6 +218,10 @@ void LoggerMPI::Message ( std::string const & msg )
 
 void LoggerMPI::Message ( std::string const & msg, TaskID const & taskID )
 {
+    if ( !IsEnabled( LogLevel_Info ) )
+	return;
+    if ( SendRecord( LogLevel_Info, msg, taskID.GetID() ) )
+	return;
     std::string text = msg;
     logMsg.Message( text, taskID );
     SendMsg( text, Tag_LogMessage );
@@ -62,6 +229,10 @@ void LoggerMPI::Message ( std::string const & msg, TaskID const & taskID )
 
 void LoggerMPI::Message ( std::string const & msg, std::string const & taskIDstr )
 {
+    if ( !IsEnabled( LogLevel_Info ) )
+	return;
+    if ( SendRecord( LogLevel_Info, msg, taskIDstr ) )
+	return;
     std::string text = msg;
     logMsg.Message( text, taskIDstr );
     SendMsg( text, Tag_LogMessage );
@@ -69,6 +240,10 @@ void LoggerMPI::Message ( std::string const & msg, std::string const & taskIDstr
 
 void LoggerMPI::Warning ( std::string const & msg )
 {
+    if ( !IsEnabled( LogLevel_Warning ) )
+	return;
+    if ( SendRecord( LogLevel_Warning, msg, -1 ) )
+	return;
     std::string text = msg;
     logMsg.Warning( text );
     SendMsg( text, Tag_LogMessage );
@@ -76,6 +251,10 @@ void LoggerMPI::Warning ( std::string const & msg )
 
 void LoggerMPI::Warning ( std::string const & msg, TaskID const & taskID )
 {
+    if ( !IsEnabled( LogLevel_Warning ) )
+	return;
+    if ( SendRecord( LogLevel_Warning, msg, taskID.GetID() ) )
+	return;
     std::string text = msg;
     logMsg.Warning( text, taskID );
     SendMsg( text, Tag_LogMessage );
@@ -83,6 +262,10 @@ void LoggerMPI::Warning ( std::string const & msg, TaskID const & taskID )
 
 void LoggerMPI::Warning ( std::string const & msg, std::string const & taskIDstr )
 {
+    if ( !IsEnabled( LogLevel_Warning ) )
+	return;
+    if ( SendRecord( LogLevel_Warning, msg, taskIDstr ) )
+	return;
     std::string text = msg;
     logMsg.Warning( text, taskIDstr );
     SendMsg( text, Tag_LogMessage );
@@ -90,6 +273,10 @@ void LoggerMPI::Warning ( std::string const & msg, std::string const & taskIDstr
 
 void LoggerMPI::Error ( std::string const & msg )
 {
+    if ( !IsEnabled( LogLevel_Error ) )
+	return;
+    if ( SendRecord( LogLevel_Error, msg, -1 ) )
+	return;
     std::string text = msg;
     logMsg.Error( text );
     SendMsg( text, Tag_ErrorMessage );
@@ -97,6 +284,10 @@ void LoggerMPI::Error ( std::string const & msg )
 
 void LoggerMPI::Error ( std::string const & msg, TaskID const& taskID )
 {
+    if ( !IsEnabled( LogLevel_Error ) )
+	return;
+    if ( SendRecord( LogLevel_Error, msg, taskID.GetID() ) )
+	return;
     std::string text = msg;
     logMsg.Error( text, taskID );
     SendMsg( text, Tag_ErrorMessage );
@@ -104,6 +295,10 @@ void LoggerMPI::Error ( std::string const & msg, TaskID const& taskID )
 
 void LoggerMPI::Error ( std::string const & msg, std::string const & taskIDstr )
 {
+    if ( !IsEnabled( LogLevel_Error ) )
+	return;
+    if ( SendRecord( LogLevel_Error, msg, taskIDstr ) )
+	return;
     std::string text = msg;
     logMsg.Error( text, taskIDstr );
     SendMsg( text, Tag_ErrorMessage );
@@ -2,7 +2,24 @@
 @file		LoggerMPI.h
 @class		mtbmpi::LoggerMPI
 @brief 		Provides log messages with a consistent format and destination.
-@details	A message is sent to Blackboard for the log file via MPI messaging.
+@details	A message is sent to Blackboard for the log file via MPI messaging,
+		or through the node's SharedLog if it is used.
+		With binary log records, the message is sent with a LogRecord header
+		instead of the text prefixes.
+		If the rank has a LogBatcher, messages are sent in batches;
+		call Flush to send the batch, for example before stopping.
+		If the rank has a ParallelLog, messages are written by this rank
+		directly to the shared MPI-IO log file instead; the API is the same.
+		If the rank has a LocalLog, messages are appended to this rank's
+		local file, and merged into the log file at the end.
+
+		Messages below the LogLevel threshold are discarded before
+		they are formatted. The MTBMPI_LOG_* macros also skip building
+		the message text, and are removed when compiled with a higher
+		MTBMPI_LOG_MIN_LEVEL:
+@code
+		MTBMPI_LOG_DEBUG( Log(), "item " + ToString(i) + " done", idStr );
+@endcode
 @internal
 project		Master-Task-Blackboard MPI Framework
 @author		Thomas E. Hilinski <https://github.com/tehilinski>
@@ -18,6 +35,7 @@ project		Master-Task-Blackboard MPI Framework
 #include "TaskID.h"
 #include "MsgTags.h"
 #include "LogMessage.h"
+#include "LogLevel.h"
 
 namespace mtbmpi {
 
@@ -35,6 +53,36 @@ namespace mtbmpi {
 	LoggerMPI (
 	    LoggerMPI const & rhs);
 
+	/// Is a message of this level written?
+	static bool IsEnabled ( LogLevel const level )
+	{
+	    return level >= MTBMPI_LOG_MIN_LEVEL && level >= threshold;
+	}
+
+	/// Set the runtime threshold for this process
+	static void SetLevel ( LogLevel const level ) { threshold = level; }
+
+	/// Send binary log records (LogRecord.h) instead of text from this process
+	static void SetBinaryRecords ( int const myRank ) { recordRank = myRank; }
+
+	/// The Blackboard is a thread of this process: send it the messages
+	/// instead of writing them to this rank's ParallelLog or LocalLog,
+	/// which only the Blackboard's thread uses.
+	static void SetBlackboardThread () { blackboardThread = true; }
+
+	/// Get the runtime threshold for this process
+	static LogLevel GetLevel () { return threshold; }
+
+	/// Write a trace message to the log file.
+	void Trace ( std::string const & msg );
+	void Trace ( std::string const & msg, TaskID const & taskID );
+	void Trace ( std::string const & msg, std::string const & taskIDstr );
+
+	/// Write a debug message to the log file.
+	void Debug ( std::string const & msg );
+	void Debug ( std::string const & msg, TaskID const & taskID );
+	void Debug ( std::string const & msg, std::string const & taskIDstr );
+
 	/// Write an informational message to the log file.
 	void Message ( std::string const & msg );
 	void Message ( std::string const & msg, TaskID const & taskID );
@@ -50,10 +98,21 @@ namespace mtbmpi {
 	void Error ( std::string const & msg, TaskID const & taskID );
 	void Error ( std::string const & msg, std::string const & taskIDstr );
 
+	/// Send this rank's batch of messages, if batched, and wait until sent;
+	/// or write this rank's buffer to the parallel log file.
+	void Flush ();
+
+	/// Send or write this rank's batch of messages if it is older than the maximum age.
+	void FlushIfDue ();
+
       private:
 
 	/// @cond SKIP_PRIVATE
 
+	static LogLevel threshold;	// runtime, for this process
+	static int recordRank;		// >= 0: send binary log records
+	static bool blackboardThread;	// the Blackboard is a thread of this process
+
 	std::string const className;
 	TaskID mutable idBlackboard;
 	LogMessage logMsg;
@@ -64,7 +123,11 @@ namespace mtbmpi {
 	    idBlackboard.SetID( blackboardID );
 	}
 
-	void SendMsg ( std::string const & msg, MsgTags const tag );
+	void SendMsg ( std::string const & msg, MsgTags const tag, bool const isError = false );
+
+	// binary log record; returns false if text is sent
+	bool SendRecord ( LogLevel const level, std::string const & msg, int const trackerID );
+	bool SendRecord ( LogLevel const level, std::string const & msg, std::string const & taskIDstr );
 
 	// functions not used
 	LoggerMPI & operator= (LoggerMPI const & rhs);
@@ -76,4 +139,36 @@ namespace mtbmpi {
 
 } // namespace mtbmpi
 
+/// @cond SKIP_PRIVATE
+#define MTBMPI_LOG_AT_LEVEL(level, method, logger, ...) \
+    do { if ( mtbmpi::LoggerMPI::IsEnabled( level ) ) (logger).method( __VA_ARGS__ ); } while (0)
+/// @endcond
+
+// Log macros: the arguments are evaluated only if the level is enabled.
+#if MTBMPI_LOG_MIN_LEVEL <= 0
+  #define MTBMPI_LOG_TRACE(logger, ...)	MTBMPI_LOG_AT_LEVEL( mtbmpi::LogLevel_Trace, Trace, logger, __VA_ARGS__ )
+#else
+  #define MTBMPI_LOG_TRACE(logger, ...)	((void)0)
+#endif
+#if MTBMPI_LOG_MIN_LEVEL <= 1
+  #define MTBMPI_LOG_DEBUG(logger, ...)	MTBMPI_LOG_AT_LEVEL( mtbmpi::LogLevel_Debug, Debug, logger, __VA_ARGS__ )
+#else
+  #define MTBMPI_LOG_DEBUG(logger, ...)	((void)0)
+#endif
+#if MTBMPI_LOG_MIN_LEVEL <= 2
+  #define MTBMPI_LOG_INFO(logger, ...)	MTBMPI_LOG_AT_LEVEL( mtbmpi::LogLevel_Info, Message, logger, __VA_ARGS__ )
+#else
+  #define MTBMPI_LOG_INFO(logger, ...)	((void)0)
+#endif
+#if MTBMPI_LOG_MIN_LEVEL <= 3
+  #define MTBMPI_LOG_WARNING(logger, ...) MTBMPI_LOG_AT_LEVEL( mtbmpi::LogLevel_Warning, Warning, logger, __VA_ARGS__ )
+#else
+  #define MTBMPI_LOG_WARNING(logger, ...) ((void)0)
+#endif
+#if MTBMPI_LOG_MIN_LEVEL <= 4
+  #define MTBMPI_LOG_ERROR(logger, ...)	MTBMPI_LOG_AT_LEVEL( mtbmpi::LogLevel_Error, Error, logger, __VA_ARGS__ )
+#else
+  #define MTBMPI_LOG_ERROR(logger, ...)	((void)0)
+#endif
+
 #endif // INC_mtbmpi_LoggerMPI_h
@@ -14,9 +14,16 @@ project		Master-Task-Blackboard MPI Framework
 #ifndef INC_mtbmpi_MTBMPI_h
 #define INC_mtbmpi_MTBMPI_h
 
+#include "BinaryBuffer.h"
 #include "Communicator.h"
 #include "CommStrings.h"
+#include "DatatypeMPI.h"
 #include "Master.h"
+#include "MatchedProbe.h"
+#include "PersistentMsg.h"
+#include "ResultStream.h"
+#include "ResultWindow.h"
+#include "TrafficComms.h"
 #include "UtilitiesMPI.h"
 #include "versionMTBMPI.h"
 
@@ -6,11 +6,53 @@ brief		This is the main class for starting and ending a MPI job.
 details
 		The Master runs in process with MPI rank == 0
 		and owns the controller and configuration objects.
-		The process with rank == ID_Blackboard has a Master owning a
+		The process with rank == GetBlackboardID() has a Master owning a
 		Blackboard but not a Controller.
-		Other ranks > ID_Blackboard have a Master, that owns a Task,
+		Other ranks >= GetFirstTaskID() have a Master, that owns a Task,
 		that owns a concrete TaskAdapterBase (the application's work task.)
 
+		For jobs with many tasks, the option `--mtbmpi-subcontroller-tasks=N`
+		reserves the highest ranks for sub-controllers, each managing a group
+		of about N tasks, so that the Controller receives batched summaries
+		from the sub-controllers instead of every message from every task.
+		Work tasks always have the contiguous ranks starting at GetFirstTaskID().
+
+		The option `--mtbmpi-task-threads=N`, with N > 1, makes each work rank
+		a TaskHost, which runs N logical tasks in their own threads;
+		MPI is then initialized with at least MPI_THREAD_FUNNELED.
+		Task hosts are not used with sub-controllers or collective phases.
+
+		The option `--mtbmpi-blackboard-thread` runs the Blackboard in a thread
+		of rank 0, and the work tasks start at rank 1; the thread is joined
+		in the destructor, after the Controller stopped the Blackboard.
+
+		Every rank duplicates the global communicator for each class of
+		messages: control, log, results and data (see TrafficComms.h).
+		The option `--mtbmpi-collective-phases` creates a Communicator shared by
+		the Controller and the tasks, and the Controller sends the initialize,
+		start and stop requests to all tasks as one non-blocking broadcast.
+
+		The options `--mtbmpi-result-chunk-size=BYTES` and `--mtbmpi-result-credits=N`
+		set the Blackboard's chunk size and credit window for result streams.
+		The option `--mtbmpi-blackboard-batch=N` sets the most bulk messages
+		the Blackboard receives between its checks for stop requests.
+
+		The option `--mtbmpi-shared-log[=BYTES]` sends log messages through
+		a node-local SharedLog; MPI is then initialized with MPI_THREAD_MULTIPLE.
+		The option `--mtbmpi-result-window[=BYTES]` creates a ResultWindow
+		in the Blackboard for task result records.
+		The option `--mtbmpi-async-blackboard[=RECORDS]` gives the Blackboard
+		writer threads for the log and the output.
+		The options `--mtbmpi-log-flush`, `--mtbmpi-log-max-size` and
+		`--mtbmpi-log-max-age` set the RunLogMgr's flush policy and rotation.
+		The option `--mtbmpi-log-batch[=BYTES]` gives each rank a LogBatcher.
+		The option `--mtbmpi-log-level=NAME` sets the LogLevel threshold on every rank.
+		The option `--mtbmpi-log-format=binary` writes binary log records (LogRecord.h).
+		The option `--mtbmpi-log-mpiio[=BYTES]` writes the log with a ParallelLog;
+		rank 0 chooses the log file name, and the Blackboard writes to the same file.
+		The option `--mtbmpi-log-local[=DIRECTORY]` writes the log with a LocalLog
+		on each rank, merged into the Blackboard's log file by the destructor.
+
 		Your application must have its own master object which inherits mtbmpi::Master
 		and implements the virtual private methods ``DoActions*``.
 
@@ -44,6 +86,8 @@ copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
 #include "versionMTBMPI.h"
 #include "UtilitiesMPI.h"
 #include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
 #include <sstream>
 
 // define the following to write diagnostics to std::cout
@@ -58,10 +102,11 @@ using std::endl;
 namespace mtbmpi {
 
 
-MPI::Intracomm comm;					///< global communicator for tasks
-
 MpiCollectiveCB_NoOp const null_MpiCollectiveCB;	///< A no-op MpiCollectiveCB object
 
+Master::IDNum Master::blackboardRank = Master::ID_Blackboard;
+Master::IDNum Master::firstTaskRank = Master::ID_FirstTask;
+
 
 Master::Master (
     int const argc,
@@ -74,7 +119,10 @@ Master::Master (
     std::string const logFileName)
     : SendsMsgsToLog   ( -1, ID_Blackboard ),
       numProc          ( 0 ),
-      minNumProc       ( std::max( GetFirstTaskID() + 1, useMinNumProc ) ),
+      minNumProc       ( useMinNumProc ),
+      numTasks         ( 0 ),
+      numSubControllers ( 0 ),
+      numTaskThreads   ( 1 ),
       pTaskFactory     ( useTaskFactory ),
       pMpiCollectiveCB ( mpiCollectiveCBPtr ),
       argPair          ( std::make_pair( argc, argv ) ),
@@ -84,11 +132,33 @@ Master::Master (
       std::string const myName = "Master::Master: ";
     #endif
 
+    // options needed before the Configuration exists
+    auto haveOption = [argc, argv] ( std::string const & name ) -> bool
+    {
+	std::string const option = Configuration::OptionPrefix() + name;
+	return std::find_if( argv, argv + argc,
+			     [&option] ( char const * const arg )
+			     { return std::string( arg ).compare( 0, option.size(), option ) == 0; } )
+	       != argv + argc;
+    };
+
     if ( !MPI::Is_initialized() )
     {
 	int argcCopy = argc;
 	char** argvCopy = (char**)argv;
-	MPI::Init ( argcCopy, argvCopy );
+	// the shared log's forwarder thread makes MPI calls, as do
+	// the Blackboard's writer threads when they write to the MPI-IO log,
+	// and the Blackboard's thread beside the Controller
+	bool const needThreads =
+	    haveOption( "shared-log" ) ||
+	    ( haveOption( "log-mpiio" ) && haveOption( "async-blackboard" ) ) ||
+	    haveOption( "blackboard-thread" );
+	if ( needThreads )
+	    MPI::Init_thread ( argcCopy, argvCopy, MPI::THREAD_MULTIPLE );
+	else if ( haveOption( "task-threads" ) )	// only the host's thread calls MPI
+	    MPI::Init_thread ( argcCopy, argvCopy, MPI::THREAD_FUNNELED );
+	else
+	    MPI::Init ( argcCopy, argvCopy );
     }
 
     // create a communicator for C5asks
@@ -115,8 +185,13 @@ Master::Master (
     if ( !msgErrorHandler.empty() )
 	os << versionMTBMPI.ProductNameShort() << ": " << msgErrorHandler << std::endl;
     mtbmpi::comm.Set_name( versionMTBMPI.ProductNameShort().c_str() );
-    SetIDs( mtbmpi::comm.Get_rank(), ID_Blackboard );
+    mtbmpi::CreateTrafficComms ();
+    if ( haveOption( "blackboard-thread" ) )
+	UseBlackboardThread ();
+    SetIDs( mtbmpi::comm.Get_rank(), GetBlackboardID() );
     numProc = mtbmpi::comm.Get_size();
+    // the application's minimum counts a rank for the Blackboard
+    minNumProc = std::max( GetFirstTaskID() + 1, minNumProc - ( ID_FirstTask - GetFirstTaskID() ) );
     if ( numProc < GetMinimumNumberOfProcesses() )
     {
 	if ( GetID() == ID_Master )
@@ -130,14 +205,54 @@ Master::Master (
     	return;
     }
 
+    // every rank has the configuration, so every rank knows the framework options
+    pConfig = std::make_shared<mtbmpi::Configuration>(
+		    GetArgs().first, GetArgs().second );
+    if ( GetConfiguration().HaveOption( "log-level" ) )
+	SetLogLevel ();
+    if ( GetConfiguration().HaveOption( "log-local" ) )
+	CreateLocalLog ();
+    else if ( GetConfiguration().HaveOption( "log-mpiio" ) )
+	CreateParallelLog ( logFileName );
+    if ( GetConfiguration().GetOption<std::string>( "log-format", "text" ) == "binary" &&
+	 !pParallelLog && !pLocalLog )
+    {
+	SetTimeStampClock( TimeStamp_Monotonic );
+	LoggerMPI::SetBinaryRecords( GetID() );
+    }
+    SetNumberOfTaskThreads ();
+    SetNumberOfSubControllers ();
+    if ( GetConfiguration().HaveOption( "collective-phases" ) && numTaskThreads == 1 )
+	CreateTaskCommunicator ();
+    if ( GetConfiguration().HaveOption( "shared-log" ) )
+	CreateSharedLog ();
+    if ( GetConfiguration().HaveOption( "result-window" ) )
+    {
+	int capacity = GetConfiguration().GetOption<int>( "result-window", 0 );
+	if ( capacity <= 1 )	// option without a value
+	    capacity = ResultWindow::defaultCapacity;
+	pResultWindow = std::make_shared<mtbmpi::ResultWindow>(
+			    mtbmpi::resultComm, static_cast<int>(GetBlackboardID()), capacity );
+    }
+    if ( GetConfiguration().HaveOption( "log-batch" ) && GetID() != GetBlackboardID() &&
+	 !pParallelLog && !pLocalLog )
+    {
+	int batchSize = GetConfiguration().GetOption<int>( "log-batch", 0 );
+	if ( batchSize <= 1 )	// option without a value
+	    batchSize = LogBatcher::defaultBatchSize;
+	pLogBatcher = std::make_shared<mtbmpi::LogBatcher>(
+			  mtbmpi::logComm, static_cast<int>(GetBlackboardID()), batchSize,
+			  GetConfiguration().GetOption<int>( "log-batch-age", LogBatcher::defaultMaxAge ) );
+    }
+
     // MPI init is done
-    if ( GetID() > ID_Blackboard && pMpiCollectiveCB.get() )
+    if ( GetID() >= GetFirstTaskID() && pMpiCollectiveCB.get() )
     {
 	pMpiCollectiveCB->SetID( GetID() );
 	pMpiCollectiveCB->Initialize();
     }
 
-    CreateProcesses( logFileName, useOutputMgr );
+    CreateProcesses( ( pParallelLog ? pParallelLog->GetFileName() : logFileName ), useOutputMgr );
 }
 
 Master::~Master ()
@@ -152,9 +267,19 @@ Master::~Master ()
     {
 	if ( GetID() == GetControllerID() )
 	    WaitUntilStopped ();
+	if ( blackboardThread.joinable() )
+	    blackboardThread.join();	// the Controller stopped the Blackboard
 	// all tasks
-	if ( GetID() > ID_Blackboard && pMpiCollectiveCB.get() )
+	if ( GetID() >= GetFirstTaskID() && pMpiCollectiveCB.get() )
 	    pMpiCollectiveCB->Finalize();  // derived classes already destroyed
+	pLogBatcher.reset();		// sends the remaining messages
+	MergeLocalLog ();		// collective; into the Blackboard's log
+	if ( pBlackboard.get() )
+	    pBlackboard->GetRunLogMgr().Close();	// may write to the parallel log
+	pParallelLog.reset();		// collective; writes the remaining lines
+	pTaskComm.reset();		// free communicator before finalize
+	pSharedLog.reset();		// collective; after the Blackboard flushed it
+	pResultWindow.reset();		// collective
 	MPI::Finalize();
     }
 
@@ -167,10 +292,34 @@ bool Master::IsInitialized () const
 {
     if ( GetID() == ID_Master )
 	return pController.get() != nullptr;
-    else if ( GetID() == ID_Blackboard )
+    else if ( GetID() == GetBlackboardID() )
 	return pBlackboard.get() != nullptr;
+    else if ( IsSubControllerID( GetID() ) )
+	return pSubController.get() != nullptr;
     else
-	return pTask.get() != nullptr;
+	return pTask.get() != nullptr || pTaskHost.get() != nullptr;
+}
+
+Master::IDNum Master::GetSubControllerFirstTaskID (
+    int const index ) const
+{
+    // tasks are divided as evenly as possible among the sub-controllers
+    if ( numSubControllers == 0 )
+	return GetFirstTaskID() + ( index > 0 ? numTasks : 0 );
+    return GetFirstTaskID() +
+	   static_cast<IDNum>( ( static_cast<long>(index) * numTasks ) / numSubControllers );
+}
+
+Master::IDNum Master::GetTaskControllerID (
+    IDNum const taskID ) const
+{
+    if ( numSubControllers == 0 )
+	return ID_Master;
+    // inverse of GetSubControllerFirstTaskID
+    long const taskNum = taskID - GetFirstTaskID();
+    int const index = static_cast<int>(
+	( (taskNum + 1) * numSubControllers - 1 ) / numTasks );
+    return GetSubControllerID( index );
 }
 
 /// @cond SKIP_PRIVATE
@@ -190,12 +339,17 @@ void Master::CreateProcesses (
 	  cout << myName << "Creating Controller process" << endl;
 	#endif
 
+	// with the option blackboard-thread, the Blackboard shares this rank
+	if ( GetBlackboardID() == ID_Master )
+	{
+	    MakeBlackboard ( logFileName, useOutputMgr );
+	    StartBlackboardThread ();
+	}
+
 	// Log().Message("Creating Controller process");
-	pConfig = std::make_shared<mtbmpi::Configuration>(
-			GetArgs().first, GetArgs().second );
 	pController = std::make_shared<mtbmpi::Controller>(
 			*this, GetID(), GetBlackboardID(),
-			numProc - GetFirstTaskID(), GetFirstTaskID(),
+			GetNumberOfLogicalTasks(), GetFirstTaskID(),
 			pConfig );
 	// Assume blackboard is (or shortly will be) available
 	pController->SetBlackboardState ( State_Running );
@@ -208,28 +362,38 @@ void Master::CreateProcesses (
 	// so that derived class can do things after this constructor
 	// pController->Activate();
     }
-    else if ( GetID() == ID_Blackboard )
+    else if ( GetID() == GetBlackboardID() )
     {
 	#ifdef DBG_MPI_MASTER
 	  cout << myName << "Creating Blackboard process" << endl;
 	#endif
 
 	// Log().Message("Creating Blackboard process");
-	pBlackboard = std::make_shared<mtbmpi::Blackboard>(
-			GetID(), GetControllerID(), useOutputMgr, logFileName );
+	MakeBlackboard ( logFileName, useOutputMgr );
 	pBlackboard->Activate();
 
 	#ifdef DBG_MPI_MASTER
 	  cout << myName << "Master: Done creating Blackboard process" << endl;
 	#endif
     }
+    else if ( IsSubControllerID( GetID() ) )
+    {
+	#ifdef DBG_MPI_MASTER
+	  cout << myName << "Creating sub-controller process " << GetID() << endl;
+	#endif
+
+	MakeSubController( GetID() );
+    }
     else // Task
     {
 	#ifdef DBG_MPI_MASTER
 	  cout << myName << "Creating task process " << GetID() << endl;
 	#endif
 
-	MakeTask( GetID() );
+	if ( numTaskThreads > 1 )
+	    MakeTaskHost( GetID() );
+	else
+	    MakeTask( GetID() );
     }
 
     #ifdef DBG_MPI_MASTER
@@ -237,17 +401,249 @@ void Master::CreateProcesses (
     #endif
 }
 
+void Master::UseBlackboardThread ()
+{
+    // the Blackboard's thread and the Controller both make MPI calls
+    if ( MPI::Query_thread() < MPI::THREAD_MULTIPLE )
+    {
+	if ( mtbmpi::comm.Get_rank() == ID_Master )
+	    os << versionMTBMPI.ProductNameShort()
+	       << ": the option blackboard-thread requires MPI_THREAD_MULTIPLE; not used." << std::endl;
+	return;
+    }
+    blackboardRank = ID_Master;
+    firstTaskRank = ID_Master + 1;
+    // only the Blackboard's thread writes to a ParallelLog or LocalLog
+    if ( mtbmpi::comm.Get_rank() == ID_Master )
+	LoggerMPI::SetBlackboardThread ();
+}
+
+void Master::MakeBlackboard (
+    std::string const & logFileName,
+    OutputMgrPtr useOutputMgr)
+{
+    pBlackboard = std::make_shared<mtbmpi::Blackboard>(
+		    GetID(), GetControllerID(), useOutputMgr, logFileName );
+    pBlackboard->SetResultFlowControl (
+	    GetConfiguration().GetOption<int>( "result-chunk-size", Blackboard::defaultResultChunkSize ),
+	    GetConfiguration().GetOption<int>( "result-credits", Blackboard::defaultResultCredits ) );
+    pBlackboard->SetBulkBatchSize (
+	    GetConfiguration().GetOption<int>( "blackboard-batch", Blackboard::defaultBulkBatchSize ) );
+    ConfigureRunLog ( pBlackboard->GetRunLogMgr() );
+    if ( GetConfiguration().HaveOption( "async-blackboard" ) )
+    {
+	int capacity = GetConfiguration().GetOption<int>( "async-blackboard", 0 );
+	if ( capacity <= 1 )	// option without a value
+	    capacity = AsyncWriter::defaultCapacity;
+	pBlackboard->SetAsyncWriters (
+	    capacity, GetConfiguration().HaveOption( "async-drop-logs" ) );
+    }
+}
+
+void Master::StartBlackboardThread ()
+{
+    // the Blackboard's event loop runs until the Controller stops it;
+    // the Controller would wait forever for a Blackboard which failed
+    blackboardThread = std::thread( [this] ()
+    {
+	try
+	{
+	    pBlackboard->Activate();
+	}
+	catch ( std::exception const & e )
+	{
+	    os << versionMTBMPI.ProductNameShort() << ": Blackboard: " << e.what() << std::endl;
+	    mtbmpi::comm.Abort( EXIT_FAILURE );
+	}
+    } );
+}
+
+void Master::SetNumberOfTaskThreads ()
+{
+    numTaskThreads = std::max( 1, GetConfiguration().GetOption<int>( "task-threads", 1 ) );
+    if ( numTaskThreads == 1 )
+	return;
+    std::string reason;
+    if ( MPI::Query_thread() < MPI::THREAD_FUNNELED )
+	reason = "requires MPI_THREAD_FUNNELED";
+    else if ( GetConfiguration().HaveOption( "subcontroller-tasks" ) )
+	reason = "is not used with sub-controllers";
+    else if ( GetConfiguration().HaveOption( "collective-phases" ) )
+	reason = "is not used with collective phases";
+    if ( !reason.empty() )
+    {
+	if ( GetID() == ID_Master )
+	    os << versionMTBMPI.ProductNameShort()
+	       << ": the option task-threads " << reason << "; not used." << std::endl;
+	numTaskThreads = 1;
+    }
+}
+
+void Master::SetNumberOfSubControllers ()
+{
+    // option value is the number of tasks per sub-controller
+    int const numWorkRanks = numProc - GetFirstTaskID();
+    int const tasksPerSubController =
+	GetConfiguration().GetOption<int>( "subcontroller-tasks", 0 );
+    numSubControllers = 0;
+    if ( tasksPerSubController > 0 && numWorkRanks > 2 )
+    {
+	// each sub-controller needs at least one task
+	numSubControllers =
+	    ( numWorkRanks + tasksPerSubController ) / ( tasksPerSubController + 1 );
+	numSubControllers = std::min( numSubControllers, numWorkRanks / 2 );
+    }
+    numTasks = numWorkRanks - numSubControllers;
+}
+
+void Master::CreateTaskCommunicator ()
+{
+    // Controller, then the work tasks; all ranks must call this
+    std::vector<int> ranks ( numTasks );
+    std::generate( ranks.begin(), ranks.end(), Sequence<int>( GetFirstTaskID() ) );
+    ranks.insert( ranks.begin(), static_cast<int>(ID_Master) );
+    pTaskComm = std::make_shared<mtbmpi::Communicator>(
+		    std::string("MTBMPI Controller and tasks"), ranks );
+    if ( !pTaskComm->IsInitialized() )	// not a member
+	pTaskComm.reset();
+}
+
+void Master::SetLogLevel ()
+{
+    std::string const name = GetConfiguration().GetOption<std::string>( "log-level", "info" );
+    LogLevel const level = ToLogLevel( name, LogLevel_Off );
+    if ( level == LogLevel_Off && name != "off" )
+    {
+	if ( GetID() == ID_Master )
+	    os << versionMTBMPI.ProductNameShort()
+	       << ": unknown log level: " << name << "; using info." << std::endl;
+	return;
+    }
+    LoggerMPI::SetLevel( level );
+}
+
+void Master::CreateSharedLog ()
+{
+    // all ranks must call this
+    if ( MPI::Query_thread() < MPI::THREAD_MULTIPLE )
+    {
+	if ( GetID() == ID_Master )
+	    os << versionMTBMPI.ProductNameShort()
+	       << ": the shared log requires MPI_THREAD_MULTIPLE; not used." << std::endl;
+	return;
+    }
+    int ringSize = GetConfiguration().GetOption<int>( "shared-log", 0 );
+    if ( ringSize <= 1 )	// option without a value
+	ringSize = SharedLog::defaultRingSize;
+    pSharedLog = std::make_shared<mtbmpi::SharedLog>( mtbmpi::logComm, static_cast<int>(GetBlackboardID()), ringSize );
+}
+
+void Master::CreateParallelLog (
+    std::string const & logFileName)
+{
+    // all ranks must call this
+    if ( GetConfiguration().HaveOption( "async-blackboard" ) &&
+	 MPI::Query_thread() < MPI::THREAD_MULTIPLE )
+    {
+	if ( GetID() == ID_Master )
+	    os << versionMTBMPI.ProductNameShort()
+	       << ": the MPI-IO log with the async Blackboard requires MPI_THREAD_MULTIPLE; not used."
+	       << std::endl;
+	return;
+    }
+    // the name has the time, so only rank 0 makes it
+    std::string name;
+    if ( GetID() == ID_Master )
+	name = ( logFileName.empty() ? Blackboard::CreateLogFileName( logFileName ) : logFileName );
+    int size = static_cast<int>( name.size() );
+    mtbmpi::comm.Bcast( &size, 1, MPI::INT, ID_Master );
+    name.resize( size );
+    mtbmpi::comm.Bcast( &name[0], size, MPI::CHAR, ID_Master );
+    int bufferSize = GetConfiguration().GetOption<int>( "log-mpiio", 0 );
+    if ( bufferSize <= 1 )	// option without a value
+	bufferSize = ParallelLog::defaultBufferSize;
+    pParallelLog = std::make_shared<mtbmpi::ParallelLog>(
+		       mtbmpi::comm, name, bufferSize,
+		       GetConfiguration().GetOption<int>( "log-batch-age", LogBatcher::defaultMaxAge ) );
+}
+
+void Master::CreateLocalLog ()
+{
+    // all ranks must call this
+    std::string directory = GetConfiguration().GetOption<std::string>( "log-local", "" );
+    if ( directory == "1" )	// option without a value
+	directory.clear();
+    pLocalLog = std::make_shared<mtbmpi::LocalLog>(
+		    mtbmpi::comm, static_cast<int>(GetBlackboardID()), directory );
+}
+
+void Master::MergeLocalLog ()
+{
+    // all ranks must call this
+    if ( !pLocalLog )
+	return;
+    pLocalLog->Merge( pBlackboard.get() ? &pBlackboard->GetRunLogMgr() : nullptr );
+    pLocalLog.reset();
+}
+
+void Master::ConfigureRunLog (
+    RunLogMgr & runLog)
+{
+    if ( GetConfiguration().GetOption<std::string>( "log-format", "text" ) == "binary" )
+	runLog.SetBinary( GetID() );
+    // flush policy: close, errors, or an interval in milliseconds
+    if ( GetConfiguration().HaveOption( "log-flush" ) )
+    {
+	std::string const policy = GetConfiguration().GetOption<std::string>( "log-flush", "" );
+	if ( policy == "close" )
+	    runLog.SetFlushPolicy( RunLogMgr::Flush_Close );
+	else if ( policy == "errors" )
+	    runLog.SetFlushPolicy( RunLogMgr::Flush_Errors );
+	else
+	    runLog.SetFlushPolicy( RunLogMgr::Flush_Interval,
+		GetConfiguration().GetOption<int>( "log-flush", RunLogMgr::defaultFlushInterval ) );
+    }
+    runLog.SetRotation (
+	GetConfiguration().GetOption<long long>( "log-max-size", 0 ),
+	GetConfiguration().GetOption<int>( "log-max-age", 0 ) );
+}
+
+void Master::MakeSubController (
+    IDNum const id)		// mpi task rank
+{
+    // create and run sub-controller until its tasks are stopped
+    int const index = id - GetSubControllerID(0);
+    pSubController = std::make_shared<mtbmpi::SubController>(
+		   *this, id, GetBlackboardID(), GetControllerID(),
+		   GetSubControllerNumberOfTasks(index), GetSubControllerFirstTaskID(index),
+		   pConfig );
+    pSubController->Activate();
+    pSubController.reset();
+}
+
 void Master::MakeTask (
     IDNum const id)		// mpi task rank
 {
     // create and run task until stopped or completed
     std::string taskName = "Task "; taskName += ToString(id);
     pTask = std::make_shared<mtbmpi::Task>(
-		   *this, taskName, id, GetControllerID(), GetBlackboardID(), pTaskFactory, GetArgs() );
+		   *this, taskName, id, GetTaskControllerID(id), GetBlackboardID(), pTaskFactory, GetArgs() );
     pTask->Activate();
     pTask.reset();
 }
 
+void Master::MakeTaskHost (
+    IDNum const id)		// mpi task rank
+{
+    // create and run the host until its logical tasks are stopped
+    IDNum const firstTaskID = GetFirstTaskID() + ( id - GetFirstTaskID() ) * numTaskThreads;
+    pTaskHost = std::make_shared<mtbmpi::TaskHost>(
+		   *this, id, GetBlackboardID(), GetControllerID(),
+		   numTaskThreads, firstTaskID, pTaskFactory, GetArgs() );
+    pTaskHost->Activate();
+    pTaskHost.reset();
+}
+
 /// @endcond
 
 void Master::StopAllTasks ()
@@ -6,11 +6,61 @@
 @details
 		The Master runs in process with MPI rank == 0
 		and owns the controller and configuration objects.
-		The process with rank == ID_Blackboard has a Master owning a
+		The process with rank == GetBlackboardID() has a Master owning a
 		Blackboard but not a Controller.
-		Other ranks > ID_Blackboard have a Master, that owns a Task,
+		Other ranks >= GetFirstTaskID() have a Master, that owns a Task,
 		that owns a concrete TaskAdapterBase (the application's work task.)
 
+		For jobs with many tasks, the option `--mtbmpi-subcontroller-tasks=N`
+		reserves the highest ranks for sub-controllers, each managing a group
+		of about N tasks, so that the Controller receives batched summaries
+		from the sub-controllers instead of every message from every task.
+		Work tasks always have the contiguous ranks starting at GetFirstTaskID().
+
+		The option `--mtbmpi-task-threads=N`, with N > 1, makes each work rank
+		a TaskHost, which runs N logical tasks in their own threads;
+		MPI is then initialized with at least MPI_THREAD_FUNNELED.
+		Task hosts are not used with sub-controllers or collective phases.
+
+		The option `--mtbmpi-blackboard-thread` runs the Blackboard in a thread
+		of rank 0, beside the Controller, so that all other ranks are work tasks:
+		GetBlackboardID is then ID_Master, GetFirstTaskID is 1, and the
+		minimum number of processes given to the constructor is one less.
+		MPI is then initialized with MPI_THREAD_MULTIPLE; without it
+		the Blackboard has its own rank, as usual.
+
+		Every rank duplicates the global communicator for each class of
+		messages: control, log, results and data (see TrafficComms.h).
+		The option `--mtbmpi-collective-phases` creates a Communicator shared by
+		the Controller and the tasks, and the Controller sends the initialize,
+		start and stop requests to all tasks as one non-blocking broadcast.
+
+		The options `--mtbmpi-result-chunk-size=BYTES` and `--mtbmpi-result-credits=N`
+		set the Blackboard's chunk size and credit window for result streams.
+		The option `--mtbmpi-blackboard-batch=N` sets the most bulk messages
+		the Blackboard receives between its checks for stop requests.
+
+		The option `--mtbmpi-shared-log[=BYTES]` sends log messages through
+		a node-local SharedLog; MPI is then initialized with MPI_THREAD_MULTIPLE.
+		The option `--mtbmpi-result-window[=BYTES]` creates a ResultWindow
+		in the Blackboard for task result records.
+		The option `--mtbmpi-async-blackboard[=RECORDS]` gives the Blackboard
+		writer threads for the log and the output.
+		The options `--mtbmpi-log-flush`, `--mtbmpi-log-max-size` and
+		`--mtbmpi-log-max-age` set the RunLogMgr's flush policy and rotation.
+		The option `--mtbmpi-log-batch[=BYTES]` gives each rank a LogBatcher,
+		and `--mtbmpi-log-batch-age=MILLISECONDS` sets its maximum age.
+		The option `--mtbmpi-log-level=NAME` sets the LogLevel threshold on every rank:
+		trace, debug, info (default), warning, error, or off.
+		The option `--mtbmpi-log-format=binary` writes a binary log file;
+		use the program mtbmpi-logdump to convert it to text.
+		The option `--mtbmpi-log-mpiio[=BYTES]` gives each rank a ParallelLog,
+		which writes the rank's log messages directly to the log file with MPI-IO;
+		the log file is then text, and is not rotated.
+		The option `--mtbmpi-log-local[=DIRECTORY]` gives each rank a LocalLog,
+		which appends the rank's log messages to a file in DIRECTORY;
+		the destructor merges the files into the log file.
+
 		Your application must have its own master object which inherits mtbmpi::Master
 		and implements the virtual private methods ``DoActions*``.
 
@@ -44,11 +94,20 @@ project		Master-Task-Blackboard MPI Framework
 
 #include "SendsMsgsToLog.h"
 #include "Configuration.h"
+#include "Communicator.h"
 #include "Controller.h"
+#include "SubController.h"
+#include "TaskHost.h"
 #include "Blackboard.h"
+#include "SharedLog.h"
+#include "ResultWindow.h"
+#include "LogBatcher.h"
+#include "ParallelLog.h"
+#include "LocalLog.h"
 #include "MpiCollectiveCB.h"
 #include "ErrorHandling.h"
 #include <memory>
+#include <thread>
 #include <iosfwd>
 
 namespace mtbmpi {
@@ -65,9 +124,17 @@ class Master : public SendsMsgsToLog
     typedef std::shared_ptr<OutputMgr>			OutputMgrPtr;
     typedef std::shared_ptr<mtbmpi::MpiCollectiveCB>	MpiCollectiveCBPtr;
     typedef std::shared_ptr<mtbmpi::Configuration>	ConfigurationPtr;
+    typedef std::shared_ptr<mtbmpi::Communicator>	CommunicatorPtr;
     typedef std::shared_ptr<mtbmpi::Controller>		ControllerPtr;
     typedef std::shared_ptr<mtbmpi::Blackboard>		BlackboardPtr;
+    typedef std::shared_ptr<mtbmpi::SubController>	SubControllerPtr;
     typedef std::shared_ptr<mtbmpi::Task>		TaskPtr;
+    typedef std::shared_ptr<mtbmpi::TaskHost>		TaskHostPtr;
+    typedef std::shared_ptr<mtbmpi::SharedLog>		SharedLogPtr;
+    typedef std::shared_ptr<mtbmpi::ResultWindow>	ResultWindowPtr;
+    typedef std::shared_ptr<mtbmpi::LogBatcher>		LogBatcherPtr;
+    typedef std::shared_ptr<mtbmpi::ParallelLog>	ParallelLogPtr;
+    typedef std::shared_ptr<mtbmpi::LocalLog>		LocalLogPtr;
     typedef std::pair<int const, char const * const *>	ArgPair;		///< command-line  arc, argv
 
   protected:
@@ -109,8 +176,8 @@ class Master : public SendsMsgsToLog
     Configuration const & GetConfiguration () const { return *pConfig; }	///< Get configuration
 
     static IDNum GetControllerID ()	{ return ID_Master; }		///< MPI rank of controller task
-    static IDNum GetBlackboardID ()	{ return ID_Blackboard; }	///< MPI rank of blackboard task
-    static IDNum GetFirstTaskID ()	{ return ID_FirstTask; }	///< MPI rank of 1st work task
+    static IDNum GetBlackboardID ()	{ return blackboardRank; }	///< MPI rank of blackboard task
+    static IDNum GetFirstTaskID ()	{ return firstTaskRank; }	///< MPI rank of 1st work task
 
     /// Check if the Master is initialized
     bool IsInitialized () const;
@@ -118,19 +185,51 @@ class Master : public SendsMsgsToLog
     /// No check for existence! Only rank = 0 has this.
     Controller & GetController () const { return *pController; }
 
-    /// No check for existence! Only rank = 1 has this.
+    /// No check for existence! Only rank = GetBlackboardID() has this.
     Blackboard & GetBlackboard () const { return *pBlackboard; }
 
     /// Is the task ID a valid value?
-    bool IsValidTaskID (IDNum const id) { return (id >= ID_FirstTask && id < numProc); }
+    bool IsValidTaskID (IDNum const id) const { return (id >= GetFirstTaskID() && id < GetFirstTaskID() + numTasks); }
+
+    int GetNumberOfTasks () const { return numTasks; }				///< no. of work tasks
+    int GetNumberOfSubControllers () const { return numSubControllers; }	///< zero if none
+    int GetNumberOfTaskThreads () const { return numTaskThreads; }		///< logical tasks per work rank
+    int GetNumberOfLogicalTasks () const { return numTasks * numTaskThreads; }	///< tasks tracked by the Controller
+
+    /// MPI rank of a sub-controller
+    IDNum GetSubControllerID (
+      int const index ) const		///< zero-based sub-controller index
+      { return numProc - numSubControllers + index; }
+
+    /// Is the ID a sub-controller's rank?
+    bool IsSubControllerID (IDNum const id) const
+      { return numSubControllers > 0 && id >= GetSubControllerID(0) && id < numProc; }
+
+    /// MPI rank of the 1st work task managed by a sub-controller
+    IDNum GetSubControllerFirstTaskID (
+      int const index ) const;		///< zero-based sub-controller index
+
+    /// Number of work tasks managed by a sub-controller
+    int GetSubControllerNumberOfTasks (
+      int const index ) const		///< zero-based sub-controller index
+      { return GetSubControllerFirstTaskID(index + 1) - GetSubControllerFirstTaskID(index); }
+
+    /// Communicator shared by the Controller and the tasks;
+    /// empty unless the option `--mtbmpi-collective-phases` is used.
+    /// The Controller has rank zero.
+    CommunicatorPtr GetTaskCommunicator () const { return pTaskComm; }
+
+    /// MPI rank of the controller of a work task: Controller or sub-controller.
+    IDNum GetTaskControllerID (
+      IDNum const taskID ) const;	///< work task rank
 
     virtual ~Master () = 0;
 
   protected:
 
     static const IDNum ID_Master     = 0;	///< rank of Controller task
-    static const IDNum ID_Blackboard = 1;	///< rank of Blackboard task
-    static const IDNum ID_FirstTask  = 2;	///< rank of 1st work task
+    static const IDNum ID_Blackboard = 1;	///< rank of Blackboard task, in its own process
+    static const IDNum ID_FirstTask  = 2;	///< rank of 1st work task, after the Blackboard's
 
     void WaitUntilStopped ();			///< Wait until the Controller is stopped.
 
@@ -149,12 +248,27 @@ class Master : public SendsMsgsToLog
 
     /// @cond SKIP_PRIVATE
 
+    static IDNum blackboardRank;		// ID_Blackboard, or ID_Master with a thread
+    static IDNum firstTaskRank;			// ID_FirstTask, or ID_Master + 1
+
     int numProc;				// number of processes
     int minNumProc;				// minimum number of processes
+    int numTasks;				// number of work tasks
+    int numSubControllers;			// number of sub-controllers
+    int numTaskThreads;				// logical tasks per work rank
     ConfigurationPtr pConfig;			// Configuration
+    CommunicatorPtr  pTaskComm;			// Controller and tasks communicator
+    SharedLogPtr     pSharedLog;		// node-local log rings
+    ResultWindowPtr  pResultWindow;		// Blackboard's RMA window for results
+    LogBatcherPtr    pLogBatcher;		// this rank's batch of log messages
+    ParallelLogPtr   pParallelLog;		// MPI-IO log file
+    LocalLogPtr      pLocalLog;			// this rank's local log file
     ControllerPtr    pController;		// Controller
+    SubControllerPtr pSubController;		// sub-controller
     BlackboardPtr    pBlackboard;		// Blackboard
+    std::thread      blackboardThread;		// runs the Blackboard in rank 0
     TaskPtr          pTask;			// Task
+    TaskHostPtr      pTaskHost;			// host of logical tasks
     TaskFactoryPtr   pTaskFactory;		// task factory
     MpiCollectiveCBPtr pMpiCollectiveCB;	// MPI collective callback functions object
     ArgPair argPair;				// arc, argv
@@ -164,9 +278,37 @@ class Master : public SendsMsgsToLog
       std::string const & logFileName,
       OutputMgrPtr useOutputMgr );
 
+    void UseBlackboardThread ();	// before SetIDs
+
+    void MakeBlackboard (
+      std::string const & logFileName,
+      OutputMgrPtr useOutputMgr );
+
+    void StartBlackboardThread ();
+
+    void SetNumberOfTaskThreads ();
+    void SetNumberOfSubControllers ();
+
+    void CreateTaskCommunicator ();	// collective over all ranks
+
+    void SetLogLevel ();		// from the option log-level
+    void CreateSharedLog ();		// collective over all ranks
+    void CreateParallelLog (		// collective over all ranks
+      std::string const & logFileName);	// from rank 0; may be empty
+    void CreateLocalLog ();		// collective over all ranks
+    void MergeLocalLog ();		// collective over all ranks
+    void ConfigureRunLog (		// flush policy and rotation options
+      RunLogMgr & runLog);
+
+    void MakeSubController (
+      IDNum const id);		// mpi task rank
+
     void MakeTask (
       IDNum const id);		// mpi task rank
 
+    void MakeTaskHost (
+      IDNum const id);		// mpi task rank
+
     /// @endcond
 
     // Derived class tasks upon controller activation
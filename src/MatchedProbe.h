@@ -0,0 +1,96 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		MatchedProbe.h
+@brief 		Matched probe and receive (MPI_Mprobe, MPI_Improbe, MPI_Mrecv) for the C++ bindings.
+@details
+		The MPI C++ bindings have no MPI-3 functions, so these wrap the C API.
+
+		A matched probe removes the message from the matching queue and
+		returns a handle to it. The message is matched once: Mrecv receives
+		exactly the probed message, without matching again, and no other
+		probe or receive, in this thread or another, can take it.
+		So every message which is probed must be received with Mrecv,
+		even one which is discarded.
+
+		The framework's receive paths probe this way:
+		the Blackboard, the Controller, sub-controllers, tasks, and
+		CommStrings::Receive; OutputMgr::HandleOutputMessage gets the handle.
+@code
+		MPI_Message message;
+		MPI::Status status;
+		mtbmpi::Mprobe ( mtbmpi::comm, MPI_ANY_SOURCE, MPI_ANY_TAG, message, status );
+		std::vector<char> buffer ( status.Get_count( MPI::BYTE ) );
+		mtbmpi::Mrecv ( buffer.data(), buffer.size(), MPI::BYTE, message );
+@endcode
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_MatchedProbe_h
+#define INC_mtbmpi_MatchedProbe_h
+
+#include "mpi.h"
+#include <vector>
+
+namespace mtbmpi {
+
+
+/// Wait for a message and match it
+inline void Mprobe (
+    MPI::Intracomm & comm,		///< communicator
+    int const source,			///< rank, or MPI_ANY_SOURCE
+    int const tag,			///< message tag, or MPI_ANY_TAG
+    MPI_Message & message,		///< receives the message handle
+    MPI::Status & status )		///< receives the source, tag and size
+{
+    MPI_Status cStatus;
+    MPI_Mprobe ( source, tag, comm, &message, &cStatus );
+    status = cStatus;
+}
+
+/// Match a message if one is waiting
+/// @return true if a message was matched
+inline bool Improbe (
+    MPI::Intracomm & comm,		///< communicator
+    int const source,			///< rank, or MPI_ANY_SOURCE
+    int const tag,			///< message tag, or MPI_ANY_TAG
+    MPI_Message & message,		///< receives the message handle
+    MPI::Status & status )		///< receives the source, tag and size
+{
+    int flag = 0;
+    MPI_Status cStatus;
+    MPI_Improbe ( source, tag, comm, &flag, &message, &cStatus );
+    if ( flag == 0 )
+	return false;
+    status = cStatus;
+    return true;
+}
+
+/// Receive a matched message
+inline void Mrecv (
+    void * const buffer,		///< receives the message
+    int const count,			///< number of elements in buffer
+    MPI::Datatype const & type,		///< element type
+    MPI_Message & message )		///< from Mprobe or Improbe; set to MPI_MESSAGE_NULL
+{
+    MPI_Mrecv ( buffer, count, type, &message, MPI_STATUS_IGNORE );
+}
+
+/// Receive and discard a matched message
+inline void DiscardMatched (
+    MPI_Message & message,		///< from Mprobe or Improbe
+    MPI::Status const & status )	///< status from the probe
+{
+    int const count = status.Get_count( MPI::BYTE );
+    std::vector<char> buffer ( count > 0 ? count : 1 );
+    Mrecv ( buffer.data(), count, MPI::BYTE, message );
+}
+
+
+} // namespace mtbmpi
+
+#endif // INC_mtbmpi_MatchedProbe_h
@@ -38,11 +38,37 @@ namespace mtbmpi {
 	Tag_Configuration,		///< here is config data
 	Tag_StopBlackboard,		///< to blackboard: stop
 	Tag_Confirmation,		///< requesting confirmation
-	Tag_Data,			///< contains data for destination
+	Tag_Data,			///< contains data for destination: size and ID
+	Tag_DataChunk,			///< contains part of the data announced by Tag_Data
+	Tag_WorkItem,			///< to task: next item from the work queue
+	Tag_StateSummary,		///< from sub-controller: batch of task states
+	Tag_RequestWorkItems,		///< from sub-controller: want work items
+	Tag_WorkItems,			///< to sub-controller: batch of work items
+	Tag_ResultBegin,		///< to blackboard: start of a result stream
+	Tag_ResultChunk,		///< to blackboard: part of a result stream
+	Tag_ResultEnd,			///< to blackboard: end of a result stream
+	Tag_ResultCredit,		///< from blackboard: chunks the stream may send
+	Tag_LogBatch,			///< to blackboard: records from a node's shared log
+	Tag_LogFlush,			///< from blackboard: flush the shared log
+	Tag_LogFlushed,			///< to blackboard: shared log is flushed
+	Tag_ResultRecord,		///< to blackboard: result record is in the result window
+	Tag_LogRecord,			///< to blackboard: binary log record
+	Tag_LogMerge,			///< to parent rank: lines of the local log merge
 	Tag_Unknown,
 	Tag_LAST
     };
 
+    /// Phase codes broadcast from the Controller to all tasks
+    /// over the Controller and tasks communicator.
+    enum CollectivePhase
+    {
+	Phase_None = 0,
+	Phase_Initialize,		///< tasks: initialize
+	Phase_Start,			///< tasks: start after initialization
+	Phase_Stop,			///< tasks: stop
+	Phase_Finish			///< last phase; no more broadcasts
+    };
+
     /// Is the message tag valid?
     inline bool IsMsgTagValid ( MsgTags const tag )
     {
@@ -4,6 +4,11 @@
 @brief 		Base class for adapting the task's software output sink to
 		accept output from via Blackboard's message passing mechanism.
 
+		Results sent with a ResultStream arrive in chunks;
+		the derived class can implement DoBeginResult, DoAcceptResultChunk,
+		and DoEndResult to write each chunk as it arrives.
+		The default implementations discard the results.
+
 		A No-Op OutputAdapter is provided for when the OutputMgr is not used.
 @example	../examples/OutputMgrExample.cpp
 @internal
@@ -18,6 +23,8 @@ project		Master-Task-Blackboard MPI Framework
 #ifndef INC_mtbmpi_OutputAdapterBase_h
 #define INC_mtbmpi_OutputAdapterBase_h
 
+#include <cstddef>
+
 namespace mtbmpi {
 
     class OutputMgr;
@@ -37,12 +44,45 @@ namespace mtbmpi {
 
 	virtual ~OutputAdapterBase () = 0;
 
+	/// A result stream started
+	void BeginResult (
+	    int const source,		///< rank of sender
+	    long long const streamID,	///< sender's ID for the result
+	    long long const totalSize)	///< number of bytes, or -1 if not known
+	    { DoBeginResult (source, streamID, totalSize); }
+
+	/// Next chunk of a result stream; the data is valid only during the call
+	void AcceptResultChunk (
+	    int const source,		///< rank of sender
+	    long long const streamID,	///< sender's ID for the result
+	    long long const offset,	///< position of chunk in the result
+	    char const * const data,	///< chunk bytes
+	    std::size_t const size)	///< number of bytes
+	    { DoAcceptResultChunk (source, streamID, offset, data, size); }
+
+	/// A result stream ended; isComplete is false if bytes are missing
+	void EndResult (
+	    int const source,		///< rank of sender
+	    long long const streamID,	///< sender's ID for the result
+	    bool const isComplete)	///< all bytes were received
+	    { DoEndResult (source, streamID, isComplete); }
+
       protected:
 
 	OutputMgr & parent;
 
       private:
 
+	/// Result stream started; derived class can implement this
+	virtual void DoBeginResult ( int const, long long const, long long const ) {}
+
+	/// Accept a chunk of a result stream; derived class can implement this
+	virtual void DoAcceptResultChunk (
+	    int const, long long const, long long const, char const * const, std::size_t const ) {}
+
+	/// Result stream ended; derived class can implement this
+	virtual void DoEndResult ( int const, long long const, bool const ) {}
+
 	/// @cond SKIP_PRIVATE
 
 	// functions that should not be used; are not defined
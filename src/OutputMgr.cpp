@@ -20,13 +20,15 @@ copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
 #include "OutputMgr.h"
 #include "Blackboard.h"
 #include "UtilitiesMPI.h"
+#include "BinaryBuffer.h"
 
 namespace mtbmpi {
 
 
 OutputMgr::OutputMgr (
     OutputFactoryPtr useOutputFactory )
-    : pOutputFactory ( useOutputFactory )
+    : pOutputFactory ( useOutputFactory ),
+      usesDefaultHandler ( false )
 {
     if ( pOutputFactory.get() != nullptr )
 	pOutputAdapter = pOutputFactory->Create( *this );
@@ -39,12 +41,16 @@ OutputMgr::~OutputMgr ()
 }
 
 void OutputMgr::HandleOutputMessage (
-    MPI::Intracomm & comm,		// MPI communicator with message
+    MPI_Message & message,		// MPI message handle from the matched probe
     MPI::Status const & status )	// Status from probe contains source ID and message tag
 {
-    // do a recv so message is marked as received
-    char charBuffer = NULL_CHAR;
-    mtbmpi::comm.Recv ( &charBuffer, 1, MPI::BYTE, status.Get_source(), status.Get_tag() );
+    // receive all of the message, so it is marked as received
+    usesDefaultHandler = true;
+    int const size = ReceiveBytes( message, status, recordBuffer );
+    if ( recordSink )
+	recordSink( status.Get_source(), recordBuffer.data(), size );
+    else
+	HandleOutputRecord( status.Get_source(), status.Get_tag(), recordBuffer.data(), size );
 }
 
 
@@ -6,7 +6,25 @@
 		This is owned by the Blackboard, but is optional.
 		Your application can inherit OutputMgr to provide
 		the actual output functionality of OutputMgr::HandleOutputMessage.
-		@see CommStrings::Receive as an example of retrieving a vector of packed strings.
+		@see CommStrings::Unpack to decode a vector of packed strings.
+
+		The default HandleOutputMessage receives the whole message as bytes,
+		and passes it to HandleOutputRecord; a child class which receives
+		BinaryWriter records only needs to implement HandleOutputRecord.
+		HandleOutputMessage gets the handle of a message matched by
+		MPI_Improbe, so it receives exactly that message with Mrecv;
+		it must receive the message, even to discard it.
+
+		With a Blackboard output writer thread (`--mtbmpi-async-blackboard`),
+		the default HandleOutputMessage receives the message and gives the
+		record to the writer thread, which calls HandleOutputRecord.
+		A child class which implements HandleOutputMessage is still called
+		for each message, by the Blackboard's MPI thread, after the writer
+		thread has written the records before it.
+
+		Results sent with a ResultStream are passed in chunks to
+		HandleResultBegin, HandleResultChunk, and HandleResultEnd,
+		which by default pass them to the OutputAdapter.
 
 		A class derived from OutputAdapterBase is the sink for output;
 		In the child class implementation of HandleOutputMessage,
@@ -29,7 +47,10 @@ project		Master-Task-Blackboard MPI Framework
 #include <mpi.h>
 #include "OutputAdapterBase.h"
 #include "OutputFactoryBase.h"
+#include "MatchedProbe.h"
+#include <functional>
 #include <memory>
+#include <vector>
 #include <stdexcept>
 
 namespace mtbmpi {
@@ -40,6 +61,8 @@ namespace mtbmpi {
 
 	typedef std::shared_ptr<OutputAdapterBase>	OutputAdapterPtr;
 	typedef std::shared_ptr<OutputFactoryBase>	OutputFactoryPtr;
+	typedef std::function<void (int const source, char const * const data, std::size_t const size)>
+							RecordSink;
 
 	/// Constructor
 	OutputMgr (
@@ -47,15 +70,63 @@ namespace mtbmpi {
 	  );	// here for doxygen bug
 
 	/// Handle the output MPI message. Child class will implement.
+	/// The message is matched; receive it with Mrecv (see MatchedProbe.h).
+	/// The default receives the message as bytes and calls HandleOutputRecord.
 	virtual void HandleOutputMessage (
-	    MPI::Intracomm & comm,		///< MPI communicator with message
+	    MPI_Message & message,		///< MPI message handle from the matched probe
 	    MPI::Status const & status );	///< Status from probe contains source ID and message tag
 
+	/// Handle a received binary record; use BinaryReader to decode it.
+	/// The data is valid only until the function returns.
+	virtual void HandleOutputRecord (
+	    int const source,			///< rank of sender
+	    int const tag,			///< message tag
+	    char const * const data,		///< message bytes
+	    int const size )			///< number of bytes
+	{
+	}
+
+	/// Result stream started; default passes it to the OutputAdapter
+	virtual void HandleResultBegin (
+	    int const source,			///< rank of sender
+	    long long const streamID,		///< sender's ID for the result
+	    long long const totalSize )		///< number of bytes, or -1 if not known
+	{
+	    pOutputAdapter->BeginResult( source, streamID, totalSize );
+	}
+
+	/// Chunk of a result stream; default passes it to the OutputAdapter
+	virtual void HandleResultChunk (
+	    int const source,			///< rank of sender
+	    long long const streamID,		///< sender's ID for the result
+	    long long const offset,		///< position of chunk in the result
+	    char const * const data,		///< chunk bytes
+	    std::size_t const size )		///< number of bytes
+	{
+	    pOutputAdapter->AcceptResultChunk( source, streamID, offset, data, size );
+	}
+
+	/// Result stream ended; default passes it to the OutputAdapter
+	virtual void HandleResultEnd (
+	    int const source,			///< rank of sender
+	    long long const streamID,		///< sender's ID for the result
+	    bool const isComplete )		///< all bytes were received
+	{
+	    pOutputAdapter->EndResult( source, streamID, isComplete );
+	}
+
 	OutputFactoryPtr GetOutputFactory ()
 	{
 	    return pOutputFactory;
 	}
 
+	/// Used by the Blackboard: the default HandleOutputMessage gives
+	/// the records to the sink instead of HandleOutputRecord; empty = none.
+	void SetRecordSink ( RecordSink useSink ) { recordSink = useSink; }
+
+	/// true after the default HandleOutputMessage has received a message
+	bool UsesDefaultMessageHandler () const { return usesDefaultHandler; }
+
 	virtual ~OutputMgr ();
 
       protected:
@@ -67,6 +138,10 @@ namespace mtbmpi {
 
 	/// @cond SKIP_PRIVATE
 
+	std::vector<char> recordBuffer;		// reused by HandleOutputMessage
+	RecordSink recordSink;			// output writer of the Blackboard
+	bool usesDefaultHandler;		// HandleOutputMessage is not overridden
+
 	// functions that should not be used; are not defined
 	OutputMgr (OutputMgr const & object);
 	OutputMgr & operator= (OutputMgr const & object);
@@ -0,0 +1,142 @@
+/*------------------------------------------------------------------------------------------------------------
+file		ParallelLog.cpp
+class		mtbmpi::ParallelLog
+brief 		Log file which every rank writes directly with MPI-IO.
+details
+		File errors are returned, not raised, by MPI's default file
+		error handler, so each result is checked.
+		A write larger than INT_MAX bytes is split.
+
+project		Master-Task-Blackboard MPI Framework
+author		Thomas E. Hilinski <https://github.com/tehilinski>
+copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#include "ParallelLog.h"
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+
+namespace mtbmpi {
+
+
+std::size_t const ParallelLog::defaultBufferSize;
+ParallelLog * ParallelLog::pActive = nullptr;
+
+
+ParallelLog::ParallelLog (
+    MPI::Intracomm & useComm,
+    std::string const & useFileName,
+    std::size_t const useBufferSize,
+    int const maxAgeMilliseconds)
+    : fileName ( useFileName ),
+      file ( MPI_FILE_NULL ),
+      bufferSize ( std::max<std::size_t>( useBufferSize, 256 ) ),
+      maxAge ( std::chrono::milliseconds( std::max( 0, maxAgeMilliseconds ) ) ),
+      numWrites ( 0 )
+{
+    Check ( MPI_File_open ( useComm, const_cast<char *>( fileName.c_str() ),
+			    MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file ),
+	    "MPI_File_open" );
+    Check ( MPI_File_set_size ( file, 0 ), "MPI_File_set_size" );	// truncate
+    buffer.reserve( bufferSize + 1024 );
+    pActive = this;
+}
+
+ParallelLog::~ParallelLog ()
+{
+    if ( pActive == this )
+	pActive = nullptr;
+    if ( file == MPI_FILE_NULL || !MPI::Is_initialized() || MPI::Is_finalized() )
+	return;
+    try
+    {
+	Flush ();
+    }
+    catch ( std::exception const & )
+    {
+	// the file is closed anyway; all ranks must call close
+    }
+    MPI_File_close ( &file );
+}
+
+void ParallelLog::Append (
+    std::string const & line,
+    bool const isError)
+{
+    if ( buffer.empty() )
+	firstAppend = Clock::now();
+    buffer += line;
+    buffer += '\n';
+    if ( isError || buffer.size() >= bufferSize )
+	Flush ();
+    else
+	FlushIfDue ();
+}
+
+void ParallelLog::Write (
+    char const * const data,
+    std::size_t const size)
+{
+    WriteShared ( data, size );
+}
+
+void ParallelLog::FlushIfDue ()
+{
+    if ( !buffer.empty() && Clock::now() - firstAppend >= maxAge )
+	Flush ();
+}
+
+void ParallelLog::Flush ()
+{
+    if ( buffer.empty() )
+	return;
+    WriteShared ( buffer.data(), buffer.size() );
+    buffer.clear();
+}
+
+/// @cond SKIP_PRIVATE
+
+void ParallelLog::WriteShared (
+    char const * const data,
+    std::size_t const size)
+{
+    std::size_t written = 0;
+    while ( written < size )
+    {
+	int const count = static_cast<int>(
+	    std::min<std::size_t>( size - written, static_cast<std::size_t>( INT_MAX ) ) );
+	MPI_Status status;
+	Check ( MPI_File_write_shared ( file, const_cast<char *>( data + written ),
+					count, MPI_CHAR, &status ),
+		"MPI_File_write_shared" );
+	written += count;
+	++numWrites;
+    }
+}
+
+void ParallelLog::Check (
+    int const result,
+    char const * const origin) const
+{
+    if ( result == MPI_SUCCESS )
+	return;
+    char text[MPI_MAX_ERROR_STRING];
+    int length = 0;
+    MPI_Error_string ( result, text, &length );
+    std::string msg = "ParallelLog: ";
+    msg += origin;
+    msg += " failed for the file ";
+    msg += fileName;
+    msg += ": ";
+    msg.append( text, length );
+    throw std::runtime_error( msg );
+}
+
+/// @endcond
+
+
+} // namespace mtbmpi
@@ -0,0 +1,120 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		ParallelLog.h
+@class		mtbmpi::ParallelLog
+@brief 		Log file which every rank writes directly with MPI-IO.
+@details
+		Used when the option `--mtbmpi-log-mpiio[=BYTES]` is given.
+
+		All ranks open the log file together with MPI_File_open.
+		LoggerMPI appends each formatted message to this rank's buffer
+		instead of sending it to the Blackboard, so the Blackboard is not
+		in the path of the log messages. A buffer of whole lines is written
+		with MPI_File_write_shared, which appends it at the file's
+		shared file pointer, when it reaches BYTES (default 64 KB),
+		when its oldest line is older than `--mtbmpi-log-batch-age`
+		(default 250 ms), after an error message, and when a task stops.
+		The Blackboard's RunLogMgr writes the Blackboard's own lines
+		to the same file.
+
+		Lines from one buffer stay together, so a line is never split,
+		but the lines of different ranks are in the order of their writes,
+		not in the order of their timestamps.
+		MPI_File_write_shared is independent, not collective,
+		so each rank writes when it needs to; the framework's ranks
+		do not share flush points other than the end of the run.
+
+		The file is text; a rotated or binary log is not available.
+		Construction and destruction are collective over the communicator.
+		The class is not thread-safe, as LoggerMPI is not.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_ParallelLog_h
+#define INC_mtbmpi_ParallelLog_h
+
+#include "mpi.h"
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace mtbmpi {
+
+
+class ParallelLog
+{
+  public:
+
+    static std::size_t const defaultBufferSize = 64 * 1024;	///< bytes
+
+    /// Constructor; collective over useComm. Creates or truncates the file.
+    ParallelLog (
+      MPI::Intracomm & useComm,		///< communicator of all ranks
+      std::string const & fileName,	///< same on all ranks
+      std::size_t const bufferSize,	///< write the buffer at this size
+      int const maxAgeMilliseconds );	///< write the buffer at this age
+
+    /// Destructor; writes the remaining lines and closes the file.
+    /// Collective over the communicator.
+    ~ParallelLog ();
+
+    /// The parallel log of this process, or null if not used
+    static ParallelLog * GetActive () { return pActive; }
+
+    /// Append a line to the buffer; writes the buffer if it is full or old,
+    /// or if the line is an error.
+    void Append (
+      std::string const & line,		///< formatted message, without the newline
+      bool const isError );		///< write the buffer now
+
+    /// Write a block of whole lines at once, such as the Blackboard's buffer
+    void Write (
+      char const * const data,		///< lines, each ending with a newline
+      std::size_t const size );		///< bytes in data
+
+    /// Write the buffer if it is older than the maximum age
+    void FlushIfDue ();
+
+    /// Write the buffer
+    void Flush ();
+
+    /// Get the name of the log file
+    std::string const & GetFileName () const { return fileName; }
+
+    unsigned long long GetNumWrites () const { return numWrites; }	///< writes to the file
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    typedef std::chrono::steady_clock		Clock;
+
+    static ParallelLog * pActive;
+
+    std::string const fileName;
+    MPI_File file;
+    std::size_t const bufferSize;
+    Clock::duration const maxAge;
+    std::string buffer;			// whole lines
+    Clock::time_point firstAppend;	// oldest line in the buffer
+    unsigned long long numWrites;
+
+    void WriteShared ( char const * const data, std::size_t const size );
+    void Check ( int const result, char const * const origin ) const;
+
+    // functions that should not be used; are not defined
+    ParallelLog (ParallelLog const & object);
+    ParallelLog & operator= (ParallelLog const & object);
+
+    /// @endcond
+};
+
+
+} // namespace mtbmpi
+
+#endif // INC_mtbmpi_ParallelLog_h
@@ -0,0 +1,78 @@
+/*------------------------------------------------------------------------------------------------------------
+file		PersistentMsg.cpp
+class		mtbmpi::PersistentReceive
+brief 		Persistent MPI requests for small control messages of a fixed size.
+details
+		The ring of receives is tested only at its oldest receive, which
+		matched the oldest message; restarting it moves it to the end of the ring.
+
+project		Master-Task-Blackboard MPI Framework
+author		Thomas E. Hilinski <https://github.com/tehilinski>
+copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#include "PersistentMsg.h"
+#include "ErrorHandling.h"
+#include <algorithm>
+
+namespace mtbmpi {
+
+
+PersistentReceive::PersistentReceive (
+    MPI::Intracomm & comm,
+    MsgTags const tag,
+    int const useCount,
+    int const depth)
+    : count ( useCount ),
+      buffers ( std::max( depth, 1 ) * useCount, 0 ),
+      requests ( std::max( depth, 1 ) ),
+      next ( 0 )
+{
+    for ( std::vector<MPI::Prequest>::size_type i = 0; i < requests.size(); ++i )
+    {
+	requests[i] = comm.Recv_init (
+		&buffers[i * count], count, MPI::INT, MPI_ANY_SOURCE, tag );
+	requests[i].Start();
+    }
+    CheckErrorMPI( "PersistentReceive" );
+}
+
+PersistentReceive::~PersistentReceive ()
+{
+    if ( !MPI::Is_finalized() )
+	Close ();
+}
+
+bool PersistentReceive::Receive (
+    int * const values,
+    int & source)
+{
+    if ( requests.empty() )
+	return false;
+    MPI::Status status;
+    if ( !requests[next].Test( status ) )
+	return false;
+    int const * const buffer = &buffers[next * count];
+    std::copy( buffer, buffer + count, values );
+    source = status.Get_source();
+    requests[next].Start();
+    next = ( next + 1 ) % requests.size();
+    return true;
+}
+
+void PersistentReceive::Close ()
+{
+    for ( std::vector<MPI::Prequest>::iterator i = requests.begin(); i != requests.end(); ++i )
+    {
+	i->Cancel();
+	i->Wait();
+	i->Free();
+    }
+    requests.clear();
+}
+
+
+} // namespace mtbmpi
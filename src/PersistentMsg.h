@@ -0,0 +1,85 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		PersistentMsg.h
+@class		mtbmpi::PersistentReceive
+@brief 		Persistent MPI requests for small control messages of a fixed size.
+@details
+		A control message which is received many times with the same tag
+		and the same number of ints, such as a task's Tag_State report,
+		can reuse persistent requests (MPI_Recv_init) instead of
+		creating a request for each message.
+
+		PersistentReceive keeps a ring of pre-posted receives for
+		one tag from any source. Messages match the receives in the
+		order they were posted, so the ring returns messages in the order
+		in which they arrived, and messages from one source stay in order.
+		Each received request is restarted immediately.
+		Call Close before MPI_Finalize; it cancels the pending receives.
+
+		The Controller receives Tag_State with a PersistentReceive.
+		Tasks send Tag_State with a blocking Send: for a message of
+		a few ints, Open MPI's blocking send is faster than starting and
+		waiting for a persistent send (see tests/Bench_PersistentMsg.cpp).
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_PersistentMsg_h
+#define INC_mtbmpi_PersistentMsg_h
+
+#include "mpi.h"
+#include "MsgTags.h"
+#include <vector>
+
+namespace mtbmpi {
+
+
+class PersistentReceive
+{
+  public:
+
+    /// Constructor; creates and starts the ring of receives
+    PersistentReceive (
+      MPI::Intracomm & comm,		///< communicator
+      MsgTags const tag,		///< message tag
+      int const count,			///< number of ints in each message
+      int const depth );		///< number of pre-posted receives
+
+    /// Destructor; calls Close if MPI is not finalized
+    ~PersistentReceive ();
+
+    /// Get the oldest received message without waiting.
+    /// Returns false if no message has arrived.
+    bool Receive (
+      int * const values,		///< receives count values
+      int & source );			///< rank which sent the message
+
+    /// Cancel the pending receives and free the requests
+    void Close ();
+
+    int GetCount () const { return count; }
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    int const count;			// ints per message
+    std::vector<int> buffers;		// depth * count
+    std::vector<MPI::Prequest> requests;
+    std::vector<MPI::Prequest>::size_type next;	// oldest posted receive
+
+    // functions that should not be used; are not defined
+    PersistentReceive (PersistentReceive const & object);
+    PersistentReceive & operator= (PersistentReceive const & object);
+
+    /// @endcond
+};
+
+
+} // namespace mtbmpi
+
+#endif // INC_mtbmpi_PersistentMsg_h
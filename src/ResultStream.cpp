@@ -0,0 +1,153 @@
+/*------------------------------------------------------------------------------------------------------------
+file		ResultStream.cpp
+class		mtbmpi::ResultStream
+brief 		Sends a large task result to the Blackboard as a stream of chunks.
+details
+		Messages to the Blackboard:
+		  Tag_ResultBegin: long long [ stream ID, total size, requested chunk size ]
+		  Tag_ResultChunk: bytes; at most the granted chunk size
+		  Tag_ResultEnd:   long long [ bytes sent ]
+		Messages from the Blackboard:
+		  Tag_ResultCredit: int [ credits, chunk size ]
+		  After Tag_ResultEnd, the Blackboard replies with zero credits.
+		  A chunk without a stream is answered with one credit.
+		The Blackboard keys the streams by the source rank, so Begin
+		refuses a second open stream in the same process.
+
+project		Master-Task-Blackboard MPI Framework
+author		Thomas E. Hilinski <https://github.com/tehilinski>
+copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#include "ResultStream.h"
+#include "MsgTags.h"
+#include "ErrorHandling.h"
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+namespace mtbmpi {
+
+
+namespace {
+
+    // the Blackboard keys the streams, and their credits, by the source rank
+    std::atomic<bool> processHasOpenStream ( false );
+
+} // namespace
+
+
+ResultStream::~ResultStream ()
+{
+    if ( isOpen )
+    {
+	try { End(); }
+	catch (...) {}
+    }
+}
+
+void ResultStream::Begin (
+    long long const streamID,
+    long long const totalSize,
+    int const requestedChunkSize)
+{
+    CheckNotHostedTaskThread( "ResultStream::Begin" );
+    if ( isOpen )
+	throw std::runtime_error( "ResultStream::Begin: stream is already open." );
+    if ( processHasOpenStream.exchange( true ) )
+	throw std::runtime_error(
+	    "ResultStream::Begin: another stream of this process is open;"
+	    " a process has one open stream at a time." );
+
+    long long const header[3] = { streamID, totalSize, requestedChunkSize };
+    comm.Send ( header, 3, MPI::LONG_LONG, idBlackboard, Tag_ResultBegin );
+    CheckErrorMPI( "ResultStream::Begin" );
+    isOpen = true;
+    bytesSent = 0;
+    credits = ReceiveCredit();
+    chunk.clear();
+    chunk.reserve( chunkSize );
+}
+
+void ResultStream::Write (
+    char const * const data,
+    std::size_t const size)
+{
+    if ( !isOpen )
+	throw std::runtime_error( "ResultStream::Write: stream is not open." );
+
+    char const * next = data;
+    std::size_t remaining = size;
+    // fill the partial chunk first
+    if ( !chunk.empty() )
+    {
+	std::size_t const n = std::min( remaining, static_cast<std::size_t>( chunkSize ) - chunk.size() );
+	chunk.insert( chunk.end(), next, next + n );
+	next += n;
+	remaining -= n;
+	if ( static_cast<int>( chunk.size() ) == chunkSize )
+	{
+	    SendChunk( chunk.data(), chunkSize );
+	    chunk.clear();
+	}
+    }
+    // full chunks are sent from the caller's data without copying
+    while ( remaining >= static_cast<std::size_t>( chunkSize ) )
+    {
+	SendChunk( next, chunkSize );
+	next += chunkSize;
+	remaining -= chunkSize;
+    }
+    chunk.insert( chunk.end(), next, next + remaining );
+}
+
+void ResultStream::End ()
+{
+    if ( !isOpen )
+	return;
+    if ( !chunk.empty() )
+    {
+	SendChunk( chunk.data(), static_cast<int>( chunk.size() ) );
+	chunk.clear();
+    }
+    isOpen = false;
+    comm.Send ( &bytesSent, 1, MPI::LONG_LONG, idBlackboard, Tag_ResultEnd );
+    CheckErrorMPI( "ResultStream::End" );
+
+    // credits granted before the end are received first
+    while ( ReceiveCredit() > 0 )
+	;
+    processHasOpenStream = false;
+}
+
+/// @cond SKIP_PRIVATE
+
+void ResultStream::SendChunk (
+    char const * const data,
+    int const size)
+{
+    while ( credits == 0 )
+	credits += ReceiveCredit();
+    comm.Send ( data, size, MPI::BYTE, idBlackboard, Tag_ResultChunk );
+    CheckErrorMPI( "ResultStream::SendChunk" );
+    --credits;
+    bytesSent += size;
+}
+
+int ResultStream::ReceiveCredit ()
+{
+    int grant[2] = { 0, 0 };
+    comm.Recv ( grant, 2, MPI::INT, idBlackboard, Tag_ResultCredit );
+    CheckErrorMPI( "ResultStream::ReceiveCredit" );
+    if ( grant[1] > 0 )
+	chunkSize = grant[1];
+    return grant[0];
+}
+
+/// @endcond
+
+
+} // namespace mtbmpi
@@ -0,0 +1,110 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		ResultStream.h
+@class		mtbmpi::ResultStream
+@brief 		Sends a large task result to the Blackboard as a stream of chunks.
+@details
+		A result of any size is sent as Tag_ResultBegin, a series of
+		Tag_ResultChunk messages, and Tag_ResultEnd.
+		The Blackboard passes each chunk to the OutputMgr as it arrives,
+		so neither process holds the whole result in memory.
+
+		Flow control is by credits: the Blackboard grants the stream a number
+		of chunks it may send, and grants more as it consumes them.
+		Write blocks while the stream has no credit.
+		The Blackboard also sets the chunk size; see the options
+		`--mtbmpi-result-chunk-size=BYTES` and `--mtbmpi-result-credits=N`.
+@code
+		mtbmpi::ResultStream stream ( mtbmpi::resultComm, GetParent().GetBlackboardID() );
+		stream.Begin( resultID, totalBytes );
+		for ( ... )
+		    stream.Write( data, size );
+		stream.End();
+@endcode
+		A process has one open stream at a time, as the Blackboard keeps
+		one stream, and its credits, for each rank: Begin throws
+		if another ResultStream of the process is open.
+		A task run by a TaskHost cannot use a stream: Begin throws.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_ResultStream_h
+#define INC_mtbmpi_ResultStream_h
+
+#include "mpi.h"
+#include <vector>
+#include <cstddef>
+
+namespace mtbmpi {
+
+
+class ResultStream
+{
+  public:
+
+    /// Constructor
+    ResultStream (
+      MPI::Intracomm & useComm,		///< communicator with the Blackboard
+      int const blackboardID )		///< Blackboard rank
+      : comm ( useComm ),
+	idBlackboard ( blackboardID ),
+	isOpen ( false ),
+	credits ( 0 ),
+	chunkSize ( 0 ),
+	bytesSent ( 0 )
+      {
+      }
+
+    /// Ends the stream if it is open
+    ~ResultStream ();
+
+    /// Start a stream; blocks until the Blackboard grants credit
+    void Begin (
+      long long const streamID,		///< application's ID for the result
+      long long const totalSize = -1,	///< number of bytes, or -1 if not known
+      int const requestedChunkSize = 0 );	///< chunk size; 0 = Blackboard's maximum
+
+    /// Append data to the stream; sends each full chunk
+    void Write (
+      char const * const data,		///< bytes to send
+      std::size_t const size );		///< number of bytes
+
+    /// Send any partial chunk and end the stream;
+    /// blocks until the Blackboard has consumed all chunks.
+    void End ();
+
+    bool IsOpen () const { return isOpen; }			///< true between Begin and End
+    int GetChunkSize () const { return chunkSize; }		///< chunk size granted by Blackboard
+    long long GetBytesSent () const { return bytesSent; }	///< bytes sent in this stream
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    MPI::Intracomm & comm;
+    int const idBlackboard;
+    bool isOpen;
+    int credits;			// chunks which may be sent
+    int chunkSize;			// granted by Blackboard
+    long long bytesSent;		// in chunks already sent
+    std::vector<char> chunk;		// partial chunk
+
+    void SendChunk ( char const * const data, int const size );
+    int ReceiveCredit ();		// returns credits granted
+
+    // functions that should not be used; are not defined
+    ResultStream (ResultStream const & object);
+    ResultStream & operator= (ResultStream const & object);
+
+    /// @endcond
+};
+
+
+} // namespace mtbmpi
+
+#endif // INC_mtbmpi_ResultStream_h
@@ -0,0 +1,193 @@
+/*------------------------------------------------------------------------------------------------------------
+file		ResultWindow.cpp
+class		mtbmpi::ResultWindow
+brief 		One-sided RMA window in the Blackboard for task result records.
+details
+		Window layout in the Blackboard:
+		  uint64 reserved	bytes reserved by tasks; only increases
+		  uint64 consumed	bytes consumed by the Blackboard; only increases
+		  ring			capacity bytes
+		A record's position is its reserved count; the ring offset is
+		the position modulo the capacity, and a record may wrap the end.
+		Records are consumed out of order, so the consumed counter
+		advances only over a contiguous range of consumed records.
+		All ranks hold a passive-target lock_all epoch for the window's lifetime.
+
+		Tag_ResultRecord notice: long long [ position, size ]
+
+project		Master-Task-Blackboard MPI Framework
+author		Thomas E. Hilinski <https://github.com/tehilinski>
+copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#include "ResultWindow.h"
+#include "MsgTags.h"
+#include "TrafficComms.h"
+#include "ErrorHandling.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace mtbmpi {
+
+
+namespace {
+
+    MPI_Aint const dispReserved = 0;
+    MPI_Aint const dispConsumed = sizeof(std::uint64_t);
+    MPI_Aint const dispRing     = 2 * sizeof(std::uint64_t);
+
+} // namespace
+
+
+std::size_t const ResultWindow::defaultCapacity;
+ResultWindow * ResultWindow::pActive = nullptr;
+
+
+ResultWindow::ResultWindow (
+    MPI::Intracomm & useComm,
+    int const blackboardID,
+    std::size_t const useCapacity)
+    : comm ( useComm ),
+      idBlackboard ( blackboardID ),
+      capacity ( useCapacity ),
+      isOwner ( useComm.Get_rank() == blackboardID ),
+      window ( MPI_WIN_NULL ),
+      base ( nullptr ),
+      consumed ( 0 )
+{
+    MPI_Aint const size = ( isOwner ? dispRing + capacity : 0 );
+    int const result = MPI_Win_allocate (
+	    size, 1, MPI_INFO_NULL, comm, &base, &window );
+    if ( result != MPI_SUCCESS )
+	throw std::runtime_error( "ResultWindow: MPI_Win_allocate failed." );
+    if ( isOwner )
+    {
+	std::uint64_t const zero[2] = { 0, 0 };
+	std::memcpy( base, zero, sizeof(zero) );
+    }
+    MPI_Win_lock_all ( 0, window );
+    MPI_Win_sync ( window );
+    comm.Barrier();			// counters are initialized
+    pActive = this;
+}
+
+ResultWindow::~ResultWindow ()
+{
+    pActive = nullptr;
+    MPI_Win_unlock_all ( window );
+    MPI_Win_free ( &window );
+}
+
+bool ResultWindow::Put (
+    char const * const data,
+    std::size_t const size)
+{
+    if ( isOwner || size == 0 || size > capacity )
+	return false;
+
+    // reserve
+    std::uint64_t const increment = size;
+    std::uint64_t position = 0;
+    MPI_Fetch_and_op ( &increment, &position, MPI_UINT64_T,
+		       idBlackboard, dispReserved, MPI_SUM, window );
+    MPI_Win_flush ( idBlackboard, window );
+
+    // wait for the Blackboard to consume earlier records, if the ring is full
+    std::uint64_t const unused = 0;
+    std::uint64_t consumedNow = 0;
+    while ( true )
+    {
+	MPI_Fetch_and_op ( &unused, &consumedNow, MPI_UINT64_T,
+			   idBlackboard, dispConsumed, MPI_NO_OP, window );
+	MPI_Win_flush ( idBlackboard, window );
+	if ( position + size - consumedNow <= capacity )
+	    break;
+	std::this_thread::yield();
+    }
+
+    PutBytes( position, data, size );
+    MPI_Win_flush ( idBlackboard, window );
+
+    long long const notice[2] = {
+	static_cast<long long>( position ), static_cast<long long>( size ) };
+    comm.Send ( notice, 2, MPI::LONG_LONG, idBlackboard, Tag_ResultRecord );
+    CheckErrorMPI( "ResultWindow::Put" );
+    return true;
+}
+
+char const * ResultWindow::GetRecord (
+    std::uint64_t const position,
+    std::size_t const size)
+{
+    MPI_Win_sync ( window );		// see the tasks' puts
+    char const * const ring = base + dispRing;
+    std::size_t const offset = position % capacity;
+    if ( offset + size <= capacity )
+	return ring + offset;
+    // wraps the end of the ring
+    std::size_t const first = capacity - offset;
+    wrapped.resize( size );
+    std::memcpy( wrapped.data(), ring + offset, first );
+    std::memcpy( wrapped.data() + first, ring, size - first );
+    return wrapped.data();
+}
+
+void ResultWindow::Consume (
+    std::uint64_t const position,
+    std::size_t const size)
+{
+    done[position] = size;
+    std::uint64_t const previous = consumed;
+    std::map<std::uint64_t, std::uint64_t>::iterator i = done.begin();
+    while ( i != done.end() && i->first == consumed )
+    {
+	consumed += i->second;
+	i = done.erase( i );
+    }
+    if ( consumed != previous )
+    {
+	MPI_Accumulate ( &consumed, 1, MPI_UINT64_T, idBlackboard, dispConsumed,
+			 1, MPI_UINT64_T, MPI_REPLACE, window );
+	MPI_Win_flush ( idBlackboard, window );
+    }
+}
+
+/// @cond SKIP_PRIVATE
+
+void ResultWindow::PutBytes (
+    std::uint64_t const position,
+    char const * const data,
+    std::size_t const size)
+{
+    std::size_t const offset = position % capacity;
+    std::size_t const first = std::min( size, capacity - offset );
+    MPI_Put ( data, static_cast<int>( first ), MPI_BYTE, idBlackboard,
+	      dispRing + offset, static_cast<int>( first ), MPI_BYTE, window );
+    if ( first < size )
+	MPI_Put ( data + first, static_cast<int>( size - first ), MPI_BYTE, idBlackboard,
+		  dispRing, static_cast<int>( size - first ), MPI_BYTE, window );
+}
+
+/// @endcond
+
+void SendResultRecord (
+    char const * const data,
+    std::size_t const size,
+    int const blackboardID)
+{
+    CheckNotHostedTaskThread( "mtbmpi::SendResultRecord" );
+    ResultWindow * const pWindow = ResultWindow::GetActive();
+    if ( pWindow == nullptr || !pWindow->Put( data, size ) )
+    {
+	mtbmpi::resultComm.Send ( data, size, MPI::BYTE, blackboardID, Tag_TaskResults );
+	CheckErrorMPI( "mtbmpi::SendResultRecord" );
+    }
+}
+
+
+} // namespace mtbmpi
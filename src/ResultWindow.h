@@ -0,0 +1,117 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		ResultWindow.h
+@class		mtbmpi::ResultWindow
+@brief 		One-sided RMA window in the Blackboard for task result records.
+@details
+		Used when the option `--mtbmpi-result-window[=BYTES]` is given.
+
+		The Blackboard exposes a window (MPI_Win_allocate) holding a ring
+		of BYTES (default 16 MB) and two counters: bytes reserved and
+		bytes consumed. A task reserves space for a record with
+		MPI_Fetch_and_op on the reserved counter, writes the record with
+		MPI_Put, and then sends the Blackboard a small Tag_ResultRecord
+		notice with the record's position and size.
+		The Blackboard does not receive the record's data as a message;
+		it passes the record from its window to OutputMgr::HandleOutputRecord,
+		and then advances the consumed counter.
+
+		A task waits only if the ring is full of records which the
+		Blackboard has not yet consumed.
+		A record larger than the ring is sent as a Tag_TaskResults message.
+
+		Tasks send records with SendResultRecord, which uses the window
+		if it exists, else sends a message.
+		Construction and destruction are collective over the communicator.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_ResultWindow_h
+#define INC_mtbmpi_ResultWindow_h
+
+#include "mpi.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace mtbmpi {
+
+
+class ResultWindow
+{
+  public:
+
+    static std::size_t const defaultCapacity = 16 * 1024 * 1024;	///< bytes in the ring
+
+    /// Constructor; collective over useComm
+    ResultWindow (
+      MPI::Intracomm & useComm,		///< communicator of all ranks
+      int const blackboardID,		///< Blackboard rank; owns the window memory
+      std::size_t const capacity );	///< bytes in the ring
+
+    /// Destructor; collective over the communicator
+    ~ResultWindow ();
+
+    /// The result window of this process, or null if not used
+    static ResultWindow * GetActive () { return pActive; }
+
+    /// Task: write a record into the window and notify the Blackboard.
+    /// Returns false if the record must be sent as a message.
+    bool Put (
+      char const * const data,		///< record bytes
+      std::size_t const size );		///< number of bytes
+
+    /// Blackboard: get a record announced by Tag_ResultRecord.
+    /// The data is valid until Consume is called.
+    char const * GetRecord (
+      std::uint64_t const position,	///< from the notice
+      std::size_t const size );		///< from the notice
+
+    /// Blackboard: the record's space can be reused
+    void Consume (
+      std::uint64_t const position,	///< from the notice
+      std::size_t const size );		///< from the notice
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    static ResultWindow * pActive;
+
+    MPI::Intracomm & comm;
+    int const idBlackboard;
+    std::size_t const capacity;
+    bool const isOwner;			// Blackboard
+    MPI_Win window;
+    char * base;			// owner: window memory
+    std::uint64_t consumed;		// owner: contiguous bytes consumed
+    std::map<std::uint64_t, std::uint64_t> done;	// owner: consumed after a gap; position, size
+    std::vector<char> wrapped;		// owner: a record which wraps the end of the ring
+
+    void PutBytes ( std::uint64_t const position, char const * const data, std::size_t const size );
+
+    // functions that should not be used; are not defined
+    ResultWindow (ResultWindow const & object);
+    ResultWindow & operator= (ResultWindow const & object);
+
+    /// @endcond
+};
+
+/// Send a task result record to the Blackboard:
+/// through the ResultWindow if it is used, else as a Tag_TaskResults message.
+/// The Blackboard passes the record to OutputMgr::HandleOutputRecord.
+void SendResultRecord (
+    char const * const data,		///< record bytes
+    std::size_t const size,		///< number of bytes
+    int const blackboardID );		///< Blackboard rank
+
+
+} // namespace mtbmpi
+
+#endif // INC_mtbmpi_ResultWindow_h
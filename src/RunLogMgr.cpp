@@ -2,6 +2,13 @@
 file		RunLogMgr.cpp
 class		mtbmpi::RunLogMgr
 brief 		Manages the log file.
+details
+		The file stream has no buffer of its own, so a flush of the
+		RunLogMgr buffer is one write to the file.
+		A binary file's template table is cleared when a file is opened,
+		so each rotated file defines its own templates.
+		With a ParallelLog, a flush is one MPI_File_write_shared.
+
 project		Master-Task-Blackboard MPI Framework
 author		Thomas E. Hilinski <https://github.com/tehilinski>
 copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
@@ -11,25 +18,349 @@ copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
 ------------------------------------------------------------------------------------------------------------*/
 
 #include "RunLogMgr.h"
+#include "ParallelLog.h"
+#include "LogLevel.h"
+#include "timeutil.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
 #include <stdexcept>
 
 namespace mtbmpi {
 
 
+namespace {
+
+    std::size_t const bufferAlignment = 4096;
+    unsigned int const clockCheckLines = 64;	// for Flush_Interval
+    std::size_t const maxTemplates = 1 << 16;	// per binary file
+
+} // namespace
+
+
+std::size_t const RunLogMgr::defaultBufferSize;
+int const RunLogMgr::defaultFlushInterval;
+
+
 RunLogMgr::RunLogMgr (
-    std::string const & logFileName)
-    : fileName (logFileName)
+    std::string const & logFileName,
+    std::size_t const useBufferSize,
+    ParallelLog * const useSharedFile)
+    : firstFileName (logFileName),
+      fileName (logFileName),
+      storage ( std::max<std::size_t>( useBufferSize, 1024 ) + bufferAlignment ),
+      buffer (nullptr),
+      bufferSize ( std::max<std::size_t>( useBufferSize, 1024 ) ),
+      used (0),
+      numLines (0),
+      policy (Flush_Interval),
+      flushInterval ( std::chrono::milliseconds( defaultFlushInterval ) ),
+      lastFlush ( Clock::now() ),
+      maxFileSize (0),
+      maxFileAge ( Clock::duration::zero() ),
+      fileSize (0),
+      sequence (0),
+      binary (false),
+      textRank (-1),
+      pSharedFile (useSharedFile)
+{
+    void * aligned = storage.data();
+    std::size_t space = storage.size();
+    buffer = static_cast<char *>( std::align( bufferAlignment, bufferSize, aligned, space ) );
+    if ( pSharedFile == nullptr )
+	Open ();
+    else
+	fileOpened = Clock::now();
+}
+
+void RunLogMgr::Write ( std::string const & msg )
 {
-    ofs.open ( logFileName.c_str(), std::ios::out | std::ios::trunc );
+    if ( !IsOpen() )
+	return;
+    if ( binary )
+	AppendText ( msg, LogLevel_Info );
+    else
+	Append ( msg );
+    // the clock is read only every clockCheckLines lines
+    if ( policy == Flush_Interval && ( ++numLines % clockCheckLines ) == 0 &&
+	 Clock::now() - lastFlush >= flushInterval )
+	Flush ();
+}
+
+void RunLogMgr::WriteError ( std::string const & msg )
+{
+    if ( !IsOpen() )
+	return;
+    if ( binary )
+	AppendText ( msg, LogLevel_Error );
+    else
+	Append ( msg );
+    if ( policy != Flush_Close )
+	Flush ();
+}
+
+void RunLogMgr::WriteRecord (
+    char const * const record,
+    std::size_t const size)
+{
+    if ( !IsOpen() || size < logRecordHeaderSize )
+	return;
+    LogRecordHeader header;
+    DecodeLogRecordHeader( record, header );
+    std::size_t const payloadSize =
+	std::min<std::size_t>( header.size, size - logRecordHeaderSize );
+    char const * const payload = record + logRecordHeaderSize;
+    if ( binary )
+	AppendMessage ( header, payload, payloadSize );
+    else
+    {
+	FormatLogRecord( header, std::string( payload, payloadSize ), line );
+	Append ( line );
+    }
+    if ( header.level >= LogLevel_Error && policy != Flush_Close )
+	Flush ();
+    else if ( policy == Flush_Interval && ( ++numLines % clockCheckLines ) == 0 &&
+	      Clock::now() - lastFlush >= flushInterval )
+	Flush ();
+}
+
+void RunLogMgr::SetBinary (
+    int const useTextRank)
+{
+    textRank = useTextRank;
+    if ( binary || pSharedFile != nullptr )
+	return;
+    Flush ();
+    bool const isEmpty = ( fileSize == 0 );
+    ofs.close();
+    ofs.clear();
+    if ( isEmpty )
+	std::remove( fileName.c_str() );
+    binary = true;
+    firstFileName = BinaryFileName( firstFileName );
+    fileName = RotatedFileName( firstFileName, sequence );
+    Open ();
+}
+
+void RunLogMgr::Flush ()
+{
+    if ( IsOpen() && used > 0 )
+    {
+	WriteBytes ( buffer, used );
+	used = 0;
+    }
+    lastFlush = Clock::now();
+}
+
+void RunLogMgr::FlushIfDue ()
+{
+    if ( policy == Flush_Interval && used > 0 && Clock::now() - lastFlush >= flushInterval )
+	Flush ();
+}
+
+void RunLogMgr::Close ()
+{
+    if ( IsOpen() )
+    {
+	Flush ();
+	if ( pSharedFile != nullptr )
+	    pSharedFile = nullptr;
+	else
+	    ofs.close();
+    }
+}
+
+void RunLogMgr::SetFlushPolicy (
+    FlushPolicy const newPolicy,
+    int const intervalMilliseconds)
+{
+    policy = newPolicy;
+    flushInterval = std::chrono::milliseconds( std::max( 0, intervalMilliseconds ) );
+}
+
+void RunLogMgr::SetRotation (
+    long long const maxBytes,
+    int const maxSeconds)
+{
+    maxFileSize = std::max( 0LL, maxBytes );
+    maxFileAge = std::chrono::seconds( std::max( 0, maxSeconds ) );
+}
+
+std::string RunLogMgr::BinaryFileName (
+    std::string const & textFileName)
+{
+    std::string::size_type const dot = textFileName.rfind( '.' );
+    std::string::size_type const slash = textFileName.find_last_of( "/\\" );
+    std::string name = textFileName;
+    if ( dot != std::string::npos && dot > 0 &&
+	 ( slash == std::string::npos || dot > slash + 1 ) )
+	name.erase( dot );
+    return name + ".mtblog";
+}
+
+std::string RunLogMgr::RotatedFileName (
+    std::string const & firstFileName,
+    int const sequence)
+{
+    if ( sequence <= 0 )
+	return firstFileName;
+    char number[16];
+    std::snprintf( number, sizeof(number), ".%03d", sequence );
+    // before the extension, if the file name has one
+    std::string::size_type const dot = firstFileName.rfind( '.' );
+    std::string::size_type const slash = firstFileName.find_last_of( "/\\" );
+    std::string name = firstFileName;
+    if ( dot != std::string::npos && dot > 0 &&
+	 ( slash == std::string::npos || dot > slash + 1 ) )
+	name.insert( dot, number );
+    else
+	name += number;
+    return name;
+}
+
+/// @cond SKIP_PRIVATE
+
+void RunLogMgr::Open ()
+{
+    ofs.rdbuf()->pubsetbuf( nullptr, 0 );	// before open; this class buffers
+    ofs.open ( fileName.c_str(), std::ios::out | std::ios::trunc );
     if ( !ofs.is_open() )
     {
 	std::string msg = "Error: could not open the file\n";
-	msg += logFileName;
+	msg += fileName;
 	msg += "\nfor output.";
 	throw std::runtime_error (msg);
     }
+    fileOpened = Clock::now();
+    fileSize = 0;
+    if ( binary )
+    {
+	char header[logFileHeaderSize];
+	EncodeLogFileHeader( header );
+	AppendBytes( header, sizeof(header) );
+	templates.clear();		// each file is decoded alone
+    }
+}
+
+void RunLogMgr::Append ( std::string const & msg )
+{
+    RotateIfNeeded ( msg.size() + 1 );
+    AppendBytes ( msg.data(), msg.size() );
+    AppendBytes ( "\n", 1 );
+}
+
+void RunLogMgr::AppendBytes (
+    char const * const data,
+    std::size_t const size)
+{
+    if ( used + size > bufferSize )
+	Flush ();
+    if ( size > bufferSize )
+	WriteBytes ( data, size );	// longer than the buffer: write it directly
+    else
+    {
+	std::memcpy( buffer + used, data, size );
+	used += size;
+    }
+    fileSize += size;
+}
+
+void RunLogMgr::AppendText (
+    std::string const & msg,
+    int const level)
+{
+    LogRecordHeader header;
+    header.time = TimeStampNanoseconds();
+    header.rank = textRank;
+    header.trackerID = -1;
+    header.templateID = 0;
+    header.size = static_cast<std::uint32_t>( msg.size() );
+    header.level = static_cast<std::uint8_t>( level );
+    header.kind = LogRecord_Text;
+    RotateIfNeeded ( logRecordHeaderSize + msg.size() );
+    char encoded[logRecordHeaderSize];
+    EncodeLogRecordHeader( header, encoded );
+    AppendBytes ( encoded, logRecordHeaderSize );
+    AppendBytes ( msg.data(), msg.size() );
+}
+
+void RunLogMgr::AppendMessage (
+    LogRecordHeader header,
+    char const * const msg,
+    std::size_t const size)
+{
+    // the template, defined in this file before its first use
+    header.templateID = 0;
+    header.kind = LogRecord_Message;
+    char const * payload = msg;
+    std::size_t payloadSize = size;
+    bool const haveTemplate =
+	SplitLogTemplate( std::string( msg, size ), templateText, templateArgs );
+    RotateIfNeeded ( logRecordHeaderSize + ( haveTemplate ? templateArgs.size() : size ) );
+    char encoded[logRecordHeaderSize];
+    if ( haveTemplate )
+    {
+	TemplateMap::const_iterator const found = templates.find( templateText );
+	if ( found != templates.end() )
+	    header.templateID = found->second;
+	else if ( templates.size() < maxTemplates )
+	{
+	    header.templateID = static_cast<std::uint32_t>( templates.size() + 1 );
+	    templates.insert( std::make_pair( templateText, header.templateID ) );
+	    LogRecordHeader definition = header;
+	    definition.kind = LogRecord_Template;
+	    definition.size = static_cast<std::uint32_t>( templateText.size() );
+	    EncodeLogRecordHeader( definition, encoded );
+	    AppendBytes ( encoded, logRecordHeaderSize );
+	    AppendBytes ( templateText.data(), templateText.size() );
+	}
+	if ( header.templateID != 0 )
+	{
+	    payload = templateArgs.data();
+	    payloadSize = templateArgs.size();
+	}
+    }
+    header.size = static_cast<std::uint32_t>( payloadSize );
+    EncodeLogRecordHeader( header, encoded );
+    AppendBytes ( encoded, logRecordHeaderSize );
+    AppendBytes ( payload, payloadSize );
 }
 
+void RunLogMgr::WriteBytes (
+    char const * const data,
+    std::size_t const size)
+{
+    if ( pSharedFile != nullptr )
+	pSharedFile->Write ( data, size );
+    else
+    {
+	ofs.write( data, size );
+	ofs.flush();
+    }
+}
+
+void RunLogMgr::RotateIfNeeded ( std::size_t const lineSize )
+{
+    if ( pSharedFile != nullptr )
+	return;				// the shared file is not rotated
+    if ( fileSize <= ( binary ? static_cast<long long>( logFileHeaderSize ) : 0LL ) )
+	return;				// at least one line per file
+    bool const isFull =
+	maxFileSize > 0 && fileSize + static_cast<long long>( lineSize ) > maxFileSize;
+    bool const isOld =
+	maxFileAge > Clock::duration::zero() && Clock::now() - fileOpened >= maxFileAge;
+    if ( !isFull && !isOld )
+	return;
+    Flush ();
+    ofs.close();
+    ofs.clear();
+    fileName = RotatedFileName( firstFileName, ++sequence );
+    Open ();
+}
+
+/// @endcond
+
 
 } // namespace mtbmpi
@@ -2,6 +2,25 @@
 @file		RunLogMgr.h
 @class		mtbmpi::RunLogMgr
 @brief 		Manages the log file.
+@details
+		Lines are collected in a large buffer which is aligned to a page,
+		and written to the file in one write when the buffer is full,
+		or as the flush policy requires:
+		- Flush_Close: only when the buffer is full, at rotation, and at Close.
+		- Flush_Errors: also after each error line (WriteError).
+		- Flush_Interval: also after each error line, and when a line is
+		  written at least the flush interval after the previous flush.
+		The default is Flush_Interval with an interval of 1 second.
+
+		The log can be rotated when the file reaches a maximum size,
+		or a maximum age, or both. Rotated files are named by inserting
+		a 3-digit sequence number before the file name extension:
+		for example, `run.txt`, then `run.001.txt`, `run.002.txt`, ...
+		A line is never split between files.
+
+		With a ParallelLog (option `--mtbmpi-log-mpiio`), the buffer is
+		written to the shared MPI-IO log file instead of a file of its own;
+		that file is text and is not rotated.
 @internal
 project		Master-Task-Blackboard MPI Framework
 @author		Thomas E. Hilinski <https://github.com/tehilinski>
@@ -14,19 +33,40 @@ project		Master-Task-Blackboard MPI Framework
 #ifndef INC_mtbmpi_RunLogMgr_h
 #define INC_mtbmpi_RunLogMgr_h
 
+#include "LogRecord.h"
 #include <string>
 #include <fstream>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
 
 namespace mtbmpi {
 
 
+class ParallelLog;
+
 class RunLogMgr
 {
   public:
 
+    /// When the buffer is written to the file
+    enum FlushPolicy
+      {
+	Flush_Close,			///< when full, at rotation, and at Close
+	Flush_Errors,			///< also after error lines
+	Flush_Interval			///< also after error lines and every interval
+      };
+
+    static std::size_t const defaultBufferSize = 1 << 20;	///< bytes
+    static int const defaultFlushInterval = 1000;		///< milliseconds
+
     /// Constructor
     RunLogMgr (
-      std::string const & logFileName			///< name of log file
+      std::string const & logFileName,			///< name of log file
+      std::size_t const bufferSize = defaultBufferSize,	///< bytes to collect before writing
+      ParallelLog * const sharedFile = nullptr		///< write to this file instead; not owned
       );	// here for doxygen bug
 
     ~RunLogMgr ()
@@ -35,31 +75,99 @@ class RunLogMgr
       }
 
     /// Is the log file open for writing?
-    bool IsOpen () { return ofs.is_open(); }
+    bool IsOpen () { return ofs.is_open() || pSharedFile != nullptr; }
 
     /// Write a message to the log file.
-    void Write ( std::string const & msg )
-      {
-	if ( ofs.is_open() )
-	  ofs << msg << std::endl;
-      }
+    void Write ( std::string const & msg );
 
-    /// Close the log file.
-    void Close ()
-      {
-	if ( ofs.is_open() )
-	    ofs.close();
-      }
+    /// Write an error message to the log file; flushed unless the policy is Flush_Close.
+    void WriteError ( std::string const & msg );
+
+    /// Write an encoded log record from LoggerMPI; flushed like WriteError
+    /// if it is an error.
+    void WriteRecord (
+      char const * const record,			///< header and payload
+      std::size_t const size );				///< bytes in record
 
-    /// Get the log file name
+    /// Write binary log records from now on, to a file with the extension `.mtblog`.
+    /// If the text file is empty, it is removed. Not used with a ParallelLog.
+    void SetBinary (
+      int const textRank );				///< rank for Write and WriteError records
+
+    /// Is the log file binary?
+    bool IsBinary () const { return binary; }
+
+    /// Write the buffer to the file.
+    void Flush ();
+
+    /// Flush if the policy is Flush_Interval and the interval has passed;
+    /// for a caller which has idle time, such as a writer thread.
+    void FlushIfDue ();
+
+    /// Flush and close the log file.
+    void Close ();
+
+    /// Set the flush policy
+    void SetFlushPolicy (
+      FlushPolicy const newPolicy,			///< when to flush
+      int const intervalMilliseconds = defaultFlushInterval );	///< for Flush_Interval
+
+    /// Rotate the log file at a size or age; zero means no limit
+    void SetRotation (
+      long long const maxBytes,				///< maximum file size
+      int const maxSeconds );				///< maximum file age
+
+    /// Get the name of the current log file
     std::string const & GetFileName () const { return fileName; }
 
+    /// Name of the binary log file for a text log file name
+    static std::string BinaryFileName (
+      std::string const & textFileName );		///< name of the text log file
+
+    /// Name of the rotated file with the sequence number; 0 is the first file
+    static std::string RotatedFileName (
+      std::string const & firstFileName,		///< name of the first log file
+      int const sequence );				///< 1, 2, ...
+
   private:
 
     /// @cond SKIP_PRIVATE
 
-    std::string const fileName;		// name of log file
-    std::ofstream ofs;			// output file stream
+    typedef std::chrono::steady_clock		Clock;
+
+    typedef std::unordered_map<std::string, std::uint32_t>	TemplateMap;
+
+    std::string firstFileName;		// name of first log file
+    std::string fileName;		// name of current log file
+    std::ofstream ofs;			// output file stream; unbuffered
+    std::vector<char> storage;		// holds the aligned buffer
+    char * buffer;			// aligned
+    std::size_t const bufferSize;
+    std::size_t used;			// bytes in buffer
+    unsigned int numLines;		// written; for the interval check
+    FlushPolicy policy;
+    Clock::duration flushInterval;
+    Clock::time_point lastFlush;
+    long long maxFileSize;		// 0 = no limit
+    Clock::duration maxFileAge;		// 0 = no limit
+    Clock::time_point fileOpened;
+    long long fileSize;			// bytes written and buffered
+    int sequence;			// of current file
+    bool binary;			// log records instead of text
+    int textRank;			// rank for binary text records
+    TemplateMap templates;		// binary: defined in the current file
+    std::string templateText;		// reused
+    std::string templateArgs;		// reused
+    std::string line;			// reused
+    ParallelLog * pSharedFile;		// null: write to ofs
+
+    void Open ();
+    void Append ( std::string const & msg );
+    void AppendBytes ( char const * const data, std::size_t const size );
+    void WriteBytes ( char const * const data, std::size_t const size );
+    void AppendText ( std::string const & msg, int const level );
+    void AppendMessage ( LogRecordHeader header, char const * const msg, std::size_t const size );
+    void RotateIfNeeded ( std::size_t const lineSize );
 
     // functions that should not be used; are not defined
     RunLogMgr (RunLogMgr const & object);
@@ -17,14 +17,11 @@ project		Master-Task-Blackboard MPI Framework
 #include "mpi.h"
 #include "TaskID.h"
 #include "LoggerMPI.h"
+#include "TrafficComms.h"
 
 namespace mtbmpi {
 
 
-// global communicator for tasks
-extern MPI::Intracomm comm;
-
-
 class SendsMsgsToLog : public TaskID
 {
   public:
@@ -59,6 +56,7 @@ class SendsMsgsToLog : public TaskID
       IDNum const blackboardID )		///< blackboard rank
       {
 	  SetID( myID );
+	  idBlackboard.SetID( blackboardID );
 	  logger.SetBbID( blackboardID );
       }
 
@@ -0,0 +1,272 @@
+/*------------------------------------------------------------------------------------------------------------
+file		SharedLog.cpp
+class		mtbmpi::SharedLog
+brief 		Node-local shared-memory path for log messages and result records.
+details
+		Each rank's ring is a single-producer, single-consumer byte queue.
+		head and tail are byte counts which only increase;
+		the position in the ring is the count modulo the ring size.
+		A record in the ring is:
+		  uint32 size, int32 tag, bytes, padding to a multiple of 8.
+		A size of wrapMarker means the record continues at the start of the ring.
+
+		A Tag_LogBatch message is a series of BinaryWriter records:
+		  int source rank, int tag, uint32 size, bytes.
+
+project		Master-Task-Blackboard MPI Framework
+author		Thomas E. Hilinski <https://github.com/tehilinski>
+copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#include "SharedLog.h"
+#include "TrafficComms.h"
+#include "ErrorHandling.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace mtbmpi {
+
+
+namespace {
+
+    std::uint32_t const wrapMarker = 0xFFFFFFFFu;
+    std::size_t const recordHeaderSize = 8;		// size, tag
+    std::size_t const maxBatchSize = 256 * 1024;	// send the batch at this size
+
+    inline std::size_t PaddedSize ( std::size_t const size )
+    {
+	return ( size + 7 ) & ~static_cast<std::size_t>( 7 );
+    }
+
+} // namespace
+
+
+std::size_t const SharedLog::defaultRingSize;
+SharedLog * SharedLog::pActive = nullptr;
+
+
+SharedLog::SharedLog (
+    MPI::Intracomm & useComm,
+    int const blackboardID,
+    std::size_t const useRingSize)
+    : comm ( useComm ),
+      idBlackboard ( blackboardID ),
+      ringSize ( ( std::max<std::size_t>( useRingSize, 1024 ) + 63 ) & ~static_cast<std::size_t>( 63 ) ),
+      nodeComm ( MPI_COMM_NULL ),
+      window ( MPI_WIN_NULL ),
+      isForwarder ( false ),
+      stopForwarder ( false )
+{
+    controlComm = comm.Dup();
+    MPI_Comm_split_type ( comm, MPI_COMM_TYPE_SHARED, comm.Get_rank(), MPI_INFO_NULL, &nodeComm );
+    int nodeRank = 0;
+    int nodeSize = 0;
+    MPI_Comm_rank ( nodeComm, &nodeRank );
+    MPI_Comm_size ( nodeComm, &nodeSize );
+    isForwarder = ( nodeRank == 0 );
+
+    // my segment of the node's window: header, then ring;
+    // sizes are multiples of 64, so each rank's header is aligned
+    MPI_Aint const segmentSize = sizeof(RingHeader) + ringSize;
+    void * base = nullptr;
+    int result = MPI_Win_allocate_shared (
+	    segmentSize, 1, MPI_INFO_NULL, nodeComm, &base, &window );
+    if ( result != MPI_SUCCESS )
+	throw std::runtime_error( "SharedLog: MPI_Win_allocate_shared failed." );
+    MPI_Win_lock_all ( MPI_MODE_NOCHECK, window );
+    myRing.header = new (base) RingHeader();
+    myRing.header->head.store( 0 );
+    myRing.header->tail.store( 0 );
+    myRing.header->closed.store( 0 );
+    myRing.data = static_cast<char *>( base ) + sizeof(RingHeader);
+    myRing.rank = comm.Get_rank();
+    MPI_Win_sync ( window );
+    MPI_Barrier ( nodeComm );
+
+    // which ranks have a forwarder
+    int const iAmForwarder = ( isForwarder ? 1 : 0 );
+    std::vector<int> isForwarderRank ( comm.Get_size(), 0 );
+    comm.Allgather ( &iAmForwarder, 1, MPI::INT, isForwarderRank.data(), 1, MPI::INT );
+    for ( int rank = 0; rank < static_cast<int>( isForwarderRank.size() ); ++rank )
+	if ( isForwarderRank[rank] )
+	    forwarderIDs.push_back( rank );
+
+    if ( isForwarder )
+    {
+	// the forwarder needs the global rank of each ring's owner
+	std::vector<int> nodeRanks ( nodeSize );
+	MPI_Gather ( &myRing.rank, 1, MPI_INT, nodeRanks.data(), 1, MPI_INT, 0, nodeComm );
+	for ( int i = 0; i < nodeSize; ++i )
+	{
+	    MPI_Aint size = 0;
+	    int dispUnit = 0;
+	    void * segment = nullptr;
+	    MPI_Win_shared_query ( window, i, &size, &dispUnit, &segment );
+	    Ring ring;
+	    ring.header = static_cast<RingHeader *>( segment );
+	    ring.data = static_cast<char *>( segment ) + sizeof(RingHeader);
+	    ring.rank = nodeRanks[i];
+	    nodeRings.push_back( ring );
+	}
+	forwarder = std::thread( &SharedLog::Forward, this );
+    }
+    else
+	MPI_Gather ( &myRing.rank, 1, MPI_INT, nullptr, 0, MPI_INT, 0, nodeComm );
+
+    pActive = this;
+}
+
+SharedLog::~SharedLog ()
+{
+    pActive = nullptr;
+    if ( forwarder.joinable() )
+	forwarder.join();			// ends when the Blackboard flushes it
+    MPI_Barrier ( nodeComm );			// no producer is still writing
+    MPI_Win_unlock_all ( window );
+    MPI_Win_free ( &window );
+    MPI_Comm_free ( &nodeComm );
+    controlComm.Free();
+}
+
+bool SharedLog::Post (
+    MsgTags const tag,
+    char const * const data,
+    std::size_t const size)
+{
+    std::size_t const need = recordHeaderSize + PaddedSize( size );
+    if ( need > ringSize / 2 )
+	return false;
+
+    std::lock_guard<std::mutex> lock ( postMutex );
+    RingHeader & header = *myRing.header;
+    std::uint64_t head = header.head.load( std::memory_order_relaxed );
+    std::size_t position = head % ringSize;
+    std::size_t const contiguous = ringSize - position;
+    std::size_t const total = need + ( contiguous < need ? contiguous : 0 );
+    // wait for the forwarder to make space
+    while ( ringSize - ( head - header.tail.load( std::memory_order_acquire ) ) < total )
+    {
+	if ( header.closed.load( std::memory_order_acquire ) )
+	    return true;			// Blackboard has stopped
+	std::this_thread::yield();
+    }
+    if ( header.closed.load( std::memory_order_acquire ) )
+	return true;
+
+    if ( contiguous < need )
+    {
+	std::memcpy( myRing.data + position, &wrapMarker, sizeof(wrapMarker) );
+	head += contiguous;
+	position = 0;
+    }
+    std::uint32_t const recordSize = static_cast<std::uint32_t>( size );
+    std::int32_t const recordTag = tag;
+    char * const record = myRing.data + position;
+    std::memcpy( record, &recordSize, sizeof(recordSize) );
+    std::memcpy( record + sizeof(recordSize), &recordTag, sizeof(recordTag) );
+    if ( size > 0 )
+	std::memcpy( record + recordHeaderSize, data, size );
+    header.head.store( head + need, std::memory_order_release );
+    return true;
+}
+
+/// @cond SKIP_PRIVATE
+
+void SharedLog::Forward ()
+{
+    BinaryWriter batch ( maxBatchSize );
+    while ( !stopForwarder.load() )
+    {
+	bool const haveRecords = Drain( batch );
+	SendBatch( batch );
+
+	int flushRequested = 0;
+	MPI_Message message;
+	MPI_Improbe ( idBlackboard, Tag_LogFlush, controlComm, &flushRequested, &message, MPI_STATUS_IGNORE );
+	if ( flushRequested )
+	{
+	    MPI_Mrecv ( nullptr, 0, MPI_BYTE, &message, MPI_STATUS_IGNORE );
+	    // producers discard records from now on
+	    for ( std::vector<Ring>::iterator i = nodeRings.begin(); i != nodeRings.end(); ++i )
+		i->header->closed.store( 1, std::memory_order_release );
+	    Drain( batch );
+	    SendBatch( batch );
+	    // after the last batch, in message order
+	    comm.Send ( nullptr, 0, MPI::BYTE, idBlackboard, Tag_LogFlushed );
+	    stopForwarder.store( true );
+	}
+	else if ( !haveRecords )
+	    std::this_thread::sleep_for( std::chrono::microseconds( 200 ) );
+    }
+}
+
+bool SharedLog::Drain (
+    BinaryWriter & batch)
+{
+    bool haveRecords = false;
+    for ( std::vector<Ring>::iterator ring = nodeRings.begin(); ring != nodeRings.end(); ++ring )
+    {
+	RingHeader & header = *ring->header;
+	std::uint64_t tail = header.tail.load( std::memory_order_relaxed );
+	std::uint64_t const head = header.head.load( std::memory_order_acquire );
+	while ( tail < head )
+	{
+	    std::size_t const position = tail % ringSize;
+	    char const * const record = ring->data + position;
+	    std::uint32_t recordSize = 0;
+	    std::memcpy( &recordSize, record, sizeof(recordSize) );
+	    if ( recordSize == wrapMarker )
+	    {
+		tail += ringSize - position;
+		continue;
+	    }
+	    std::int32_t recordTag = 0;
+	    std::memcpy( &recordTag, record + sizeof(recordSize), sizeof(recordTag) );
+	    batch << ring->rank << static_cast<int>( recordTag ) << recordSize;
+	    batch.WriteBytes( record + recordHeaderSize, recordSize );
+	    tail += recordHeaderSize + PaddedSize( recordSize );
+	    haveRecords = true;
+	    if ( batch.Size() >= maxBatchSize )
+	    {
+		header.tail.store( tail, std::memory_order_release );
+		SendBatch( batch );
+	    }
+	}
+	header.tail.store( tail, std::memory_order_release );
+    }
+    return haveRecords;
+}
+
+void SharedLog::SendBatch (
+    BinaryWriter & batch)
+{
+    if ( batch.Size() == 0 )
+	return;
+    batch.Send( comm, idBlackboard, Tag_LogBatch );
+    batch.Clear();
+}
+
+/// @endcond
+
+void SendToBlackboard (
+    MsgTags const tag,
+    char const * const data,
+    std::size_t const size,
+    int const blackboardID)
+{
+    SharedLog * const pSharedLog = SharedLog::GetActive();
+    if ( pSharedLog == nullptr || !pSharedLog->Post( tag, data, size ) )
+    {
+	GetTrafficComm( tag ).Send ( data, size, MPI::CHAR, blackboardID, tag );
+	CheckErrorMPI( "mtbmpi::SendToBlackboard" );
+    }
+}
+
+
+} // namespace mtbmpi
@@ -0,0 +1,144 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		SharedLog.h
+@class		mtbmpi::SharedLog
+@brief 		Node-local shared-memory path for log messages and result records.
+@details
+		Used when the option `--mtbmpi-shared-log[=BYTES]` is given.
+
+		The ranks on a node share an MPI window (MPI_Win_allocate_shared)
+		with a lock-free ring of BYTES (default 64 KB) for each rank.
+		A process writes its log messages and result records into its ring
+		instead of sending each one to the Blackboard.
+		A forwarder thread in the lowest rank on the node drains all of the
+		node's rings, and sends the records to the Blackboard as one
+		Tag_LogBatch message, so the Blackboard receives about one message
+		per node instead of one per rank.
+
+		Log and error messages from LoggerMPI use the rings automatically.
+		Tasks can send result records with SendToBlackboard;
+		the Blackboard passes them to OutputMgr::HandleOutputRecord.
+		A record larger than half of a ring is sent directly.
+
+		When the Blackboard stops, it asks each forwarder to flush its rings;
+		records written after that are discarded, as are messages sent
+		directly to a stopped Blackboard.
+		The destructor waits until the Blackboard has flushed the forwarder.
+
+		The forwarder thread requires MPI_THREAD_MULTIPLE.
+		Construction and destruction are collective over the communicator.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_SharedLog_h
+#define INC_mtbmpi_SharedLog_h
+
+#include "mpi.h"
+#include "MsgTags.h"
+#include "BinaryBuffer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mtbmpi {
+
+
+class SharedLog
+{
+  public:
+
+    static std::size_t const defaultRingSize = 64 * 1024;	///< bytes per rank
+
+    /// Constructor; collective over useComm
+    SharedLog (
+      MPI::Intracomm & useComm,		///< communicator of all ranks
+      int const blackboardID,		///< Blackboard rank
+      std::size_t const ringSize );	///< bytes in each rank's ring
+
+    /// Destructor; collective over the communicator
+    ~SharedLog ();
+
+    /// The shared log of this process, or null if not used
+    static SharedLog * GetActive () { return pActive; }
+
+    /// Write a record to this rank's ring.
+    /// Returns false if the record must be sent directly.
+    bool Post (
+      MsgTags const tag,		///< Tag_LogMessage, Tag_ErrorMessage, or Tag_TaskResults
+      char const * const data,		///< record bytes
+      std::size_t const size );		///< number of bytes
+
+    bool IsForwarder () const { return isForwarder; }	///< true if has the node's forwarder
+
+    /// Ranks in the communicator which have a forwarder; one per node
+    std::vector<int> const & GetForwarderIDs () const { return forwarderIDs; }
+
+    /// Communicator for flush requests from the Blackboard
+    MPI::Intracomm & GetControlComm () { return controlComm; }
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    // ring header at the start of each rank's segment of the window
+    struct RingHeader
+    {
+	alignas(64) std::atomic<std::uint64_t> head;	// bytes written; producer
+	alignas(64) std::atomic<std::uint64_t> tail;	// bytes read; forwarder
+	alignas(64) std::atomic<int> closed;		// forwarder has stopped
+    };
+
+    struct Ring
+    {
+	RingHeader * header;
+	char * data;
+	int rank;			// in communicator
+    };
+
+    static SharedLog * pActive;
+
+    MPI::Intracomm & comm;
+    int const idBlackboard;
+    std::size_t const ringSize;
+    MPI_Comm nodeComm;			// ranks on this node
+    MPI::Intracomm controlComm;		// flush requests and replies
+    MPI_Win window;
+    Ring myRing;
+    std::mutex postMutex;		// one producer per ring
+    bool isForwarder;
+    std::vector<int> forwarderIDs;
+    std::vector<Ring> nodeRings;	// forwarder: all rings on the node
+    std::thread forwarder;
+    std::atomic<bool> stopForwarder;
+
+    void Forward ();			// forwarder thread
+    bool Drain ( BinaryWriter & batch );	// returns true if any records
+    void SendBatch ( BinaryWriter & batch );
+
+    // functions that should not be used; are not defined
+    SharedLog (SharedLog const & object);
+    SharedLog & operator= (SharedLog const & object);
+
+    /// @endcond
+};
+
+/// Send a record to the Blackboard through the shared log if it is used,
+/// else as an MPI message.
+void SendToBlackboard (
+    MsgTags const tag,			///< Tag_LogMessage, Tag_ErrorMessage, or Tag_TaskResults
+    char const * const data,		///< record bytes
+    std::size_t const size,		///< number of bytes
+    int const blackboardID );		///< Blackboard rank
+
+
+} // namespace mtbmpi
+
+#endif // INC_mtbmpi_SharedLog_h
@@ -0,0 +1,254 @@
+/*------------------------------------------------------------------------------------------------------------
+file		SubController.cpp
+class		mtbmpi::SubController
+brief 		Manages a group of work tasks on behalf of the Controller.
+details
+		Used when the option `--mtbmpi-subcontroller-tasks=N` is given,
+		so that the Controller is not the destination of every message
+		from every task in a job with many tasks.
+
+		The sub-controller is the controller of its group of tasks.
+		It tracks their states, and after handling all waiting messages,
+		sends the Controller one summary message with the states that changed.
+		It relays the Controller's initialize, start, and stop requests to its tasks.
+
+		In work-queue mode, the sub-controller requests a batch of work items
+		from the Controller, and hands them out to its tasks one at a time.
+		It reports the number of items finished in its summary messages.
+
+project		Master-Task-Blackboard MPI Framework
+author		Thomas E. Hilinski <https://github.com/tehilinski>
+copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#include "SubController.h"
+#include "Master.h"
+#include "UtilitiesMPI.h"
+#include "MatchedProbe.h"
+#include <sstream>
+
+// define the following to write diagnostics to std::cout
+// #define DBG_MPI_SUBCONTROLLER
+
+#ifdef DBG_MPI_SUBCONTROLLER
+  #include <iostream>
+  using std::cout;
+  using std::endl;
+#endif
+
+namespace mtbmpi {
+
+
+SubController::SubController (
+    Master & useParent,			// parent of sub-controller
+    IDNum const myId,			// sub-controller rank
+    IDNum const blackBoardID,		// blackboard rank
+    IDNum const controllerID,		// Controller rank
+    int const numTasks,			// number of work processes managed
+    IDNum const firstTaskID,		// rank of 1st work process managed
+    ConfigurationPtr configPtr)		// configuration object (shares my rank)
+    : TaskGroup ( "mtbmpi::SubController", myId, blackBoardID, controllerID, numTasks, firstTaskID ),
+      parent (useParent),
+      pConfig (configPtr)
+{
+}
+
+void SubController::Activate ()
+{
+    #ifdef DBG_MPI_SUBCONTROLLER
+      std::string const myName = "SubController::Activate: ";
+      cout << myName << "rank " << GetID() << ": enter: "
+	   << GetTracker().Size() << " tasks" << endl;
+    #endif
+
+    // limits the time between summaries when messages arrive continuously
+    size_type const maxMsgsPerSummary = 4 * GetTracker().Size() + 1;
+
+    bool tasksAreCreated = false;
+    bool listenForMsgs = true;
+    while (listenForMsgs)				// event loop
+    {
+	// wait for a message, then handle all waiting messages
+	MPI_Message message;
+	MPI::Status status;
+	Mprobe ( mtbmpi::comm, MPI_ANY_SOURCE, MPI_ANY_TAG, message, status );
+	ProcessMessage (message, status);
+	size_type numMsgs = 1;
+	while ( numMsgs < maxMsgsPerSummary &&
+		Improbe ( mtbmpi::comm, MPI_ANY_SOURCE, MPI_ANY_TAG, message, status ) )
+	{
+	    ProcessMessage (message, status);
+	    ++numMsgs;
+	}
+
+	// one message to the Controller for all of the above
+	SendSummary ();
+
+	if ( !tasksAreCreated )
+	    tasksAreCreated = GetTracker().AreAllCreated();
+	if ( tasksAreCreated && AreAllTasksStopped() )
+	    listenForMsgs = false;
+    }
+
+    std::ostringstream os;
+    os << "Sub-controller " << GetID() << ": " << GetTracker().Size()
+       << " tasks are stopped.";
+    Log().Message( os.str() );
+    Log().Flush();
+
+    #ifdef DBG_MPI_SUBCONTROLLER
+      cout << myName << "rank " << GetID() << ": done" << endl;
+    #endif
+}
+
+/// @cond SKIP_PRIVATE
+
+void SubController::ProcessMessage (
+    MPI_Message & message,		// from the matched probe
+    MPI::Status & status)
+{
+    switch ( status.Get_tag() )
+    {
+      case Tag_State:
+	DoActionState (message, status);
+	break;
+
+      case Tag_WorkItems:
+	DoActionWorkItems (message, status);
+	break;
+
+      case Tag_InitializeTask:
+      case Tag_StartTask:
+      {
+	int const tag = status.Get_tag();
+	Mrecv ( 0, 0, MPI::BYTE, message );
+	RelayToAllTasks ( static_cast<MsgTags>(tag) );
+	break;
+      }
+
+      case Tag_RequestStopTask:
+	Mrecv ( 0, 0, MPI::BYTE, message );
+	StopAllTasks ();
+	break;
+
+      case Tag_RequestStop:
+	DoActionRequestStop (message, status);
+	break;
+
+      case Tag_RequestCmdLineArgs:
+	DoActionRequestCmdLineArgs (message, status);
+	break;
+
+      default:
+      {
+	// unhandled message - mark as received but discard
+	DiscardMatched ( message, status );
+	#ifdef DBG_MPI_SUBCONTROLLER
+	  cout << "SubController: rank " << GetID()
+	       << ": discarded msg with tag " << status.Get_tag()
+	       << " from " << status.Get_source() << endl;
+	#endif
+	break;
+      }
+    }
+}
+
+void SubController::DoActionState ( MPI_Message & message, MPI::Status & status )
+{
+    int buffer[2];		// 0 = id, 1 = state
+    Mrecv ( buffer, 2, MPI::INT, message );
+    State const newState = static_cast<State>( buffer[1] );
+
+    #ifdef DBG_MPI_SUBCONTROLLER
+      cout << "SubController: rank " << GetID()
+	   << ": task rank " << buffer[0]
+	   << ": new state = " << AsString(newState) << endl;
+    #endif
+
+    SetTaskState ( buffer[0], newState );
+}
+
+void SubController::DoActionRequestStop ( MPI_Message & message, MPI::Status & status )
+{
+    // do a recv so message is marked as received
+    char charBuffer = NULL_CHAR;
+    Mrecv ( &charBuffer, 1, MPI::CHAR, message );
+
+    // the Controller decides
+    mtbmpi::comm.Send ( 0, 0, MPI::BYTE, idController, Tag_RequestStop );
+    CheckErrorMPI( className );
+}
+
+void SubController::DoActionRequestCmdLineArgs ( MPI_Message & message, MPI::Status & status )
+{
+    // do a recv so message is marked as received
+    char charBuffer = NULL_CHAR;
+    Mrecv ( &charBuffer, 1, MPI::CHAR, message );
+
+    // same configuration as the Controller
+    std::string buffer;
+    JoinStrings (buffer, GetConfiguration().GetArgs(), NL_CHAR );
+    mtbmpi::comm.Send (
+		buffer.c_str(), buffer.size(), MPI::CHAR,
+		status.Get_source(), Tag_CmdLineArgs );
+    CheckErrorMPI( className );
+}
+
+void SubController::RelayToAllTasks (
+    MsgTags const tag)
+{
+    std::string const myName = "SubController::RelayToAllTasks: ";
+
+    std::vector<MPI::Request> requests ( GetTracker().Size() );
+    for ( size_type taskNum = 0; taskNum < GetTracker().Size(); ++taskNum )
+    {
+	requests[taskNum] = mtbmpi::comm.Isend (
+	    0, 0, MPI::BYTE,
+	    (idFirstTask + taskNum), tag );
+    }
+
+    std::vector<MPI::Status> status ( requests.size() );
+    MPI::Request::Waitall ( requests.size(), requests.data(), status.data() );
+
+    // check for errors
+    for ( std::vector<MPI::Status>::const_iterator i = status.begin();
+	  i != status.end();
+	  ++i )
+    {
+	if ( i->Get_error() != MPI_SUCCESS )
+	{
+	    std::ostringstream os;
+	    os << myName << "send message error."
+	       << " Error: "  << i->Get_error()
+	       << " Tag: "    << i->Get_tag()
+	       << " Source: " << i->Get_source();
+	    Log().Error( os.str() );
+	}
+    }
+}
+
+void SubController::DoSendWorkItem (
+    size_type const taskNum,
+    WorkItem const & item)
+{
+    std::string const buffer = item.Pack();
+    mtbmpi::comm.Send (
+	    buffer.data(), buffer.size(), MPI::CHAR,
+	    (idFirstTask + taskNum), Tag_WorkItem );
+    CheckErrorMPI( className );
+}
+
+void SubController::DoStopTask (
+    size_type const taskNum)
+{
+    mtbmpi::comm.Send ( 0, 0, MPI::BYTE, (idFirstTask + taskNum), Tag_RequestStopTask );
+    CheckErrorMPI( className );
+}
+
+/// @endcond
+
+
+} // namespace mtbmpi
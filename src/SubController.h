@@ -0,0 +1,102 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		SubController.h
+@class		mtbmpi::SubController
+@brief 		Manages a group of work tasks on behalf of the Controller.
+@details
+		Used when the option `--mtbmpi-subcontroller-tasks=N` is given,
+		so that the Controller is not the destination of every message
+		from every task in a job with many tasks.
+
+		The sub-controller is the controller of its group of tasks.
+		It tracks their states, and after handling all waiting messages,
+		sends the Controller one summary message with the states that changed.
+		It relays the Controller's initialize, start, and stop requests to its tasks.
+
+		In work-queue mode, the sub-controller requests a batch of work items
+		from the Controller, and hands them out to its tasks one at a time.
+		It reports the number of items finished in its summary messages.
+
+		A sub-controller is owned by the Master in its MPI rank,
+		and stops when all of its tasks are stopped.
+		Its bookkeeping of the tasks and work items is in TaskGroup,
+		which it shares with TaskHost.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_SubController_h
+#define INC_mtbmpi_SubController_h
+
+#include "TaskGroup.h"
+#include "MsgTags.h"
+#include <memory>
+
+namespace mtbmpi {
+
+
+class Configuration;
+class Master;
+
+class SubController : public TaskGroup
+{
+  public:
+
+    typedef std::shared_ptr<Configuration>	ConfigurationPtr;
+
+    /// Constructor
+    SubController (
+      Master & useParent,		///< parent of sub-controller
+      IDNum const myId,			///< sub-controller rank
+      IDNum const blackBoardID,		///< blackboard rank
+      IDNum const controllerID,		///< Controller rank
+      int const numTasks,		///< number of work processes managed
+      IDNum const firstTaskID,		///< rank of 1st work process managed
+      ConfigurationPtr configPtr	///< configuration object (shares my rank)
+      );	// here for doxygen bug
+
+    /// Start the main loop of the sub-controller.
+    /// Returns when all of its tasks are stopped.
+    void Activate ();
+
+    Configuration const & GetConfiguration () const { return *pConfig; }
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    Master & parent;
+    ConfigurationPtr pConfig;		// configuration
+
+    void ProcessMessage ( MPI_Message & message, MPI::Status & status );
+
+    void RelayToAllTasks (		// send a zero-length msg to all tasks
+      MsgTags const tag);
+    void DoSendWorkItem (		// Tag_WorkItem
+      size_type const taskNum,
+      WorkItem const & item);
+    void DoStopTask (			// Tag_RequestStopTask
+      size_type const taskNum);
+
+    void DoActionState ( MPI_Message & message, MPI::Status & status );
+    void DoActionRequestStop ( MPI_Message & message, MPI::Status & status );
+    void DoActionRequestCmdLineArgs ( MPI_Message & message, MPI::Status & status );
+
+    // functions that should not be used; are not defined
+    SubController (SubController const & object);
+    SubController & operator= (SubController const & object);
+    bool operator== (SubController const & object) const;
+    bool operator!= (SubController const & object) const;
+
+    /// @endcond
+};
+
+
+} // namespace mtbmpi
+
+
+#endif // INC_mtbmpi_SubController_h
@@ -15,6 +15,25 @@ details
 		will initialize a task with command-line arguments for its job
 		as though that particular task were run from the command-line.
 
+		In the Controller's work-queue mode, the task receives one work item
+		at a time, and initializes and starts its TaskAdapter for each item.
+		The task then waits for the next item or a stop request.
+		The concrete task gets the current item from GetWorkItem().
+
+		If the Master has a task Communicator (option `--mtbmpi-collective-phases`),
+		the task keeps a non-blocking broadcast receive posted for the
+		Controller's CollectivePhase codes, and polls it along with its messages.
+		The task waits for Phase_Finish before it is destroyed.
+
+		Data sent by Controller::SendData is received in chunks directly into
+		the TaskAdapter's buffer, or into a buffer owned by the Task which is
+		reused for later data, and then given to the TaskAdapter's AcceptData.
+		The header arrives on comm and the chunks on dataComm.
+
+		A task hosted by a TaskHost makes no MPI calls: its states,
+		log messages and results are posted to the host,
+		and the host's thread for the task calls TakeAction.
+
 project		Master-Task-Blackboard MPI Framework
 author		Thomas E. Hilinski <https://github.com/tehilinski>
 copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
@@ -24,9 +43,13 @@ copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
 ------------------------------------------------------------------------------------------------------------*/
 
 #include "Task.h"
+#include "TaskHost.h"
 #include "Master.h"
 #include "MsgTags.h"
 #include "UtilitiesMPI.h"
+#include "MatchedProbe.h"
+#include <climits>
+#include <algorithm>
 
 // define the following to write diagnostics to std::cout
 // #define DBG_MPI_TASK
@@ -50,52 +73,113 @@ Task::Task (
     ArgPair args)
     : SendsMsgsToLog (myID, blackBoardID),
       parent (useParent),
+      pHost (nullptr),
       name ( taskName ),
       idController (controllerID),
       argPair (args),
       state (State_Unknown),
-      action (NoAction)
+      action (NoAction),
+      stopRequested (false),
+      workQueueMode (false),
+      numWorkItems (0),
+      pTaskComm ( useParent.GetTaskCommunicator() ),
+      phaseCode (Phase_None),
+      phaseRequest (MPI_REQUEST_NULL),
+      phasesFinished (true),
+      pData (nullptr),
+      dataSize (0),
+      dataID (0)
 {
-    // string with Tracker index: 1-based
-    idStr = ToString ( myID - parent.GetFirstTaskID() + 1 );
-    bufferState[0] = myID;			// constant
-
-    #ifdef DBG_MPI_TASK
-      cout << "Tracker ID " << idStr << ": " << "constructor" << endl;
-    #endif
-
-    // get cmd-line args
-    StrVec cmdLineArgs (
-		    GetArgs().second,
-		    GetArgs().second + GetArgs().first );
-
-    // create and start task
-    pTaskAdapter = pTaskFactory->Create (*this, name, cmdLineArgs);
-    SetState( State_Created );
+    Create ( pTaskFactory );
 
     // Master decides when to activate this class
     // so that derived Task class can do things after this constructor
     // Activate ();
 }
 
+Task::Task (
+    Master & useParent,				// parent of task
+    TaskHost & useHost,				// host which runs this task
+    std::string const & taskName,		// name of this task
+    IDNum const myID,				// logical task ID
+    IDNum const hostID,				// host rank; the task's controller
+    IDNum const blackBoardID,			// blackboard task rank
+    TaskFactoryPtr pTaskFactory,		// task factory
+    ArgPair args)
+    : SendsMsgsToLog (myID, blackBoardID),
+      parent (useParent),
+      pHost (&useHost),
+      name ( taskName ),
+      idController (hostID),
+      argPair (args),
+      state (State_Unknown),
+      action (NoAction),
+      stopRequested (false),
+      workQueueMode (false),
+      numWorkItems (0),
+      phaseCode (Phase_None),
+      phaseRequest (MPI_REQUEST_NULL),
+      phasesFinished (true),
+      pData (nullptr),
+      dataSize (0),
+      dataID (0)
+{
+    // the host takes the actions; no event loop
+    Create ( pTaskFactory );
+}
+
 Task::~Task ()
 {
     #ifdef DBG_MPI_TASK
       cout << "Tracker ID " << idStr << ": ~Task" << endl;
     #endif
     SetState( State_Terminated );
+    WaitForPhaseFinish ();
 }
 
+/// @cond SKIP_PRIVATE
+
+void Task::Create (
+    TaskFactoryPtr pTaskFactory)
+{
+    // string with Tracker index: 1-based
+    idStr = ToString ( GetID() - parent.GetFirstTaskID() + 1 );
+    bufferState[0] = GetID();			// constant
+
+    #ifdef DBG_MPI_TASK
+      cout << "Tracker ID " << idStr << ": " << "constructor" << endl;
+    #endif
+
+    // get cmd-line args; framework options are not for the task
+    StrVec cmdLineArgs;
+    for ( int i = 0; i < GetArgs().first; ++i )
+    {
+	if ( !Configuration::IsOption( GetArgs().second[i] ) )
+	    cmdLineArgs.push_back( GetArgs().second[i] );
+    }
+
+    // create and start task
+    pTaskAdapter = pTaskFactory->Create (*this, name, cmdLineArgs);
+    SetState( State_Created );
+}
+
+/// @endcond
+
 void Task::Activate ()
 {
     #ifdef DBG_MPI_TASK
       cout << "Tracker ID " << idStr << ": " << "Activate: enter" << endl;
     #endif
 
+    idleTimer.start();		// used only in work-queue mode
+    if ( pTaskComm )
+    {
+	phasesFinished = false;
+	PostPhaseReceive ();
+    }
+
     // Handle messages
-    while ( !( IsCompleted(state) ||
-	       IsTerminated(state) ||
-	       IsError(state) ) )
+    while ( !IsDone() )
     {
 	#ifdef DBG_MPI_TASK
 	    cout << "Tracker ID " << idStr << ": "
@@ -105,8 +189,13 @@ void Task::Activate ()
 	#endif
 
 	// Wait for messages
+	MPI_Message message;
 	MPI::Status status;
-	mtbmpi::comm.Probe ( idController, MPI_ANY_TAG, status );
+	bool haveMsg = true;
+	if ( pTaskComm )
+	    haveMsg = WaitForMessage (message, status);
+	else
+	    Mprobe ( mtbmpi::comm, MPI_ANY_SOURCE, MPI_ANY_TAG, message, status );
 
 	#ifdef DBG_MPI_TASK
 	    cout << "Tracker ID " << idStr << ": "
@@ -131,7 +220,7 @@ void Task::Activate ()
 	    }
 	#endif
 
-	action = ProcessMessage (status);
+	action = ( haveMsg ? ProcessMessage (message, status) : TakePhaseAction () );
 
 	#ifdef DBG_MPI_TASK
 	if ( IsMsgTagValid( status.Get_tag() ) )
@@ -145,19 +234,7 @@ void Task::Activate ()
 	}
 	#endif
 
-	switch (action)
-	{
-	  case ActionInitialize: DoActionInitialize ();     break;
-	  case ActionStart:      DoActionStart ();          break;
-	  case ActionStop:       DoActionStop ();           break;
-	  case ActionPause:      DoActionPause ();          break;
-	  case ActionResume:     DoActionResume ();         break;
-	  case ActionAcceptData: DoActionAcceptData();      break;
-
-	  case NoAction:
-	  default:
-	    break;
-	}
+	TakeAction ();
 
     } // while
 
@@ -168,6 +245,33 @@ void Task::Activate ()
 
 /// @cond SKIP_PRIVATE
 
+void Task::TakeAction ()
+{
+    switch (action)
+    {
+      case ActionInitialize: DoActionInitialize ();     break;
+      case ActionStart:      DoActionStart ();          break;
+      case ActionStop:       DoActionStop ();           break;
+      case ActionPause:      DoActionPause ();          break;
+      case ActionResume:     DoActionResume ();         break;
+      case ActionAcceptData: DoActionAcceptData();      break;
+      case ActionWorkItem:   DoActionWorkItem();        break;
+
+      case NoAction:
+      default:
+	break;
+    }
+}
+
+bool Task::IsDone () const
+{
+    if ( stopRequested || IsTerminated(state) )
+	return true;
+    if ( workQueueMode )	// wait for next work item or stop request
+	return false;
+    return IsCompleted(state) || IsError(state);
+}
+
 void Task::DoActionInitialize ()
 {
     #ifdef DBG_MPI_TASK
@@ -181,8 +285,7 @@ void Task::DoActionInitialize ()
 	return;
     }
 
-    SetState( pTaskAdapter->InitializeTask () );
-    LogState();
+    SetAndLogState( pTaskAdapter->InitializeTask () );
 }
 
 void Task::DoActionStart ()
@@ -202,13 +305,11 @@ void Task::DoActionStart ()
     {
 	// handle failed initialization
 	SendMsgToLog ("initialization failed");
-	SetState( State_Error );
-	LogState();
+	SetAndLogState( State_Error );
 	return;
     }
 
-    SetState( pTaskAdapter->StartTask() ); // returns state after start
-    LogState();
+    SetAndLogState( pTaskAdapter->StartTask() ); // returns state after start
 
     #ifdef DBG_MPI_TASK
     cout << "Task " << idStr << ": "
@@ -223,27 +324,34 @@ void Task::DoActionStop ()
 	 << "Activate: ActionStop: enter" << endl;
     #endif
 
-    SetState( pTaskAdapter->StopTask() );
+    stopRequested = true;
+    if ( workQueueMode )
+	LogWorkStatistics ();
+    state = pTaskAdapter->StopTask();
     if ( !IsCompleted(state) && !IsTerminated(state) )  // not stopped?
     {
 	// force stop - ouch!
 	pTaskAdapter.reset();
-	SetState( State_Terminated );
+	state = State_Terminated;
     }
     else // if ( IsCompleted(state) || IsTerminated(state) )
     {
 	action = NoAction;
     }
-    LogState();
+    SetAndLogState( state );
+    if ( pHost )
+	return;			// the host receives the messages
 
     // check for and discard any remaining msgs
     short count = 0;
     while ( count < 10 )    // number of checks
     {
-	if ( mtbmpi::comm.Iprobe ( idController, MPI_ANY_TAG ) )
+	MPI_Message message;
+	MPI::Status status;
+	if ( Improbe ( mtbmpi::comm, idController, MPI_ANY_TAG, message, status ) )
 	{
 	    // cout << "Task " << idStr << ": discarding msg" << endl;
-	    mtbmpi::comm.Recv ( 0, 0, MPI::BYTE, idController, MPI_ANY_TAG );
+	    DiscardMatched ( message, status );
 	}
 	else // wait a bit
 	{
@@ -260,8 +368,7 @@ void Task::DoActionStop ()
 
 void Task::DoActionPause ()
 {
-    SetState( pTaskAdapter->PauseTask() );
-    LogState();
+    SetAndLogState( pTaskAdapter->PauseTask() );
     if ( IsPaused(state) )
 	action = NoAction;	// wait for resume msg
 }
@@ -274,8 +381,7 @@ void Task::DoActionResume ()
 	return;
     }
 
-    SetState( pTaskAdapter->ResumeTask() );
-    LogState();
+    SetAndLogState( pTaskAdapter->ResumeTask() );
     if ( IsRunning(state) || IsCompleted(state) )
 	action = NoAction;
 }
@@ -288,7 +394,130 @@ void Task::DoActionAcceptData ()
 	return;
     }
 
-    /// @todo DoActionAcceptData
+    if ( pTaskAdapter )
+	pTaskAdapter->AcceptData( dataID, pData, dataSize );
+    action = NoAction;
+}
+
+void Task::ReceiveData (
+    MPI_Message & message,
+    MPI::Status const & status)
+{
+    // header: total bytes, data ID
+    long long header[2] = { 0, 0 };
+    int const source = status.Get_source();
+    Mrecv ( header, 2, MPI::LONG_LONG, message );
+    dataSize = static_cast<std::size_t>( std::max( header[0], 0LL ) );
+    dataID = static_cast<int>( header[1] );
+
+    // receive directly into the adapter's buffer, else the pooled buffer
+    pData = ( pTaskAdapter ? pTaskAdapter->GetDataBuffer( dataID, dataSize ) : nullptr );
+    if ( !pData )
+    {
+	if ( dataPool.size() < dataSize )
+	    dataPool.resize( dataSize );
+	pData = dataPool.data();
+    }
+
+    // chunks are at most INT_MAX bytes
+    std::size_t offset = 0;
+    while ( offset < dataSize )
+    {
+	int const count = static_cast<int>(
+	    std::min( dataSize - offset, static_cast<std::size_t>(INT_MAX) ) );
+	MPI::Status recvStatus;
+	mtbmpi::dataComm.Recv ( pData + offset, count, MPI::BYTE, source, Tag_DataChunk, recvStatus );
+	offset += recvStatus.Get_count( MPI::BYTE );
+    }
+}
+
+void Task::DoActionWorkItem ()
+{
+    #ifdef DBG_MPI_TASK
+    cout << "Tracker ID " << idStr << ": "
+	 << "Activate: ActionWorkItem: item " << workItem.GetIndex() << endl;
+    #endif
+
+    idleTimer.stop();
+    busyTimer.start();
+    workQueueMode = true;
+    ++numWorkItems;
+
+    // previous item is done; initialize and start for this item
+    state = State_Created;
+    DoActionInitialize ();
+    if ( IsInitialized(state) )
+	DoActionStart ();
+    action = NoAction;
+
+    busyTimer.stop();
+    idleTimer.start();
+}
+
+void Task::LogWorkStatistics ()
+{
+    idleTimer.stop();
+    std::ostringstream os;
+    os << "work items = " << numWorkItems
+       << ", busy time (seconds) = " << busyTimer.read()
+       << ", idle time (seconds) = " << idleTimer.read();
+    SendMsgToLog( os.str() );
+}
+
+bool Task::WaitForMessage (
+    MPI_Message & message,
+    MPI::Status & status)
+{
+    // poll both, so that a phase broadcast can arrive while messages are handled
+    while ( true )
+    {
+	if ( !phasesFinished )
+	{
+	    int isDone = 0;
+	    MPI_Test ( &phaseRequest, &isDone, MPI_STATUS_IGNORE );
+	    if ( isDone )
+		return false;
+	}
+	if ( Improbe ( mtbmpi::comm, MPI_ANY_SOURCE, MPI_ANY_TAG, message, status ) )
+	    return true;
+	Log().FlushIfDue();
+	Sleep( 100 );
+    }
+}
+
+Task::ActionNeeded Task::TakePhaseAction ()
+{
+    ActionNeeded newAction = NoAction;
+    switch ( phaseCode )
+    {
+      case Phase_Initialize:	newAction = ActionInitialize;	break;
+      case Phase_Start:		newAction = ActionStart;	break;
+      case Phase_Stop:		newAction = ActionStop;		break;
+      case Phase_Finish:	phasesFinished = true;		break;
+      default:							break;
+    }
+    if ( !phasesFinished )
+	PostPhaseReceive ();
+    return newAction;
+}
+
+void Task::PostPhaseReceive ()
+{
+    phaseCode = Phase_None;
+    MPI_Ibcast ( &phaseCode, 1, MPI_INT, 0, pTaskComm->GetComm(), &phaseRequest );
+}
+
+void Task::WaitForPhaseFinish ()
+{
+    // every task must take part in every broadcast; ignore phases after stopping
+    while ( !phasesFinished )
+    {
+	MPI_Wait ( &phaseRequest, MPI_STATUS_IGNORE );
+	if ( phaseCode == Phase_Finish )
+	    phasesFinished = true;
+	else
+	    PostPhaseReceive ();
+    }
 }
 
 void Task::SendStateToController ()
@@ -300,6 +529,12 @@ void Task::SendStateToController ()
 	 << endl;
     #endif
 
+    if ( pHost )
+    {
+	pHost->PostState( GetID(), state );
+	return;
+    }
+
     // bufferState[0] = GetID();	// always
     bufferState[1] = static_cast<int>(state);
     mtbmpi::comm.Send (
@@ -312,14 +547,37 @@ void Task::SendStateToController ()
 
 void Task::LogState ()
 {
+    // state transitions are debug messages; error and terminated are warnings
+    LogLevel const level =
+	( IsError(state) || IsTerminated(state) ? LogLevel_Warning : LogLevel_Debug );
+    if ( !LoggerMPI::IsEnabled( level ) )
+	return;
     std::string msg = "Tracker ID ";
     msg += idStr;
     msg += ": state = ";
     msg += AsString(state);
-    Log().Message( msg );
+    if ( pHost )
+	pHost->PostLog( level, msg, EMPTY_STRING_STATIC );
+    else if ( level == LogLevel_Warning )
+	Log().Warning( msg );
+    else
+	Log().Debug( msg );
+}
+
+void Task::SetAndLogState (
+    State const newState)
+{
+    state = newState;
+    LogState();
+    // a stopped task's log messages are sent before
+    // the Controller can stop the Blackboard
+    if ( !pHost && ( IsCompleted(state) || IsTerminated(state) || IsError(state) ) )
+	Log().Flush();			// the batch, if log messages are batched
+    SendStateToController ();
 }
 
 Task::ActionNeeded Task::ProcessMessage (
+    MPI_Message & message,		// from the matched probe
     MPI::Status const & status)
 {
     ActionNeeded newAction = NoAction;
@@ -327,50 +585,59 @@ Task::ActionNeeded Task::ProcessMessage (
     {
       case Tag_InitializeTask:
       {
-	mtbmpi::comm.Recv ( 0, 0, MPI::BYTE, idController, Tag_InitializeTask );
+	Mrecv ( 0, 0, MPI::BYTE, message );
 	newAction = ActionInitialize;
 	break;
       }
       case Tag_StartTask:
       {
-	mtbmpi::comm.Recv ( 0, 0, MPI::BYTE, idController, Tag_StartTask );
+	Mrecv ( 0, 0, MPI::BYTE, message );
 	newAction = ActionStart;
 	break;
       }
       case Tag_RequestStopTask:
       {
-	mtbmpi::comm.Recv ( 0, 0, MPI::BYTE, idController, Tag_RequestStopTask );
+	Mrecv ( 0, 0, MPI::BYTE, message );
 	newAction = ActionStop;
 	break;
       }
       case Tag_RequestStop:
       {
-	mtbmpi::comm.Recv ( 0, 0, MPI::BYTE, idController, Tag_RequestStop );
+	Mrecv ( 0, 0, MPI::BYTE, message );
 	newAction = ActionStop;
 	break;
       }
       case Tag_RequestPauseTask:
       {
-	mtbmpi::comm.Recv ( &bufferState, 2, MPI::INT, idController, Tag_RequestPauseTask );
+	Mrecv ( &bufferState, 2, MPI::INT, message );
 	newAction = ActionPause;
 	break;
       }
       case Tag_RequestResumeTask:
       {
-	mtbmpi::comm.Recv ( &bufferState, 2, MPI::INT, idController, Tag_RequestResumeTask );
+	Mrecv ( &bufferState, 2, MPI::INT, message );
 	newAction = ActionResume;
 	break;
       }
+      case Tag_WorkItem:
+      {
+	int const count = status.Get_count (MPI::CHAR);
+	std::string buffer( count + 1, NULL_CHAR );
+	Mrecv ( &buffer[0], count, MPI::CHAR, message );
+	workItem.Unpack( buffer.data(), count );
+	newAction = ActionWorkItem;
+	break;
+      }
       case Tag_Data:
       {
-	/// @todo Tag_Data
+	ReceiveData (message, status);
 	newAction = ActionAcceptData;
 	break;
       }
       default:
       {
 	// unknown message - mark as received but discard
-	// mtbmpi::comm.Recv ( 0, 0, MPI::BYTE, idController, MPI_ANY_TAG );
+	DiscardMatched ( message, status );
 	break;
       }
     }
@@ -387,12 +654,25 @@ void Task::SetState (State const newState)
 
 void Task::SendMsgToLog ( std::string const & logMsg )
 {
-    Log().Message( logMsg, idStr );
+    if ( pHost )
+	pHost->PostLog( LogLevel_Info, logMsg, idStr );
+    else
+	Log().Message( logMsg, idStr );
 }
 
 void Task::SendMsgToLog ( char const * const logMsg )
 {
-    Log().Message( logMsg, idStr );
+    SendMsgToLog( std::string( logMsg ) );
+}
+
+void Task::SendResultRecord (
+    char const * const data,
+    std::size_t const size)
+{
+    if ( pHost )
+	pHost->PostResult( data, size );
+    else
+	mtbmpi::SendResultRecord( data, size, GetBlackboardID() );
 }
 
 
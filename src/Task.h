@@ -14,6 +14,28 @@
 		to a command-line application. In this implementation, the master
 		will initialize a task with command-line arguments for its job
 		as though that particular task were run from the command-line.
+
+		In the Controller's work-queue mode, the task receives one work item
+		at a time, and initializes and starts its TaskAdapter for each item.
+		The task then waits for the next item or a stop request.
+		The concrete task gets the current item from GetWorkItem().
+
+		If the Master has a task Communicator (option `--mtbmpi-collective-phases`),
+		the task keeps a non-blocking broadcast receive posted for the
+		Controller's CollectivePhase codes, and polls it along with its messages.
+		The task waits for Phase_Finish before it is destroyed.
+
+		Data sent by Controller::SendData is received in chunks directly into
+		the TaskAdapter's buffer, or into a buffer owned by the Task which is
+		reused for later data, and then given to the TaskAdapter's AcceptData.
+
+		A task can instead be one of the logical tasks of a TaskHost
+		(option `--mtbmpi-task-threads=N`). The hosted task has no event loop;
+		the host's thread for the task takes its actions, and the task
+		posts its states, log messages and results to the host, which
+		sends them. So a hosted TaskAdapter must not make MPI calls itself:
+		it sends its log messages with SendMsgToLog and its results
+		with SendResultRecord.
 @internal
 project		Master-Task-Blackboard MPI Framework
 @author		Thomas E. Hilinski <https://github.com/tehilinski>
@@ -29,12 +51,17 @@ project		Master-Task-Blackboard MPI Framework
 #include "SendsMsgsToLog.h"
 #include "TaskAdapterBase.h"
 #include "TaskFactoryBase.h"
+#include "WorkQueue.h"
+#include "TimerMPI.h"
+#include "Communicator.h"
 #include <memory>
+#include <vector>
 
 namespace mtbmpi {
 
 
 class Master;
+class TaskHost;
 
 class Task : public SendsMsgsToLog
 {
@@ -43,6 +70,7 @@ class Task : public SendsMsgsToLog
     typedef std::shared_ptr<TaskAdapterBase>			TaskAdapterPtr;
     typedef std::shared_ptr<TaskFactoryBase>			TaskFactoryPtr;
     typedef std::pair< int const, char const * const * >	ArgPair;	///< command-line arc, argv
+    typedef std::shared_ptr<Communicator>			CommunicatorPtr;
 
     /// Constructor
     Task (
@@ -55,6 +83,18 @@ class Task : public SendsMsgsToLog
       ArgPair args			///< command-line args
       );	// here for doxygen bug
 
+    /// Constructor of a logical task of a TaskHost
+    Task (
+      Master & useParent,		///< parent of task
+      TaskHost & useHost,		///< host which runs this task
+      std::string const & taskName,	///< name of this task
+      IDNum const myID,			///< logical task ID
+      IDNum const hostID,		///< host rank; the task's controller
+      IDNum const blackBoardID,		///< blackboard task rank
+      TaskFactoryPtr pTaskFactory,	///< task factory
+      ArgPair args			///< command-line args
+      );	// here for doxygen bug
+
     ~Task ();
 
     void  SetState (State const newState);				///< Set the task state
@@ -63,6 +103,11 @@ class Task : public SendsMsgsToLog
     void SendMsgToLog ( std::string const & logMsg );			///< Send a message to the log file
     void SendMsgToLog ( char const * const logMsg );			///< Send a message to the log file
 
+    /// Send a result record to the Blackboard (see mtbmpi::SendResultRecord)
+    void SendResultRecord (
+      char const * const data,		///< record bytes
+      std::size_t const size);		///< number of bytes
+
     Master const &      GetParent () const { return parent; }		///< Get the task's master
     Master       &      GetParent ()       { return parent; }		///< Get the task's master
     std::string const & GetName ()   const { return name; }		///< Get the task name
@@ -71,12 +116,18 @@ class Task : public SendsMsgsToLog
 
     IDNum GetControllerID () const { return idController; }
 
+    bool IsWorkQueueMode () const { return workQueueMode; }		///< true if task receives work items
+    bool IsHosted () const { return pHost != nullptr; }		///< true if run by a TaskHost
+    WorkItem const & GetWorkItem () const { return workItem; }		///< current work item
+
     void Activate ();	// run the task's event loop
 
   private:
 
     /// @cond SKIP_PRIVATE
 
+    friend class TaskHost;		// takes the actions of a hosted task
+
     enum ActionNeeded
       {
 	ActionInitialize,
@@ -85,10 +136,12 @@ class Task : public SendsMsgsToLog
 	ActionPause,
 	ActionResume,
 	ActionAcceptData,
+	ActionWorkItem,
 	NoAction
       };
 
     Master & parent;
+    TaskHost * const pHost;		// null unless hosted
     std::string name;			// task name
     IDNum const idController;
     ArgPair argPair;			// arc, argv
@@ -97,11 +150,41 @@ class Task : public SendsMsgsToLog
     int bufferState[2];			// msg buffer for Tag_State; 0 = id, 1 = state
     TaskAdapterPtr pTaskAdapter;	// the actual task
     std::string idStr;			// string with Tracker index: 1-based
-
-
-    ActionNeeded ProcessMessage (MPI::Status const & status);
+    bool stopRequested;			// true after stop request is processed
+    bool workQueueMode;			// true after 1st work item is received
+    WorkItem workItem;			// current work item
+    long numWorkItems;			// number of work items received
+    TimerMPI busyTimer;			// time doing work items
+    TimerMPI idleTimer;			// time waiting for work items
+    CommunicatorPtr pTaskComm;		// Controller and tasks; can be empty
+    int phaseCode;			// buffer for phase broadcast
+    MPI_Request phaseRequest;		// phase broadcast in flight
+    bool phasesFinished;		// received Phase_Finish
+    std::vector<char> dataPool;		// reused buffer for received data
+    char * pData;			// received data
+    std::size_t dataSize;		// bytes of received data
+    int dataID;				// ID of received data
+
+    void Create (			// create the TaskAdapter
+      TaskFactoryPtr pTaskFactory);
+    bool IsDone () const;		// true if event loop is finished
+    void TakeAction ();			// do the needed action
+    ActionNeeded ProcessMessage (	// message from the matched probe
+      MPI_Message & message,
+      MPI::Status const & status);
+    bool WaitForMessage (		// false if a phase broadcast arrived
+      MPI_Message & message,
+      MPI::Status & status);
+    ActionNeeded TakePhaseAction ();	// action for received phase
+    void PostPhaseReceive ();		// start the next phase broadcast
+    void WaitForPhaseFinish ();		// wait until Phase_Finish
+    void ReceiveData (			// receive Tag_Data and its chunks
+      MPI_Message & message,
+      MPI::Status const & status);
     void SendStateToController ();
     void LogState();
+    void SetAndLogState (		// log, then send to the Controller
+      State const newState);
 
     void DoActionInitialize ();
     void DoActionStart ();
@@ -109,6 +192,8 @@ class Task : public SendsMsgsToLog
     void DoActionPause ();
     void DoActionResume ();
     void DoActionAcceptData ();
+    void DoActionWorkItem ();
+    void LogWorkStatistics ();
 
     // functions that should not be used
     Task (Task const & object);
@@ -6,6 +6,11 @@
 		The concrete MPI task class will be derived from TaskAdapterBase.
 		The private virtual functions Do* will be implemented in the
 		derived task.
+
+		Data sent by Controller::SendData is received into the buffer
+		returned by DoGetDataBuffer, or into a buffer owned by the Task
+		if DoGetDataBuffer returns a null pointer, and then passed to DoAcceptData.
+		The default DoAcceptData discards the data.
 @internal
 project		Master-Task-Blackboard MPI Framework
 @author		Thomas E. Hilinski <https://github.com/tehilinski>
@@ -20,6 +25,7 @@ project		Master-Task-Blackboard MPI Framework
 
 #include "State.h"
 #include "UtilitiesMPI.h"
+#include <cstddef>
 
 namespace mtbmpi {
 
@@ -51,6 +57,19 @@ class TaskAdapterBase
     State PauseTask ()      { return DoPauseTask ();      /* virtual */ }	///< Pause  task execution
     State ResumeTask ()     { return DoResumeTask ();     /* virtual */ }	///< Resume a paused task
 
+    /// Get a buffer of at least size bytes to receive data; null to use the Task's buffer
+    char * GetDataBuffer (
+      int const dataID,			///< ID of the data, from the sender
+      std::size_t const size)		///< number of bytes
+      { return DoGetDataBuffer (dataID, size); }
+
+    /// Accept data received from the Controller
+    void AcceptData (
+      int const dataID,			///< ID of the data, from the sender
+      char const * const data,		///< received data
+      std::size_t const size)		///< number of bytes
+      { DoAcceptData (dataID, data, size); }
+
     Task const &        GetParent () const { return parent; }		///< task parent object
     Task &              GetParent ()       { return parent; }		///< task parent object
     std::string const & GetName () const   { return name; }		///< task name
@@ -69,6 +88,12 @@ class TaskAdapterBase
     virtual State DoPauseTask () = 0;		///< Pause task execution; derived class implements this
     virtual State DoResumeTask () = 0;		///< Resume a paused task; derived class implements this
 
+    /// Buffer for received data; derived class can implement this
+    virtual char * DoGetDataBuffer ( int const, std::size_t const ) { return nullptr; }
+
+    /// Accept received data; derived class can implement this
+    virtual void DoAcceptData ( int const, char const * const, std::size_t const ) {}
+
     // functions that should not be used; are not defined
     /// @cond SKIP_PRIVATE
     TaskAdapterBase (TaskAdapterBase const & object);
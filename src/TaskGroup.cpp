@@ -0,0 +1,207 @@
+/*------------------------------------------------------------------------------------------------------------
+file		TaskGroup.cpp
+class		mtbmpi::TaskGroup
+brief 		Base class of a manager of a group of tasks on behalf of the Controller.
+details
+		Summary message to the Controller, Tag_StateSummary:
+		  items completed, items failed, then (task ID, state) pairs
+		  of the tasks whose state changed since the last summary.
+		In work-queue mode, a batch of about one item per task is requested
+		when the group's queue is running low.
+
+project		Master-Task-Blackboard MPI Framework
+author		Thomas E. Hilinski <https://github.com/tehilinski>
+copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#include "TaskGroup.h"
+#include "MsgTags.h"
+#include "UtilitiesMPI.h"
+#include "MatchedProbe.h"
+#include "ErrorHandling.h"
+
+namespace mtbmpi {
+
+
+TaskGroup::TaskGroup (
+    std::string const & useClassName,	// for error messages
+    IDNum const myId,			// rank of the group's manager
+    IDNum const blackBoardID,		// blackboard rank
+    IDNum const controllerID,		// Controller rank
+    int const numTasks,			// number of tasks in the group
+    IDNum const firstTaskID)		// ID of the 1st task in the group
+    : SendsMsgsToLog (myId, blackBoardID),
+      className ( useClassName ),
+      idController (controllerID),
+      idFirstTask (firstTaskID),
+      stateChanged ( numTasks, false ),
+      numCompleted (0),
+      numFailed (0),
+      workQueueMode (false),
+      requestedWork (false),
+      controllerQueueEmpty (false),
+      stopRequested (false)
+{
+    pTracker.reset ( new Tracker (numTasks) );
+    workQueue.SetNumberOfTasks( numTasks );
+}
+
+/// @cond SKIP_PRIVATE
+
+void TaskGroup::SetTaskState (
+    IDNum const taskID,
+    State const newState)
+{
+    size_type const taskNum = taskID - idFirstTask;
+    if ( taskID < idFirstTask || taskNum >= GetTracker().Size() )
+	return;			// not my task
+
+    GetTracker().SetState ( taskNum, newState );
+    stateChanged[taskNum] = true;
+
+    // work-queue mode: a finished item gets the task its next item
+    if ( workQueueMode &&
+	 ( IsCompleted(newState) || IsError(newState) ) &&
+	 workQueue.ItemFinished( taskNum, IsCompleted(newState) ) )
+    {
+	if ( IsCompleted(newState) )
+	    ++numCompleted;
+	else
+	    ++numFailed;
+	SendNextWorkItem( taskNum );
+    }
+}
+
+void TaskGroup::DoActionWorkItems ( MPI_Message & message, MPI::Status & status )
+{
+    int const count = status.Get_count (MPI::CHAR);
+    std::string buffer( count + 1, NULL_CHAR );
+    Mrecv ( &buffer[0], count, MPI::CHAR, message );
+    requestedWork = false;
+
+    if ( !workQueueMode )
+    {
+	// 1st batch: all tasks are waiting for work
+	workQueueMode = true;
+	for ( size_type taskNum = 0; taskNum < GetTracker().Size(); ++taskNum )
+	    idleTasks.push_back( taskNum );
+    }
+
+    // an empty batch means the Controller's queue is empty
+    if ( workQueue.AppendBatch( buffer.data(), count ) == 0 )
+	controllerQueueEmpty = true;
+
+    // give items to waiting tasks; a task is queued again if no item
+    size_type numWaiting = idleTasks.size();
+    while ( numWaiting-- > 0 )
+    {
+	size_type const taskNum = idleTasks.front();
+	idleTasks.pop_front();
+	SendNextWorkItem( taskNum );
+    }
+    RequestWorkItems ();
+}
+
+void TaskGroup::SendSummary ()
+{
+    // summary: items completed, items failed, then (task ID, state) pairs
+    std::vector<int> buffer;
+    buffer.push_back( static_cast<int>(numCompleted) );
+    buffer.push_back( static_cast<int>(numFailed) );
+    for ( size_type taskNum = 0; taskNum < stateChanged.size(); ++taskNum )
+    {
+	if ( stateChanged[taskNum] )
+	{
+	    buffer.push_back( idFirstTask + taskNum );
+	    buffer.push_back( static_cast<int>( GetTracker().GetState(taskNum) ) );
+	    stateChanged[taskNum] = false;
+	}
+    }
+    if ( buffer.size() == 2 && numCompleted == 0 && numFailed == 0 )
+	return;			// nothing new
+
+    mtbmpi::comm.Send (
+	    buffer.data(), buffer.size(), MPI::INT,
+	    idController, Tag_StateSummary );
+    CheckErrorMPI( className );
+    numCompleted = numFailed = 0;
+}
+
+bool TaskGroup::AreAllTasksStopped () const
+{
+    if ( !workQueueMode )
+	return GetTracker().AreAllStopped();
+
+    // work-queue mode: completed tasks are waiting for work items
+    return GetTracker().GetCount(State_Terminated) == GetTracker().Size();
+}
+
+void TaskGroup::StopAllTasks ()
+{
+    stopRequested = true;
+    idleTasks.clear();
+    for ( size_type taskNum = 0; taskNum < GetTracker().Size(); ++taskNum )
+    {
+	State const state = GetTracker().GetState(taskNum);
+	// in work-queue mode a completed task waits for its next item
+	bool const isWaiting = ( workQueueMode && !workQueue.IsTaskDone(taskNum) );
+	if ( isWaiting ||
+	     ( state != State_Completed &&
+	       state != State_Terminated &&
+	       state != State_Error ) )
+	{
+	    DoStopTask( taskNum );
+	    workQueue.SetTaskDone( taskNum );
+	}
+    }
+}
+
+void TaskGroup::SendNextWorkItem (
+    size_type const taskNum)
+{
+    WorkItem item;
+    if ( !stopRequested && workQueue.Next( item ) )
+    {
+	// task is busy until it reports the item is completed
+	GetTracker().SetState( taskNum, State_Created );
+	stateChanged[taskNum] = true;
+	workQueue.ItemDispatched( taskNum );
+	DoSendWorkItem( taskNum, item );
+    }
+    else if ( stopRequested || controllerQueueEmpty )
+    {
+	// no more work; this task is done
+	if ( !workQueue.IsTaskDone( taskNum ) )
+	{
+	    workQueue.SetTaskDone( taskNum );
+	    DoStopTask( taskNum );
+	}
+    }
+    else // wait for the next batch
+    {
+	idleTasks.push_back( taskNum );
+    }
+    RequestWorkItems ();
+}
+
+void TaskGroup::RequestWorkItems ()
+{
+    // keep about one waiting item per task
+    if ( requestedWork || controllerQueueEmpty || stopRequested )
+	return;
+    if ( workQueue.Size() >= GetTracker().Size() )
+	return;
+
+    int maxItems = static_cast<int>( GetTracker().Size() );
+    mtbmpi::comm.Send ( &maxItems, 1, MPI::INT, idController, Tag_RequestWorkItems );
+    CheckErrorMPI( className );
+    requestedWork = true;
+}
+
+/// @endcond
+
+
+} // namespace mtbmpi
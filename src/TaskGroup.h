@@ -0,0 +1,114 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		TaskGroup.h
+@class		mtbmpi::TaskGroup
+@brief 		Base class of a manager of a group of tasks on behalf of the Controller.
+@details
+		The bookkeeping shared by SubController and TaskHost:
+		the states of the group's tasks, which are sent to the Controller
+		in Tag_StateSummary messages, and in work-queue mode, the work
+		items received from the Controller in batches and handed out
+		to the tasks one at a time.
+
+		A derived class receives the messages, and gives a task a work item
+		or a stop request in its own way: DoSendWorkItem and DoStopTask.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_TaskGroup_h
+#define INC_mtbmpi_TaskGroup_h
+
+#include "SendsMsgsToLog.h"
+#include "Tracker.h"
+#include "State.h"
+#include "WorkQueue.h"
+#include <memory>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace mtbmpi {
+
+
+class TaskGroup : public SendsMsgsToLog
+{
+  public:
+
+    typedef std::shared_ptr<Tracker>		TrackerPtr;
+
+    Tracker & GetTracker () const { return *pTracker; }
+
+  protected:
+
+    /// @cond SKIP_PRIVATE
+
+    typedef Tracker::size_type		size_type;
+
+    /// Constructor
+    TaskGroup (
+      std::string const & useClassName,	// for error messages
+      IDNum const myId,			// rank of the group's manager
+      IDNum const blackBoardID,		// blackboard rank
+      IDNum const controllerID,		// Controller rank
+      int const numTasks,		// number of tasks in the group
+      IDNum const firstTaskID);		// ID of the 1st task in the group
+
+    virtual ~TaskGroup () {}
+
+    std::string const className;
+    IDNum const idController;		// rank of Controller
+    IDNum const idFirstTask;		// ID of 1st task in the group
+
+    void SetTaskState (			// ignores tasks not in the group
+      IDNum const taskID,
+      State const newState);
+    void DoActionWorkItems ( MPI_Message & message, MPI::Status & status );
+    void SendSummary ();		// send changed states to Controller
+    bool AreAllTasksStopped () const;
+    void StopAllTasks ();
+
+    /// @endcond
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    TrackerPtr pTracker;
+    std::vector<bool> stateChanged;	// task state changed since last summary
+    WorkQueue workQueue;		// work items received from the Controller
+    std::deque<size_type> idleTasks;	// tasks waiting for a work item
+    WorkQueue::IndexNum numCompleted;	// items completed since last summary
+    WorkQueue::IndexNum numFailed;	// items failed since last summary
+    bool workQueueMode;			// true after 1st batch of work items
+    bool requestedWork;			// waiting for a batch of work items
+    bool controllerQueueEmpty;		// Controller has no more work items
+    bool stopRequested;			// Controller requested stop
+
+    void SendNextWorkItem (		// next item, stop, or wait for a batch
+      size_type const taskNum);
+    void RequestWorkItems ();		// request a batch if running low
+
+    // how the derived class gives its tasks a work item, or a stop request
+    virtual void DoSendWorkItem (
+      size_type const taskNum,
+      WorkItem const & item) = 0;
+    virtual void DoStopTask (
+      size_type const taskNum) = 0;
+
+    // functions that should not be used; are not defined
+    TaskGroup (TaskGroup const & object);
+    TaskGroup & operator= (TaskGroup const & object);
+
+    /// @endcond
+};
+
+
+} // namespace mtbmpi
+
+
+#endif // INC_mtbmpi_TaskGroup_h
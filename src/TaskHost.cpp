@@ -0,0 +1,435 @@
+/*------------------------------------------------------------------------------------------------------------
+file		TaskHost.cpp
+class		mtbmpi::TaskHost
+brief 		Runs several logical tasks in one MPI rank, each in its own thread.
+details
+		The host's thread makes all MPI calls (MPI_THREAD_FUNNELED).
+		A task's thread waits for jobs in its slot, and takes each job's
+		action; the task posts its states, log messages and results,
+		which the host's thread sends. The host waits on the posts
+		between its polls for messages, so a post is sent promptly.
+
+		The host's bookkeeping of its tasks and work items is in TaskGroup,
+		shared with the SubController; the Controller cannot tell them apart.
+
+project		Master-Task-Blackboard MPI Framework
+author		Thomas E. Hilinski <https://github.com/tehilinski>
+copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#include "TaskHost.h"
+#include "Master.h"
+#include "UtilitiesMPI.h"
+#include "MatchedProbe.h"
+#include "ErrorHandling.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <sstream>
+#include <stdexcept>
+
+// define the following to write diagnostics to std::cout
+// #define DBG_MPI_TASKHOST
+
+#ifdef DBG_MPI_TASKHOST
+  #include <iostream>
+  using std::cout;
+  using std::endl;
+#endif
+
+namespace mtbmpi {
+
+
+namespace {
+
+    // longest wait for a post before polling for messages again
+    std::chrono::microseconds const pollInterval ( 100 );
+
+    void LogPosted (
+	LoggerMPI & log,
+	LogLevel const level,
+	std::string const & msg,
+	std::string const & idStr)
+    {
+	bool const haveID = !idStr.empty();
+	switch ( level )
+	{
+	  case LogLevel_Trace:
+	    if ( haveID ) log.Trace( msg, idStr ); else log.Trace( msg );
+	    break;
+	  case LogLevel_Debug:
+	    if ( haveID ) log.Debug( msg, idStr ); else log.Debug( msg );
+	    break;
+	  case LogLevel_Warning:
+	    if ( haveID ) log.Warning( msg, idStr ); else log.Warning( msg );
+	    break;
+	  case LogLevel_Error:
+	    if ( haveID ) log.Error( msg, idStr ); else log.Error( msg );
+	    break;
+	  default:
+	    if ( haveID ) log.Message( msg, idStr ); else log.Message( msg );
+	    break;
+	}
+    }
+
+} // namespace
+
+
+TaskHost::TaskHost (
+    Master & useParent,			// parent of host
+    IDNum const myId,			// host rank
+    IDNum const blackBoardID,		// blackboard rank
+    IDNum const controllerID,		// Controller rank
+    int const numThreads,		// number of logical tasks
+    IDNum const firstTaskID,		// logical task ID of the 1st task
+    TaskFactoryPtr pTaskFactory,	// task factory
+    ArgPair args)			// command-line args
+    : TaskGroup ( "mtbmpi::TaskHost", myId, blackBoardID, controllerID, numThreads, firstTaskID ),
+      parent (useParent)
+{
+    // the factory is called from this thread only
+    for ( int i = 0; i < numThreads; ++i )
+    {
+	IDNum const taskID = idFirstTask + i;
+	std::string taskName = "Task "; taskName += ToString(taskID);
+	slots.emplace_back( new Slot() );
+	slots.back()->pTask = std::make_shared<mtbmpi::Task>(
+		parent, *this, taskName, taskID, GetID(), GetBlackboardID(), pTaskFactory, args );
+    }
+}
+
+TaskHost::~TaskHost ()
+{
+    CloseSlots ();
+    slots.clear();		// tasks post their last state to this
+}
+
+void TaskHost::Activate ()
+{
+    #ifdef DBG_MPI_TASKHOST
+      std::string const myName = "TaskHost::Activate: ";
+      cout << myName << "rank " << GetID() << ": enter: "
+	   << GetTracker().Size() << " tasks" << endl;
+    #endif
+
+    for ( auto & pSlot : slots )
+	pSlot->thread = std::thread( &TaskHost::RunTask, this, std::ref(*pSlot) );
+
+    // limits the time between summaries when messages arrive continuously
+    size_type const maxMsgsPerSummary = 4 * GetTracker().Size() + 1;
+
+    bool tasksAreCreated = false;
+    bool listenForMsgs = true;
+    while (listenForMsgs)				// event loop
+    {
+	// handle all waiting messages, and the tasks' posts
+	MPI_Message message;
+	MPI::Status status;
+	size_type numMsgs = 0;
+	while ( numMsgs < maxMsgsPerSummary &&
+		Improbe ( mtbmpi::comm, MPI_ANY_SOURCE, MPI_ANY_TAG, message, status ) )
+	{
+	    ProcessMessage (message, status);
+	    ++numMsgs;
+	}
+	bool const havePosts = SendPosted ();
+
+	// one message to the Controller for all of the above
+	SendSummary ();
+
+	if ( !tasksAreCreated )
+	    tasksAreCreated = GetTracker().AreAllCreated();
+	if ( tasksAreCreated && AreAllTasksStopped() )
+	    listenForMsgs = false;
+	else if ( numMsgs == 0 && !havePosts )
+	{
+	    Log().FlushIfDue();
+	    std::unique_lock<std::mutex> lock ( postedMutex );
+	    postedWakeup.wait_for( lock, pollInterval, [this] { return !posted.empty(); } );
+	}
+    }
+
+    // the tasks' last states and messages
+    CloseSlots ();
+    SendPosted ();
+    SendSummary ();
+
+    std::ostringstream os;
+    os << "Task host " << GetID() << ": " << GetTracker().Size()
+       << " tasks are stopped.";
+    Log().Message( os.str() );
+    Log().Flush();
+
+    #ifdef DBG_MPI_TASKHOST
+      cout << myName << "rank " << GetID() << ": done" << endl;
+    #endif
+}
+
+void TaskHost::PostState (
+    IDNum const taskID,
+    State const state)
+{
+    Posted item;
+    item.kind = Posted::Posted_State;
+    item.value = taskID;
+    item.state = static_cast<int>(state);
+    Post ( item );
+}
+
+void TaskHost::PostLog (
+    LogLevel const level,
+    std::string const & msg,
+    std::string const & idStr)
+{
+    if ( !LoggerMPI::IsEnabled( level ) )
+	return;
+    Posted item;
+    item.kind = Posted::Posted_Log;
+    item.value = static_cast<int>(level);
+    item.state = 0;
+    item.text = msg;
+    item.idStr = idStr;
+    Post ( item );
+}
+
+void TaskHost::PostResult (
+    char const * const data,
+    std::size_t const size)
+{
+    Posted item;
+    item.kind = Posted::Posted_Result;
+    item.value = 0;
+    item.state = 0;
+    item.text.assign( data, size );
+    Post ( item );
+}
+
+/// @cond SKIP_PRIVATE
+
+void TaskHost::RunTask (
+    Slot & slot)
+{
+    SetHostedTaskThread ();	// MPI calls by the adapter throw
+    Task & task = *slot.pTask;
+    while ( true )
+    {
+	Job job;
+	{
+	    std::unique_lock<std::mutex> lock ( slot.mutex );
+	    slot.wakeup.wait( lock, [&slot] { return !slot.jobs.empty() || slot.closing; } );
+	    if ( slot.jobs.empty() )
+		break;			// closing
+	    job = slot.jobs.front();
+	    slot.jobs.pop_front();
+	}
+
+	// the job's data stays valid until the action is done
+	task.action = job.action;
+	if ( job.action == Task::ActionWorkItem )
+	    task.workItem = job.item;
+	else if ( job.action == Task::ActionAcceptData )
+	{
+	    task.pData = job.pData->data();
+	    task.dataSize = job.pData->size();
+	    task.dataID = job.dataID;
+	}
+	try
+	{
+	    task.TakeAction ();
+	}
+	catch ( std::exception const & e )
+	{
+	    // the task fails, not the host and its other tasks
+	    task.SendMsgToLog( e.what() );
+	    task.SetAndLogState( State_Error );
+	}
+	task.pData = nullptr;
+	if ( task.IsDone() )
+	    break;
+    }
+    slot.pTask.reset();		// posts State_Terminated
+}
+
+void TaskHost::PostJob (
+    size_type const taskNum,
+    Job const & job)
+{
+    Slot & slot = *slots[taskNum];
+    {
+	std::lock_guard<std::mutex> lock ( slot.mutex );
+	slot.jobs.push_back( job );
+    }
+    slot.wakeup.notify_one();
+}
+
+void TaskHost::PostToAllTasks (
+    Task::ActionNeeded const action)
+{
+    Job job;
+    job.action = action;
+    for ( size_type taskNum = 0; taskNum < slots.size(); ++taskNum )
+	PostJob( taskNum, job );
+}
+
+void TaskHost::Post (
+    Posted & item)
+{
+    {
+	std::lock_guard<std::mutex> lock ( postedMutex );
+	posted.push_back( std::move(item) );
+    }
+    postedWakeup.notify_one();
+}
+
+bool TaskHost::SendPosted ()
+{
+    {
+	std::lock_guard<std::mutex> lock ( postedMutex );
+	sending.swap( posted );
+    }
+    if ( sending.empty() )
+	return false;
+
+    // in the order posted, so a task's log messages precede its new state
+    for ( Posted const & item : sending )
+    {
+	switch ( item.kind )
+	{
+	  case Posted::Posted_State:
+	    SetTaskState( item.value, static_cast<State>( item.state ) );
+	    break;
+	  case Posted::Posted_Log:
+	    LogPosted( Log(), static_cast<LogLevel>( item.value ), item.text, item.idStr );
+	    break;
+	  case Posted::Posted_Result:
+	    mtbmpi::SendResultRecord( item.text.data(), item.text.size(), GetBlackboardID() );
+	    break;
+	}
+    }
+    sending.clear();
+    return true;
+}
+
+void TaskHost::CloseSlots ()
+{
+    for ( auto & pSlot : slots )
+    {
+	{
+	    std::lock_guard<std::mutex> lock ( pSlot->mutex );
+	    pSlot->closing = true;
+	}
+	pSlot->wakeup.notify_one();
+    }
+    for ( auto & pSlot : slots )
+    {
+	if ( pSlot->thread.joinable() )
+	    pSlot->thread.join();
+    }
+}
+
+void TaskHost::ProcessMessage (
+    MPI_Message & message,		// from the matched probe
+    MPI::Status & status)
+{
+    switch ( status.Get_tag() )
+    {
+      case Tag_WorkItems:
+	DoActionWorkItems (message, status);
+	break;
+
+      case Tag_Data:
+	DoActionData (message, status);
+	break;
+
+      case Tag_InitializeTask:
+	DiscardMatched ( message, status );
+	PostToAllTasks ( Task::ActionInitialize );
+	break;
+
+      case Tag_StartTask:
+	DiscardMatched ( message, status );
+	PostToAllTasks ( Task::ActionStart );
+	break;
+
+      case Tag_RequestPauseTask:
+	DiscardMatched ( message, status );
+	PostToAllTasks ( Task::ActionPause );
+	break;
+
+      case Tag_RequestResumeTask:
+	DiscardMatched ( message, status );
+	PostToAllTasks ( Task::ActionResume );
+	break;
+
+      case Tag_RequestStopTask:
+      case Tag_RequestStop:
+	DiscardMatched ( message, status );
+	StopAllTasks ();
+	break;
+
+      default:
+      {
+	// unhandled message - mark as received but discard
+	DiscardMatched ( message, status );
+	#ifdef DBG_MPI_TASKHOST
+	  cout << "TaskHost: rank " << GetID()
+	       << ": discarded msg with tag " << status.Get_tag()
+	       << " from " << status.Get_source() << endl;
+	#endif
+	break;
+      }
+    }
+}
+
+void TaskHost::DoActionData ( MPI_Message & message, MPI::Status & status )
+{
+    // header: total bytes, data ID
+    long long header[2] = { 0, 0 };
+    int const source = status.Get_source();
+    Mrecv ( header, 2, MPI::LONG_LONG, message );
+    std::size_t const dataSize = static_cast<std::size_t>( std::max( header[0], 0LL ) );
+
+    // one buffer for all tasks; chunks are at most INT_MAX bytes
+    Job job;
+    job.action = Task::ActionAcceptData;
+    job.pData = std::make_shared< std::vector<char> >( dataSize );
+    job.dataID = static_cast<int>( header[1] );
+    std::size_t offset = 0;
+    while ( offset < dataSize )
+    {
+	int const count = static_cast<int>(
+	    std::min( dataSize - offset, static_cast<std::size_t>(INT_MAX) ) );
+	MPI::Status recvStatus;
+	mtbmpi::dataComm.Recv ( job.pData->data() + offset, count, MPI::BYTE,
+				source, Tag_DataChunk, recvStatus );
+	offset += recvStatus.Get_count( MPI::BYTE );
+    }
+    for ( size_type taskNum = 0; taskNum < slots.size(); ++taskNum )
+	PostJob( taskNum, job );
+}
+
+void TaskHost::DoSendWorkItem (
+    size_type const taskNum,
+    WorkItem const & item)
+{
+    Job job;
+    job.action = Task::ActionWorkItem;
+    job.item = item;
+    PostJob( taskNum, job );
+}
+
+void TaskHost::DoStopTask (
+    size_type const taskNum)
+{
+    Job job;
+    job.action = Task::ActionStop;
+    PostJob( taskNum, job );
+}
+
+/// @endcond
+
+
+} // namespace mtbmpi
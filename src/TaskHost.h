@@ -0,0 +1,195 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		TaskHost.h
+@class		mtbmpi::TaskHost
+@brief 		Runs several logical tasks in one MPI rank, each in its own thread.
+@details
+		Used when the option `--mtbmpi-task-threads=N` is given, with N > 1:
+		each work rank is a task host, which owns N Task objects,
+		each with a TaskAdapter made by the same TaskFactoryBase,
+		so a job can have more concurrent tasks than MPI processes,
+		and tasks on the same node share the process' memory.
+
+		Each logical task has its own thread, which takes the task's actions:
+		initialize, start, stop, pause, resume, accept data, and work items.
+		The thread of the host, which is the main thread, makes all MPI calls:
+		it receives the Controller's messages and relays them to the threads,
+		and sends the states, log messages and results which the tasks post.
+		So MPI is initialized with MPI_THREAD_FUNNELED.
+
+		To the Controller the host is like a SubController of its logical tasks:
+		it tracks their states, and sends the Controller one Tag_StateSummary
+		message with the states that changed. In work-queue mode, it requests
+		batches of work items, and hands them out to its threads one at a time.
+		The Controller's Tracker has one entry for each logical task.
+		The logical task ID of thread i of the host with rank r is
+		`f + (r - f) * N + i`, where f is Master::GetFirstTaskID().
+
+		Data sent to a host's rank by Controller::SendData is received once,
+		and given to the AcceptData of each of its tasks.
+
+		A TaskAdapter run by a host must not make MPI calls:
+		it sends log messages with Task::SendMsgToLog
+		and results with Task::SendResultRecord.
+		A ResultStream, mtbmpi::SendResultRecord or BinaryWriter::Send
+		in a task thread throws std::runtime_error; the host logs the
+		error and sets the task's state to State_Error.
+		Result streams are not available to hosted tasks.
+		The task factory is called from the host's thread only.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_TaskHost_h
+#define INC_mtbmpi_TaskHost_h
+
+#include "TaskGroup.h"
+#include "Task.h"
+#include "LogLevel.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mtbmpi {
+
+
+class Master;
+
+class TaskHost : public TaskGroup
+{
+  public:
+
+    typedef std::shared_ptr<TaskFactoryBase>			TaskFactoryPtr;
+    typedef std::pair< int const, char const * const * >	ArgPair;	///< command-line arc, argv
+
+    /// Constructor; creates the logical tasks
+    TaskHost (
+      Master & useParent,		///< parent of host
+      IDNum const myId,			///< host rank
+      IDNum const blackBoardID,		///< blackboard rank
+      IDNum const controllerID,		///< Controller rank
+      int const numThreads,		///< number of logical tasks
+      IDNum const firstTaskID,		///< logical task ID of the 1st task
+      TaskFactoryPtr pTaskFactory,	///< task factory
+      ArgPair args			///< command-line args
+      );	// here for doxygen bug
+
+    /// Destructor; waits for the threads
+    ~TaskHost ();
+
+    /// Start the threads and the main loop of the host.
+    /// Returns when all of its tasks are stopped.
+    void Activate ();
+
+    /// Number of logical tasks
+    int GetNumberOfThreads () const { return static_cast<int>( slots.size() ); }
+
+    //--- called by the hosted tasks, from any thread ---
+
+    /// Post a task state for the Controller
+    void PostState (
+      IDNum const taskID,		///< logical task ID
+      State const state);		///< new state
+
+    /// Post a log message
+    void PostLog (
+      LogLevel const level,		///< message level
+      std::string const & msg,		///< message
+      std::string const & idStr);	///< task ID string; can be empty
+
+    /// Post a result record for the Blackboard
+    void PostResult (
+      char const * const data,		///< record bytes
+      std::size_t const size);		///< number of bytes
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    typedef std::shared_ptr< std::vector<char> >	DataPtr;
+
+    // an action for a task's thread
+    struct Job
+    {
+	Task::ActionNeeded action;
+	WorkItem item;			// ActionWorkItem
+	DataPtr pData;			// ActionAcceptData
+	int dataID;
+
+	Job ()
+	  : action (Task::NoAction),
+	    dataID (0)
+	  {
+	  }
+    };
+
+    // a logical task and its thread
+    struct Slot
+    {
+	std::shared_ptr<Task> pTask;
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wakeup;
+	std::deque<Job> jobs;
+	bool closing;			// no more jobs
+
+	Slot () : closing (false) {}
+    };
+
+    // posted by a task for the host's thread to send
+    struct Posted
+    {
+	enum Kind { Posted_State, Posted_Log, Posted_Result };
+	Kind kind;
+	int value;			// task ID, or log level
+	int state;
+	std::string text;		// log message, or result record
+	std::string idStr;
+    };
+
+    Master & parent;
+    std::vector< std::unique_ptr<Slot> > slots;
+    std::mutex postedMutex;
+    std::condition_variable postedWakeup;
+    std::vector<Posted> posted;		// filled by the tasks
+    std::vector<Posted> sending;	// emptied by the host
+
+    void RunTask ( Slot & slot );	// thread of a task
+    void PostJob (			// give a task an action
+      size_type const taskNum,
+      Job const & job);
+    void PostToAllTasks (
+      Task::ActionNeeded const action);
+    void Post ( Posted & item );
+    bool SendPosted ();			// false if nothing was posted
+    void CloseSlots ();			// end the threads
+
+    void ProcessMessage ( MPI_Message & message, MPI::Status & status );
+    void DoActionData ( MPI_Message & message, MPI::Status & status );
+    void DoSendWorkItem (		// ActionWorkItem job
+      size_type const taskNum,
+      WorkItem const & item);
+    void DoStopTask (			// ActionStop job
+      size_type const taskNum);
+
+    // functions that should not be used; are not defined
+    TaskHost (TaskHost const & object);
+    TaskHost & operator= (TaskHost const & object);
+    bool operator== (TaskHost const & object) const;
+    bool operator!= (TaskHost const & object) const;
+
+    /// @endcond
+};
+
+
+} // namespace mtbmpi
+
+
+#endif // INC_mtbmpi_TaskHost_h
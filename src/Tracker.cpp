@@ -4,6 +4,7 @@ class		mtbmpi::Tracker
 brief 		Tracks the state of each tasks process, not including the
 		Master, Controller, and Blackboard.
 details		Task IDs are zero-based, and include only work tasks.
+		The number of tasks in each state is updated by SetState.
 project		Master-Task-Blackboard MPI Framework
 author		Thomas E. Hilinski <https://github.com/tehilinski>
 copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
@@ -19,10 +20,15 @@ copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
 namespace mtbmpi {
 
 
+Tracker::size_type const Tracker::numCounts;
+
 Tracker::Tracker (
     int const numTasks)		// number of work processes
 {
     taskStateArray.assign (numTasks, State_Unknown);
+    stateCount.assign (numCounts, 0);
+    stateCount[State_Unknown] = taskStateArray.size();
+    transitionTime.assign (numTasks, Clock::now());
 }
 
 State Tracker::SetState (		// set task state
@@ -32,6 +38,12 @@ State Tracker::SetState (		// set task state
     if ( index < taskStateArray.size() )
     {
 	State const oldState = taskStateArray[index];
+	if ( newState != oldState )
+	{
+	    --stateCount[ CountIndex(oldState) ];
+	    ++stateCount[ CountIndex(newState) ];
+	    transitionTime[index] = Clock::now();
+	}
 	taskStateArray[index] = newState;
 	return oldState;
     }
@@ -44,43 +56,12 @@ State Tracker::SetState (		// set task state
     }
 }
 
-bool Tracker::AreAllCreated () const	// true if all tasks created
+double Tracker::GetTimeInState (	// seconds in current state
+    size_type const index) const	//   at zero-based index
 {
-    bool created = true;
-    StateArray::const_iterator i = taskStateArray.begin();
-    while ( i != taskStateArray.end() && created )
-    {
-	created &= IsCreated( *i );
-	++i;
-    }
-    return created;
-}
-
-bool Tracker::AreAllInitialized () const	// true if all tasks initialized
-{
-    bool allInit = true;
-    StateArray::const_iterator i = taskStateArray.begin();
-    while ( i != taskStateArray.end() && allInit )
-    {
-	allInit &= IsInitialized( *i );
-	++i;
-    }
-    return allInit;
-}
-
-bool Tracker::AreAllStopped () const	// true if all tasks stopped
-{
-    bool stopped = true;
-    StateArray::const_iterator i = taskStateArray.begin();
-    while ( i != taskStateArray.end() && stopped )
-    {
-	stopped &= ( IsCompleted( *i ) ||
-		     IsTerminated( *i ) ||
-		     IsError( *i ) ||
-		     IsUnknown( *i ) );
-	++i;
-    }
-    return stopped;
+    std::chrono::duration<double> const elapsed =
+	Clock::now() - transitionTime[index];
+    return elapsed.count();
 }
 
 
@@ -4,6 +4,11 @@
 @brief 		Tracks the state of each tasks process, not including the
 		Master, Controller, and Blackboard.
 @details	Task IDs are zero-based, and include only work tasks.
+
+		The number of tasks in each state is updated by SetState,
+		so the AreAll* queries and GetCount are constant time.
+		SetState also records the monotonic time of each state change,
+		so the time a task has been in its current state is available cheaply.
 @internal
 project		Master-Task-Blackboard MPI Framework
 @author		Thomas E. Hilinski <https://github.com/tehilinski>
@@ -19,6 +24,7 @@ project		Master-Task-Blackboard MPI Framework
 #include "State.h"
 #include "MsgTags.h"
 #include <vector>
+#include <chrono>
 
 namespace mtbmpi {
 
@@ -30,6 +36,8 @@ class Tracker
     typedef std::vector<State>			StateArray;	///< Array of states, one per task
     typedef StateArray::size_type		size_type;	///< length of StateArray
     typedef StateArray::const_iterator		const_iterator;
+    typedef std::chrono::steady_clock		Clock;		///< monotonic clock
+    typedef Clock::time_point			TimePoint;	///< time of a state change
 
     /// Constructor
     Tracker (
@@ -54,15 +62,48 @@ class Tracker
     const_iterator Begin () const { return taskStateArray.begin(); }	///< starting iterator of States
     const_iterator End ()   const { return taskStateArray.end(); }	///< end iterator of States
 
-    bool AreAllCreated () const;		///< true if all tasks created
-    bool AreAllInitialized () const;		///< true if all tasks initialized
-    bool AreAllStopped () const;		///< true if all tasks stopped
+    /// number of tasks in a state
+    size_type GetCount (
+      State const state			///< task state
+      ) const // this is here because of doxygen bug
+      { return stateCount[ CountIndex(state) ]; }
+
+    /// time of the task's last state change; construction time if none
+    TimePoint GetTransitionTime (
+      size_type const index			///< task index in state array is zero-based
+      ) const // this is here because of doxygen bug
+      { return transitionTime[index]; }
+
+    /// seconds the task has been in its current state
+    double GetTimeInState (
+      size_type const index			///< task index in state array is zero-based
+      ) const; // this is here because of doxygen bug
+
+    bool AreAllCreated () const			///< true if all tasks created
+      { return GetCount(State_Created) == Size(); }
+    bool AreAllInitialized () const		///< true if all tasks initialized
+      { return GetCount(State_Initialized) == Size(); }
+    bool AreAllStopped () const			///< true if all tasks stopped
+      {
+	return GetCount(State_Completed) + GetCount(State_Terminated) +
+	       GetCount(State_Error) + GetCount(State_Unknown) == Size();
+      }
 
   private:
 
     /// @cond SKIP_PRIVATE
 
+    static size_type const numCounts = State_Unknown + 1;
+
     StateArray taskStateArray;			// task states
+    std::vector<size_type> stateCount;		// number of tasks in each state
+    std::vector<TimePoint> transitionTime;	// time of last state change
+
+    static size_type CountIndex ( State const state )
+      {
+	size_type const i = static_cast<size_type>(state);
+	return ( i < numCounts ? i : static_cast<size_type>(State_Unknown) );
+      }
 
     // functions that should not be used; are not defined
     Tracker (Tracker const & object);
@@ -0,0 +1,43 @@
+/*------------------------------------------------------------------------------------------------------------
+file		TrafficComms.cpp
+brief 		Communicators for each class of framework messages.
+details		The traffic communicators are duplicates of comm,
+		so they have its error handler.
+project		Master-Task-Blackboard MPI Framework
+author		Thomas E. Hilinski <https://github.com/tehilinski>
+copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#include "TrafficComms.h"
+#include "versionMTBMPI.h"
+
+namespace mtbmpi {
+
+
+MPI::Intracomm comm;					///< global communicator for tasks
+MPI::Intracomm logComm;					///< global communicator for log messages
+MPI::Intracomm resultComm;				///< global communicator for task results
+MPI::Intracomm dataComm;				///< global communicator for data to tasks
+
+
+void CreateTrafficComms ()
+{
+    // all ranks of comm must call this
+    struct { MPI::Intracomm * pComm; char const * name; } const comms[] =
+    {
+	{ &mtbmpi::logComm,	" log" },
+	{ &mtbmpi::resultComm,	" results" },
+	{ &mtbmpi::dataComm,	" data" }
+    };
+    for ( auto const & c : comms )
+    {
+	*c.pComm = mtbmpi::comm.Dup();
+	c.pComm->Set_name( ( versionMTBMPI.ProductNameShort() + c.name ).c_str() );
+    }
+}
+
+
+} // namespace mtbmpi
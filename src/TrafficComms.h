@@ -0,0 +1,111 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		TrafficComms.h
+@brief 		Communicators for each class of framework messages.
+@details
+		The framework's messages are sent on four duplicates of MPI::COMM_WORLD,
+		one for each class of traffic, so that a large result or log batch
+		is never ahead of a state or stop message in a matching queue,
+		and a probe for control messages does not search the bulk messages:
+		- comm:		control messages: task states; the initialize, start,
+				stop, pause and resume requests; work items; and the
+				Tag_Data header, so that data keeps its order with the requests.
+		- logComm:	log messages, errors, log batches and binary log records;
+				and the Controller's Tag_StopBlackboard, which must
+				follow the Controller's last log message.
+		- resultComm:	task results, result streams and their credits,
+				and result window notices.
+		- dataComm:	the chunks of data sent by Controller::SendData.
+
+		The Master creates all four on every rank.
+		The Controller and the tasks probe only comm.
+		The Blackboard probes comm for control requests first, then takes turns
+		among comm, logComm and resultComm.
+		A reply is sent on the communicator of the request, so a result
+		sent on comm, as in earlier versions, is still received,
+		except by a Blackboard in a thread of the Controller's rank,
+		which leaves comm to the Controller and does not probe it;
+		the Controller then discards results and log messages sent on comm,
+		and logs an error for each.
+
+		GetTrafficComm gives the communicator for a message tag.
+		A program which uses the framework's classes without a Master
+		creates comm, then calls CreateTrafficComms on every rank.
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_TrafficComms_h
+#define INC_mtbmpi_TrafficComms_h
+
+#include "mpi.h"
+#include "MsgTags.h"
+
+namespace mtbmpi {
+
+
+// global communicators; created by Master
+extern MPI::Intracomm comm;		///< control messages
+extern MPI::Intracomm logComm;		///< log messages
+extern MPI::Intracomm resultComm;	///< task results
+extern MPI::Intracomm dataComm;		///< data chunks to tasks
+
+/// Duplicate comm into logComm, resultComm and dataComm.
+/// Collective over comm; call after comm is created.
+void CreateTrafficComms ();
+
+/// Classes of framework messages; each has its own communicator.
+enum TrafficClass
+{
+    Traffic_Control,
+    Traffic_Log,
+    Traffic_Result,
+    Traffic_Data
+};
+
+/// Get the class of the messages with a tag
+inline TrafficClass GetTrafficClass ( int const tag )
+{
+    switch ( tag )
+    {
+      case Tag_LogMessage:
+      case Tag_ErrorMessage:
+      case Tag_LogBatch:
+      case Tag_LogFlushed:
+      case Tag_LogRecord:
+      case Tag_StopBlackboard:		// after the Controller's log messages
+	return Traffic_Log;
+      case Tag_TaskResults:
+      case Tag_ResultBegin:
+      case Tag_ResultChunk:
+      case Tag_ResultEnd:
+      case Tag_ResultCredit:
+      case Tag_ResultRecord:
+	return Traffic_Result;
+      case Tag_DataChunk:
+	return Traffic_Data;
+      default:
+	return Traffic_Control;
+    }
+}
+
+/// Get the communicator for the messages with a tag
+inline MPI::Intracomm & GetTrafficComm ( int const tag )
+{
+    switch ( GetTrafficClass( tag ) )
+    {
+      case Traffic_Log:		return logComm;
+      case Traffic_Result:	return resultComm;
+      case Traffic_Data:	return dataComm;
+      default:			return comm;
+    }
+}
+
+
+} // namespace mtbmpi
+
+#endif // INC_mtbmpi_TrafficComms_h
@@ -12,6 +12,7 @@ copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
 #include "UtilitiesMPI.h"
 #include "ErrorHandling.h"
 #include <cstring>
+#include <thread>
 #ifdef MSWINDOWS
   #include <winbase.h>
 #else
@@ -48,6 +49,18 @@ void Sleep ( unsigned int const usec )
     #endif
 }
 
+void PollBackoff ( int & emptyPolls )
+{
+    int const pollsBeforeSleep = 64;	// yields while polls are empty
+    if ( emptyPolls < pollsBeforeSleep )
+    {
+	++emptyPolls;
+	std::this_thread::yield();
+    }
+    else
+	Sleep( 100 );
+}
+
 StrVec::size_type ToStrVec (
 	StrVec & strArray,
 	char const * const * const beginCStr,
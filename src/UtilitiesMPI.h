@@ -53,6 +53,13 @@ std::string GetMPIProcessorName ();
 ///	@param usec	Sleep duration (microseconds); default is 1000.
 void Sleep ( unsigned int const usec = 1000 );
 
+///	Wait after a poll which found nothing to do:
+///	yields for the first polls, then sleeps briefly,
+///	so that an idle polling loop does not use a core.
+///	@param emptyPolls	consecutive empty polls; incremented here,
+///				and set to zero by the caller when a poll succeeds.
+void PollBackoff ( int & emptyPolls );
+
 ///	Transfers char** to a StrVec.
 ///	@param strArray		vector of strings to receive the C strings
 ///	@param beginCStr	pointer to start of C strings
@@ -113,9 +120,11 @@ class Sequence
 /// Make a date+timestamp prefix for a message display.
 static inline std::string DateTimeStampPrefix ()
 {
-    std::string prefix = MakeDateTimeStamp();
-    prefix += ": ";
-    return prefix;
+    char buffer[timeStampBufferSize + 2];
+    std::size_t length = FormatTimeStamp( buffer, timeStampBufferSize );
+    buffer[length++] = ':';
+    buffer[length++] = ' ';
+    return std::string( buffer, length );
 }
 
 // -----------------------------------------------------------------------------------------------------------
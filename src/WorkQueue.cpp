@@ -0,0 +1,191 @@
+/*------------------------------------------------------------------------------------------------------------
+file		WorkQueue.cpp
+class		mtbmpi::WorkQueue
+brief 		Queue of work items which the Controller hands out to tasks.
+details
+		In work-queue (task-farm) mode, the Controller owns a queue of work items,
+		and gives the next item to whichever task reports that its previous item
+		is completed. A task initializes and starts once for each work item,
+		so a job can run many more work items than it has work tasks.
+
+project		Master-Task-Blackboard MPI Framework
+author		Thomas E. Hilinski <https://github.com/tehilinski>
+copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#include "WorkQueue.h"
+#include <cstdlib>
+
+namespace mtbmpi {
+
+
+//--------------------------------------- WorkItem ---------------------------------------
+
+std::string WorkItem::Pack () const
+{
+    // 1st line is the item index; remaining lines are the item strings
+    std::string buffer = ToString( index );
+    StrVec::const_iterator i = args.begin();
+    while ( i != args.end() )
+    {
+	buffer += NL_CHAR;
+	buffer += *(i++);
+    }
+    return buffer;
+}
+
+void WorkItem::Unpack (
+    char const * const data,
+    int const count)
+{
+    index = -1;
+    args.clear();
+    if ( count <= 0 )
+	return;
+
+    char const * const end = data + count;
+    char const * lineStart = data;
+    bool isFirstLine = true;
+    while ( lineStart <= end )
+    {
+	char const * lineEnd = lineStart;
+	while ( lineEnd != end && *lineEnd != NL_CHAR )
+	    ++lineEnd;
+	if ( isFirstLine )
+	{
+	    index = std::atol( std::string( lineStart, lineEnd ).c_str() );
+	    isFirstLine = false;
+	}
+	else
+	    args.push_back( std::string( lineStart, lineEnd ) );
+	lineStart = lineEnd + 1;
+    }
+}
+
+//--------------------------------------- WorkQueue ---------------------------------------
+
+WorkQueue::WorkQueue ()
+    : numAdded ( 0 ),
+      numDispatched ( 0 ),
+      numCompleted ( 0 ),
+      numFailed ( 0 ),
+      numTasksDone ( 0 )
+{
+}
+
+WorkQueue::IndexNum WorkQueue::Add (
+    StrVec const & args)
+{
+    IndexNum const index = numAdded++;
+    items.push_back( WorkItem( index, args ) );
+    return index;
+}
+
+void WorkQueue::Append (
+    WorkItem const & item)
+{
+    ++numAdded;
+    items.push_back( item );
+}
+
+WorkQueue::size_type WorkQueue::NextBatch (
+    size_type const maxItems,
+    std::string & buffer)
+{
+    // each item is its packed length, a newline, and the packed item
+    buffer.clear();
+    size_type numItems = 0;
+    WorkItem item;
+    while ( numItems < maxItems && Next( item ) )
+    {
+	std::string const packed = item.Pack();
+	buffer += ToString( packed.size() );
+	buffer += NL_CHAR;
+	buffer += packed;
+	++numItems;
+    }
+    return numItems;
+}
+
+WorkQueue::size_type WorkQueue::AppendBatch (
+    char const * const data,
+    int const count)
+{
+    size_type numItems = 0;
+    char const * const end = data + count;
+    char const * p = data;
+    while ( p < end )
+    {
+	char const * lineEnd = p;
+	while ( lineEnd != end && *lineEnd != NL_CHAR )
+	    ++lineEnd;
+	long const length = std::atol( std::string( p, lineEnd ).c_str() );
+	p = lineEnd + 1;
+	if ( lineEnd == end || length < 0 || p + length > end )
+	    break;				// truncated batch
+	WorkItem item;
+	item.Unpack( p, static_cast<int>(length) );
+	Append( item );
+	p += length;
+	++numItems;
+    }
+    return numItems;
+}
+
+bool WorkQueue::Next (
+    WorkItem & item)
+{
+    if ( items.empty() )
+	return false;
+    item = items.front();
+    items.pop_front();
+    ++numDispatched;
+    return true;
+}
+
+void WorkQueue::SetNumberOfTasks (
+    size_type const numTasks)
+{
+    taskDone.assign( numTasks, false );
+    numTasksDone = 0;
+    taskBusy.assign( numTasks, false );
+    taskItemCount.assign( numTasks, 0 );
+}
+
+void WorkQueue::ItemDispatched (
+    size_type const taskNum)
+{
+    if ( taskNum < taskBusy.size() )
+	taskBusy[taskNum] = true;
+}
+
+bool WorkQueue::ItemFinished (
+    size_type const taskNum,
+    bool const isCompleted)
+{
+    if ( taskNum >= taskBusy.size() || !taskBusy[taskNum] )
+	return false;
+    taskBusy[taskNum] = false;
+    ++taskItemCount[taskNum];
+    if ( isCompleted )
+	++numCompleted;
+    else
+	++numFailed;
+    return true;
+}
+
+void WorkQueue::SetTaskDone (
+    size_type const taskNum)
+{
+    if ( taskNum < taskDone.size() && !taskDone[taskNum] )
+    {
+	taskDone[taskNum] = true;
+	++numTasksDone;
+    }
+}
+
+
+} // namespace mtbmpi
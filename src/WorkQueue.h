@@ -0,0 +1,202 @@
+/*! ----------------------------------------------------------------------------------------------------------
+@file		WorkQueue.h
+@class		mtbmpi::WorkQueue
+@brief 		Queue of work items which the Controller hands out to tasks.
+@details
+		In work-queue (task-farm) mode, the Controller owns a queue of work items,
+		and gives the next item to whichever task reports that its previous item
+		is completed. A task initializes and starts once for each work item,
+		so a job can run many more work items than it has work tasks.
+
+		A work item is a list of strings, for example the command-line arguments
+		for one run of the application adapted by the task.
+		The strings cannot contain the newline character.
+
+		Work-queue mode is used when work items are added to the queue
+		before the Controller's event loop starts, e.g. in the derived Master
+		constructor before `GetController().Activate()`,
+		or in `DoActionsBeforeTasks`:
+@code
+		StrVec args;
+		args.push_back( "--site=" + siteName );
+		GetController().GetWorkQueue().Add( args );
+@endcode
+		The task gets its current work item from `Task::GetWorkItem()`.
+
+		With sub-controllers, the Controller sends batches of items to each
+		sub-controller (NextBatch), which keeps them in its own WorkQueue
+		(AppendBatch) and hands them out to its tasks.
+@example	../examples/WorkQueueExample.cpp
+@internal
+project		Master-Task-Blackboard MPI Framework
+@author		Thomas E. Hilinski <https://github.com/tehilinski>
+@copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+		This software library, including source code and documentation,
+		is licensed under the Apache License version 2.0.
+		See "LICENSE.md" for more information.
+------------------------------------------------------------------------------------------------------------*/
+
+#ifndef INC_mtbmpi_WorkQueue_h
+#define INC_mtbmpi_WorkQueue_h
+
+#include "UtilitiesMPI.h"
+#include <deque>
+#include <vector>
+
+namespace mtbmpi {
+
+
+/// One work item: a zero-based index and the item's strings.
+class WorkItem
+{
+  public:
+
+    typedef long	IndexNum;	///< index of the work item; negative is an invalid item
+
+    WorkItem ()
+      : index ( -1 )
+      {
+      }
+
+    /// Constructor
+    WorkItem (
+      IndexNum const itemIndex,		///< zero-based index of the work item
+      StrVec const & itemArgs)		///< strings describing the work item
+      : index ( itemIndex ),
+	args ( itemArgs )
+      {
+      }
+
+    IndexNum GetIndex () const { return index; }		///< zero-based index of the work item
+    StrVec const & GetArgs () const { return args; }		///< strings describing the work item
+    bool IsValid () const { return index >= 0; }		///< true if the item has been set
+
+    /// Pack the work item into a newline-delimited string for sending as MPI::CHAR.
+    std::string Pack () const;
+
+    /// Unpack the work item from a received newline-delimited string.
+    void Unpack (
+      char const * const data,		///< received characters
+      int const count);			///< number of characters
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    IndexNum index;
+    StrVec args;
+
+    /// @endcond
+};
+
+
+class WorkQueue
+{
+  public:
+
+    typedef WorkItem::IndexNum			IndexNum;
+    typedef std::deque<WorkItem>::size_type	size_type;
+
+    WorkQueue ();
+
+    /// Add a work item to the end of the queue.
+    /// @return index of the new work item
+    IndexNum Add (
+      StrVec const & args);		///< strings describing the work item
+
+    /// Remove the next item from the queue.
+    /// @return false if the queue is empty
+    bool Next (
+      WorkItem & item);			///< receives the next work item
+
+    /// Add a work item received from another controller; keeps the item's index.
+    void Append (
+      WorkItem const & item);		///< work item
+
+    /// Remove up to maxItems items from the queue, and pack them into one string.
+    /// @return number of items packed; zero if the queue is empty
+    size_type NextBatch (
+      size_type const maxItems,		///< maximum number of items to pack
+      std::string & buffer);		///< receives the packed items
+
+    /// Append the items in a string made by NextBatch.
+    /// @return number of items appended
+    size_type AppendBatch (
+      char const * const data,		///< received characters
+      int const count);			///< number of characters
+
+    bool IsActive () const { return numAdded > 0; }		///< true if work-queue mode is used
+    bool IsEmpty () const  { return items.empty(); }		///< true if no items are waiting
+    size_type Size () const { return items.size(); }		///< number of items waiting
+
+    IndexNum GetNumAdded () const      { return numAdded; }	///< total items added
+    IndexNum GetNumDispatched () const { return numDispatched; }	///< items given to tasks
+    IndexNum GetNumCompleted () const  { return numCompleted; }	///< items completed without error
+    IndexNum GetNumFailed () const     { return numFailed; }	///< items with an error
+    IndexNum GetNumFinished () const   { return numCompleted + numFailed; }	///< items done
+
+    /// Record items finished by the tasks of a sub-controller.
+    void ItemsFinished (
+      IndexNum const completed,		///< items completed without error
+      IndexNum const failed)		///< items with an error
+      { numCompleted += completed; numFailed += failed; }
+
+    //--- per-task bookkeeping; task numbers are zero-based Tracker indices ---
+
+    /// Set the number of tasks which receive work items.
+    void SetNumberOfTasks ( size_type const numTasks );
+
+    /// Record that a task was given a work item.
+    void ItemDispatched (
+      size_type const taskNum);		///< task index
+
+    /// Record that a task finished its work item.
+    /// @return false if the task did not have a work item
+    bool ItemFinished (
+      size_type const taskNum,		///< task index
+      bool const isCompleted);		///< false if the item had an error
+
+    /// Record that a task was sent the stop request because the queue is empty.
+    void SetTaskDone (
+      size_type const taskNum);		///< task index
+
+    /// True if the task was sent the stop request
+    bool IsTaskDone (
+      size_type const taskNum) const	///< task index
+      { return taskNum < taskDone.size() && taskDone[taskNum]; }
+
+    /// Number of tasks which were sent the stop request
+    size_type GetNumTasksDone () const { return numTasksDone; }
+
+    /// Number of items finished by the task
+    IndexNum GetTaskItemCount (
+      size_type const taskNum) const	///< task index
+      { return taskNum < taskItemCount.size() ? taskItemCount[taskNum] : 0; }
+
+  private:
+
+    /// @cond SKIP_PRIVATE
+
+    std::deque<WorkItem> items;			// items not yet dispatched
+    IndexNum numAdded;
+    IndexNum numDispatched;
+    IndexNum numCompleted;
+    IndexNum numFailed;
+    size_type numTasksDone;
+    std::vector<bool> taskDone;			// task was sent stop request
+    std::vector<bool> taskBusy;			// task has a work item
+    std::vector<IndexNum> taskItemCount;	// items finished by each task
+
+    // functions that should not be used; are not defined
+    WorkQueue (WorkQueue const & object);
+    WorkQueue & operator= (WorkQueue const & object);
+    bool operator== (WorkQueue const & object) const;
+    bool operator!= (WorkQueue const & object) const;
+
+    /// @endcond
+};
+
+
+} // namespace mtbmpi
+
+#endif // INC_mtbmpi_WorkQueue_h
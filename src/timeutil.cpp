@@ -13,6 +13,10 @@ copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
 #include "UtilitiesMPI.h"
 #include <ctime>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #if defined(MSWINDOWS) && !defined(CYGWIN)
   #include <windows.h>
   #include <time.h>
@@ -211,4 +215,144 @@ std::string MakeDateTimeStamp (
 }
 
 
+//------------------------------------------------------------------------------
+// FormatTimeStamp
+// The text of the current second, "yyyy-mm-dd_hh-mm-ss", is cached per thread,
+// so localtime and the date formatting run once per second per thread.
+// The fraction of the second is formatted with integer arithmetic.
+//------------------------------------------------------------------------------
+
+namespace {
+
+    typedef std::chrono::system_clock	SystemClock;
+    typedef std::chrono::steady_clock	SteadyClock;
+
+    std::size_t const secondTextSize = 19;		// yyyy-mm-dd_hh-mm-ss
+
+    std::atomic<int> timeStampClock ( TimeStamp_System );
+
+    struct SecondText
+    {
+	std::time_t second;			// seconds since the epoch
+	char separatorValues;
+	char separatorFields;
+	char text[secondTextSize];
+    };
+
+    thread_local SecondText cachedSecond = { (std::time_t)-1, 0, 0, { 0 } };
+
+    // system time at the first use of the monotonic clock, minus the steady time then
+    SystemClock::duration EpochOffset ()
+    {
+	static SystemClock::duration const offset =
+	    SystemClock::now().time_since_epoch() -
+	    std::chrono::duration_cast<SystemClock::duration>(
+		SteadyClock::now().time_since_epoch() );
+	return offset;
+    }
+
+    inline char * PutDigits (
+	char * p,
+	unsigned int value,
+	int const numDigits)
+    {
+	for ( int i = numDigits - 1; i >= 0; --i )
+	{
+	    p[i] = static_cast<char>( '0' + value % 10 );
+	    value /= 10;
+	}
+	return p + numDigits;
+    }
+
+    void FormatSecond (
+	SecondText & cache,
+	std::time_t const second,
+	char const separatorValues,
+	char const separatorFields)
+    {
+	std::tm lt;
+	#if defined(MSWINDOWS) && !defined(CYGWIN)
+	  localtime_s ( &lt, &second );
+	#else
+	  localtime_r ( &second, &lt );
+	#endif
+	char * p = cache.text;
+	p = PutDigits( p, static_cast<unsigned int>( lt.tm_year + 1900 ), 4 );
+	*p++ = separatorValues;
+	p = PutDigits( p, static_cast<unsigned int>( lt.tm_mon + 1 ), 2 );
+	*p++ = separatorValues;
+	p = PutDigits( p, static_cast<unsigned int>( lt.tm_mday ), 2 );
+	*p++ = separatorFields;
+	p = PutDigits( p, static_cast<unsigned int>( lt.tm_hour ), 2 );
+	*p++ = separatorValues;
+	p = PutDigits( p, static_cast<unsigned int>( lt.tm_min ), 2 );
+	*p++ = separatorValues;
+	PutDigits( p, static_cast<unsigned int>( lt.tm_sec ), 2 );
+	cache.second = second;
+	cache.separatorValues = separatorValues;
+	cache.separatorFields = separatorFields;
+    }
+
+} // namespace
+
+long long TimeStampNanoseconds ()
+{
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+    if ( timeStampClock.load( std::memory_order_relaxed ) == TimeStamp_Monotonic )
+	return duration_cast<nanoseconds>(
+		    SteadyClock::now().time_since_epoch() ).count() +
+	       duration_cast<nanoseconds>( EpochOffset() ).count();
+    return duration_cast<nanoseconds>( SystemClock::now().time_since_epoch() ).count();
+}
+
+void SetTimeStampClock (
+    TimeStampClock const clock)
+{
+    if ( clock == TimeStamp_Monotonic )
+	EpochOffset();		// fix the offset now
+    timeStampClock.store( clock );
+}
+
+std::size_t FormatTimeStamp (
+    char * const buffer,
+    std::size_t const bufferSize,
+    int const fractionDigits,
+    char const separatorValues,
+    char const separatorFields)
+{
+    if ( buffer == nullptr || bufferSize == 0 )
+	return 0;
+    long long const now = TimeStampNanoseconds();
+    long long const billion = 1000000000LL;
+    std::time_t const second = static_cast<std::time_t>( now / billion );
+    unsigned int const nanoseconds = static_cast<unsigned int>( now % billion );
+
+    SecondText & cache = cachedSecond;
+    if ( cache.second != second ||
+	 cache.separatorValues != separatorValues ||
+	 cache.separatorFields != separatorFields )
+	FormatSecond( cache, second, separatorValues, separatorFields );
+
+    // full text in a local buffer, then copy what fits
+    char text[timeStampBufferSize];
+    std::memcpy( text, cache.text, secondTextSize );
+    std::size_t length = secondTextSize;
+    int const digits = std::min( std::max( fractionDigits, 0 ), 9 );
+    if ( digits > 0 )
+    {
+	unsigned int fraction = nanoseconds;
+	for ( int i = digits; i < 9; ++i )
+	    fraction /= 10;
+	text[length++] = '.';
+	PutDigits( text + length, fraction, digits );
+	length += digits;
+    }
+    length = std::min( length, bufferSize - 1 );
+    std::memcpy( buffer, text, length );
+    buffer[length] = '\0';
+    return length;
+}
+
+
 } // namespace mtbmpi
@@ -24,11 +24,14 @@ project		Master-Task-Blackboard MPI Framework
 //   ToTimeStr		Convert TimeValues to TimeStr.
 //   ToDateStr		Convert DateValues to DateStr.
 //   MakeDateTimeStamp	Make a date-timestamp string; e.g., "01-01-2016_12-00-00"
+//   FormatTimeStamp	Write a date-timestamp of NOW into a char buffer; no allocations.
+//   SetTimeStampClock	Use the system clock or the monotonic clock for FormatTimeStamp.
 // ----------------------------------------------------------------------------
 
 #include "timetypes.h"
 #include <string>
 #include <utility>
+#include <cstddef>
 
 namespace mtbmpi {
 
@@ -84,13 +87,50 @@ std::string MakeDateTimeStamp (
     char const separatorValues = '-',	///< separator character between values within a field
     char const separatorFields = '_');	///< separator character between fields
 
+//---- fast timestamps ----
+
+/// Size of a buffer which holds any FormatTimeStamp result and the null.
+std::size_t const timeStampBufferSize = 32;
+
+/// Clock used by FormatTimeStamp
+enum TimeStampClock
+{
+    TimeStamp_System,		///< system clock; follows changes to the wall clock
+    TimeStamp_Monotonic		///< monotonic clock plus the epoch offset at the first use;
+				///< never goes backward
+};
+
+/// Set the clock used by FormatTimeStamp in all threads
+void SetTimeStampClock (
+    TimeStampClock const clock );	///< system or monotonic
+
+/// Nanoseconds since the epoch NOW, from the clock used by FormatTimeStamp
+long long TimeStampNanoseconds ();
+
+/// Write a date-timestamp of the time NOW into a buffer; e.g., "2016-01-01_12-00-00",
+/// or "2016-01-01_12-00-00.123" with 3 fraction digits.
+/// The formatted date and time are cached per thread for the current second,
+/// so most calls only copy the cached text and format the fraction.
+/// Does not allocate memory. The result is null-terminated, and truncated
+/// if the buffer is too small; a buffer of timeStampBufferSize is always enough.
+/// @return number of characters written, not including the null
+std::size_t FormatTimeStamp (
+    char * const buffer,		///< receives the timestamp
+    std::size_t const bufferSize,	///< size of buffer
+    int const fractionDigits = 0,	///< digits of a second: 0 to 9
+    char const separatorValues = '-',	///< separator character between values within a field
+    char const separatorFields = '_');	///< separator character between fields
+
 /// Make a date-timestamp string of the time NOW; e.g., "01-01-2016_12-00-00"
 /// @return std::string
 inline std::string MakeDateTimeStamp (
     char const separatorValues = '-',	///< separator character between values within a field
     char const separatorFields = '_')	///< separator character between fields
 {
-    return MakeDateTimeStamp( DateStr(), TimeStr(), separatorValues, separatorFields );
+    char buffer[timeStampBufferSize];
+    std::size_t const length =
+	FormatTimeStamp( buffer, sizeof(buffer), 0, separatorValues, separatorFields );
+    return std::string( buffer, length );
 }
 
 //---- date-time pair ----
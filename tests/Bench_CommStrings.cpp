@@ -0,0 +1,147 @@
+//------------------------------------------------------------------------------------------------------------
+// File: Bench_CommStrings.cpp
+// Benchmark of mtbmpi::CommStrings packing and unpacking.
+// Compares the previous MPI::CHAR.Pack / per-char Unpack implementation
+// to the single-pass CommStrings::Pack and CommStrings::Unpack.
+// Build:
+//	mpicxx -O2 -I../src -o Bench_CommStrings Bench_CommStrings.cpp ../build/cmake/libmtbmpi.a
+// Run:
+//	mpiexec -n 1 ./Bench_CommStrings [number of lines] [line length] [repetitions]
+//
+// project	Master-Task-Blackboard MPI Framework
+// author	Thomas E. Hilinski <https://github.com/tehilinski>
+// copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+// 		This software library, including source code and documentation,
+// 		is licensed under the Apache License version 2.0.
+// 		See "LICENSE.md" for more information.
+//------------------------------------------------------------------------------------------------------------
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <cstdlib>
+#include <algorithm>
+#include "MTBMPI.h"
+#include "TimerMPI.h"
+
+char const * const appTitle = "Benchmark of mtbmpi::CommStrings packing and unpacking";
+
+//------------------------------------------------------------------------------------------------------------
+//	previous implementation
+//------------------------------------------------------------------------------------------------------------
+
+int OldPack (
+    mtbmpi::StrVec strVec,			// copied; old PrepareData modified the strings
+    std::vector<char> & buffer )
+{
+    int numChars = 0;
+    for ( mtbmpi::StrVec::iterator i = strVec.begin(); i != strVec.end(); ++i )
+    {
+	i->push_back( mtbmpi::CommStrings::lineDelimiter );
+	numChars += i->size();
+    }
+    int const sizePacked = MPI::CHAR.Pack_size( numChars, MPI::COMM_WORLD );
+    buffer.assign( sizePacked, mtbmpi::NULL_CHAR );
+    int position = 0;
+    for ( mtbmpi::StrVec::const_iterator i = strVec.begin(); i != strVec.end(); ++i )
+	MPI::CHAR.Pack( i->data(), i->size(), &buffer[0], sizePacked, position, MPI::COMM_WORLD );
+    return position;
+}
+
+void OldUnpack (
+    std::vector<char> const & buffer,
+    int const sizePacked,
+    mtbmpi::StrVec & strVec )
+{
+    int const maxLineLength = 2048;
+    int posPacked = 0;
+    int posUnpacked = 0;
+    std::vector<char> bufUnpacked (maxLineLength, mtbmpi::NULL_CHAR);
+    while ( posPacked < sizePacked && posUnpacked < maxLineLength )
+    {
+	MPI::CHAR.Unpack( buffer.data(), sizePacked, &bufUnpacked[posUnpacked], 1,
+			  posPacked, MPI::COMM_WORLD );
+	std::vector<char>::iterator iNow = bufUnpacked.begin() + posUnpacked;
+	bool const atEnd = ( posPacked == sizePacked || posUnpacked == maxLineLength );
+	if ( *iNow == mtbmpi::CommStrings::lineDelimiter || atEnd )
+	{
+	    std::string const line ( bufUnpacked.begin(), iNow );
+	    if ( !line.empty() )
+		strVec.push_back ( line );
+	    std::fill ( bufUnpacked.begin(), bufUnpacked.end(), mtbmpi::NULL_CHAR );
+	    posUnpacked = 0;
+	}
+	else
+	    ++posUnpacked;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------
+
+void Report (
+    char const * const name,
+    double const seconds,
+    double const megabytes,
+    int const repetitions,
+    std::size_t const numLinesOut )
+{
+    cout << "  " << name
+	 << ": " << seconds / repetitions * 1.0e3 << " ms per pass"
+	 << ", " << megabytes * repetitions / seconds << " MB/s"
+	 << ", lines received = " << numLinesOut
+	 << endl;
+}
+
+int main (int argc, char **argv)
+{
+    MPI::Init( argc, argv );
+    if ( MPI::COMM_WORLD.Get_rank() == 0 )
+    {
+	int const numLines    = ( argc > 1 ? std::atoi( argv[1] ) : 1000 );
+	int const lineLength  = ( argc > 2 ? std::atoi( argv[2] ) : 1000 );
+	int const repetitions = ( argc > 3 ? std::atoi( argv[3] ) : 5 );
+
+	mtbmpi::StrVec strVec;
+	for ( int i = 0; i < numLines; ++i )
+	    strVec.push_back( std::string( lineLength, static_cast<char>( 'a' + i % 26 ) ) );
+	double const megabytes = numLines * ( lineLength + 1.0 ) / ( 1024.0 * 1024.0 );
+
+	cout << appTitle << endl
+	     << "  lines = " << numLines
+	     << ", line length = " << lineLength
+	     << ", MB = " << megabytes
+	     << ", repetitions = " << repetitions
+	     << endl;
+
+	std::vector<char> buffer;
+	mtbmpi::StrVec received;
+
+	mtbmpi::TimerMPI oldTimer;
+	for ( int r = 0; r < repetitions; ++r )
+	{
+	    received.clear();
+	    oldTimer.start();
+	    int const size = OldPack( strVec, buffer );
+	    OldUnpack( buffer, size, received );
+	    oldTimer.stop();
+	}
+	Report( "previous   ", oldTimer.read(), megabytes, repetitions, received.size() );
+
+	mtbmpi::TimerMPI newTimer;
+	for ( int r = 0; r < repetitions; ++r )
+	{
+	    received.clear();
+	    newTimer.start();
+	    int const size = mtbmpi::CommStrings::Pack( strVec, buffer );
+	    mtbmpi::CommStrings::Unpack( buffer.data(), size, received );
+	    newTimer.stop();
+	}
+	Report( "single-pass", newTimer.read(), megabytes, repetitions, received.size() );
+
+	if ( received != strVec )
+	    cout << "  error: single-pass strings differ from the strings sent" << endl;
+	cout << "  speedup = " << oldTimer.read() / newTimer.read() << endl;
+    }
+    MPI::Finalize();
+    return 0;
+}
@@ -0,0 +1,240 @@
+//------------------------------------------------------------------------------------------------------------
+// File: Bench_PersistentMsg.cpp
+// Benchmark of the per-message cost of small control messages.
+// Compares a blocking Send received by Probe and Recv (the previous Tag_State path)
+// to a ring of pre-posted PersistentReceive requests, with a blocking Send
+// and with a ring of persistent sends, defined here.
+// Rank 1 sends the messages to rank 0; other ranks are idle.
+// Build:
+//	mpicxx -O2 -I../src -o Bench_PersistentMsg Bench_PersistentMsg.cpp ../build/cmake/libmtbmpi.a
+// Run:
+//	mpiexec -n 2 ./Bench_PersistentMsg [number of messages] [receive ring depth]
+//
+// project	Master-Task-Blackboard MPI Framework
+// author	Thomas E. Hilinski <https://github.com/tehilinski>
+// copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+// 		This software library, including source code and documentation,
+// 		is licensed under the Apache License version 2.0.
+// 		See "LICENSE.md" for more information.
+//------------------------------------------------------------------------------------------------------------
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include "MTBMPI.h"
+#include "TimerMPI.h"
+
+char const * const appTitle = "Benchmark of persistent requests for control messages";
+
+//------------------------------------------------------------------------------------------------------------
+//	previous implementation
+//------------------------------------------------------------------------------------------------------------
+
+void OldSend ( int const numMsgs )
+{
+    int buffer[2] = { 1, 0 };
+    for ( int i = 0; i < numMsgs; ++i )
+    {
+	buffer[1] = i;
+	mtbmpi::comm.Send ( buffer, 2, MPI::INT, 0, mtbmpi::Tag_State );
+    }
+}
+
+long long OldReceive ( int const numMsgs )
+{
+    long long sum = 0;
+    for ( int i = 0; i < numMsgs; ++i )
+    {
+	MPI::Status status;
+	mtbmpi::comm.Probe ( MPI_ANY_SOURCE, MPI_ANY_TAG, status );
+	int * buffer = new int [ status.Get_count (MPI::INT) ];
+	mtbmpi::comm.Recv ( buffer, 2, MPI::INT, status.Get_source(), mtbmpi::Tag_State, status );
+	sum += buffer[1];
+	delete [] buffer;
+    }
+    return sum;
+}
+
+//------------------------------------------------------------------------------------------------------------
+//	persistent requests
+//------------------------------------------------------------------------------------------------------------
+
+// A ring of persistent send requests and their buffers.
+// Send waits only for the oldest message in the ring, copies the values
+// into its buffer, and starts its request.
+class PersistentSend
+{
+  public:
+
+    PersistentSend (
+      MPI::Intracomm & comm,
+      int const destination,
+      mtbmpi::MsgTags const tag,
+      int const useCount,
+      int const depth)
+      : count ( useCount ),
+	buffers ( depth * useCount, 0 ),
+	requests ( depth ),
+	isActive ( depth, false ),
+	next ( 0 )
+    {
+	for ( std::vector<MPI::Prequest>::size_type i = 0; i < requests.size(); ++i )
+	    requests[i] = comm.Send_init (
+		    &buffers[i * count], count, MPI::INT, destination, tag );
+    }
+
+    ~PersistentSend ()
+    {
+	for ( std::vector<MPI::Prequest>::size_type i = 0; i < requests.size(); ++i )
+	{
+	    if ( isActive[i] )
+		requests[i].Wait();
+	    requests[i].Free();
+	}
+    }
+
+    void Send (
+      int const * const values)
+    {
+	if ( isActive[next] )
+	    requests[next].Wait();
+	std::copy( values, values + count, &buffers[next * count] );
+	requests[next].Start();
+	isActive[next] = true;
+	next = ( next + 1 ) % requests.size();
+    }
+
+  private:
+
+    int const count;
+    std::vector<int> buffers;
+    std::vector<MPI::Prequest> requests;
+    std::vector<bool> isActive;
+    std::vector<MPI::Prequest>::size_type next;
+};
+
+void NewSend ( int const numMsgs )
+{
+    PersistentSend sender ( mtbmpi::comm, 0, mtbmpi::Tag_State, 2, 16 );
+    int buffer[2] = { 1, 0 };
+    for ( int i = 0; i < numMsgs; ++i )
+    {
+	buffer[1] = i;
+	sender.Send ( buffer );
+    }
+}
+
+long long NewReceive (
+    mtbmpi::PersistentReceive & receiver,
+    int const numMsgs )
+{
+    long long sum = 0;
+    int buffer[2];
+    int source = 0;
+    for ( int i = 0; i < numMsgs; )
+    {
+	if ( receiver.Receive( buffer, source ) )
+	{
+	    sum += buffer[1];
+	    ++i;
+	}
+	else
+	    std::this_thread::yield();	// as in the Controller
+    }
+    return sum;
+}
+
+void Report (
+    char const * const name,
+    double const seconds,
+    int const numMsgs,
+    long long const sum,
+    long long const expected )
+{
+    cout << "  " << name
+	 << ": " << seconds / numMsgs * 1.0e6 << " usec per message"
+	 << ", " << numMsgs / seconds << " messages/s"
+	 << ( sum == expected ? "" : ", error: wrong values received" )
+	 << endl;
+}
+
+int main (int argc, char **argv)
+{
+    MPI::Init( argc, argv );
+    mtbmpi::comm = MPI::COMM_WORLD.Dup();
+    int const rank = mtbmpi::comm.Get_rank();
+    if ( mtbmpi::comm.Get_size() < 2 )
+    {
+	cout << appTitle << ": requires at least 2 ranks" << endl;
+	mtbmpi::comm.Free();
+	MPI::Finalize();
+	return 1;
+    }
+
+    int const numMsgs = ( argc > 1 ? std::atoi( argv[1] ) : 1000000 );
+    int const depth   = ( argc > 2 ? std::atoi( argv[2] ) : 64 );
+    long long const expected = static_cast<long long>( numMsgs ) * ( numMsgs - 1 ) / 2;
+    if ( rank == 0 )
+	cout << appTitle << endl
+	     << "  messages = " << numMsgs
+	     << ", receive ring depth = " << depth
+	     << endl;
+
+    // previous: blocking Send; Probe and Recv
+    mtbmpi::comm.Barrier();
+    mtbmpi::TimerMPI oldTimer;
+    oldTimer.start();
+    long long oldSum = 0;
+    if ( rank == 0 )
+	oldSum = OldReceive( numMsgs );
+    else if ( rank == 1 )
+	OldSend( numMsgs );
+    mtbmpi::comm.Barrier();
+    oldTimer.stop();
+    if ( rank == 0 )
+	Report( "Send, Probe + Recv          ", oldTimer.read(), numMsgs, oldSum, expected );
+
+    // pre-posted persistent receives; blocking Send, then persistent send
+    mtbmpi::PersistentReceive * pReceiver = nullptr;
+    if ( rank == 0 )
+	pReceiver = new mtbmpi::PersistentReceive ( mtbmpi::comm, mtbmpi::Tag_State, 2, depth );
+    char const * const names[2] = {
+	"Send, pre-posted receives   ",
+	"PersistentSend, pre-posted  " };
+    for ( int variant = 0; variant < 2; ++variant )
+    {
+	mtbmpi::comm.Barrier();
+	mtbmpi::TimerMPI newTimer;
+	newTimer.start();
+	long long newSum = 0;
+	if ( rank == 0 )
+	    newSum = NewReceive( *pReceiver, numMsgs );
+	else if ( rank == 1 )
+	{
+	    if ( variant == 0 )
+		OldSend( numMsgs );
+	    else
+		NewSend( numMsgs );
+	}
+	mtbmpi::comm.Barrier();
+	newTimer.stop();
+	if ( rank == 0 )
+	{
+	    Report( names[variant], newTimer.read(), numMsgs, newSum, expected );
+	    cout << "    speedup = " << oldTimer.read() / newTimer.read() << endl;
+	}
+    }
+    if ( rank == 0 )
+    {
+	pReceiver->Close();
+	delete pReceiver;
+    }
+
+    mtbmpi::comm.Free();
+    MPI::Finalize();
+    return 0;
+}
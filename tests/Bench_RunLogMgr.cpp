@@ -0,0 +1,97 @@
+//------------------------------------------------------------------------------------------------------------
+// File: Bench_RunLogMgr.cpp
+// Benchmark of mtbmpi::RunLogMgr log file throughput.
+// Compares the previous `ofs << msg << std::endl` per line
+// to the buffered RunLogMgr with each flush policy.
+// Build:
+//	mpicxx -O2 -I../src -o Bench_RunLogMgr Bench_RunLogMgr.cpp ../build/cmake/libmtbmpi.a
+// Run:
+//	./Bench_RunLogMgr [number of lines] [line length]
+//
+// project	Master-Task-Blackboard MPI Framework
+// author	Thomas E. Hilinski <https://github.com/tehilinski>
+// copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+// 		This software library, including source code and documentation,
+// 		is licensed under the Apache License version 2.0.
+// 		See "LICENSE.md" for more information.
+//------------------------------------------------------------------------------------------------------------
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include "RunLogMgr.h"
+
+char const * const appTitle = "Benchmark of mtbmpi::RunLogMgr log file throughput";
+char const * const fileName = "Bench_RunLogMgr.txt";
+
+typedef std::chrono::steady_clock	Clock;
+
+double Seconds ( Clock::time_point const start )
+{
+    return std::chrono::duration<double>( Clock::now() - start ).count();
+}
+
+void Report (
+    char const * const name,
+    double const seconds,
+    int const numLines,
+    double const baseSeconds )
+{
+    cout << "  " << name
+	 << ": " << seconds << " s"
+	 << ", " << numLines / seconds << " lines/s"
+	 << ", speedup = " << baseSeconds / seconds
+	 << endl;
+}
+
+double BufferedWrite (
+    mtbmpi::RunLogMgr::FlushPolicy const policy,
+    std::string const & line,
+    int const numLines )
+{
+    Clock::time_point const start = Clock::now();
+    {
+	mtbmpi::RunLogMgr runLog ( fileName );
+	runLog.SetFlushPolicy( policy );
+	for ( int i = 0; i < numLines; ++i )
+	    runLog.Write( line );
+    }
+    return Seconds( start );
+}
+
+int main (int argc, char **argv)
+{
+    int const numLines   = ( argc > 1 ? std::atoi( argv[1] ) : 1000000 );
+    int const lineLength = ( argc > 2 ? std::atoi( argv[2] ) : 80 );
+    std::string const line ( lineLength, 'x' );
+
+    cout << appTitle << endl
+	 << "  lines = " << numLines
+	 << ", line length = " << lineLength
+	 << endl;
+
+    // previous: flushed on every line
+    Clock::time_point const start = Clock::now();
+    {
+	std::ofstream ofs ( fileName, std::ios::out | std::ios::trunc );
+	for ( int i = 0; i < numLines; ++i )
+	    ofs << line << std::endl;
+    }
+    double const endlSeconds = Seconds( start );
+    Report( "std::endl per line       ", endlSeconds, numLines, endlSeconds );
+
+    Report( "RunLogMgr Flush_Close    ",
+	    BufferedWrite( mtbmpi::RunLogMgr::Flush_Close, line, numLines ), numLines, endlSeconds );
+    Report( "RunLogMgr Flush_Errors   ",
+	    BufferedWrite( mtbmpi::RunLogMgr::Flush_Errors, line, numLines ), numLines, endlSeconds );
+    Report( "RunLogMgr Flush_Interval ",
+	    BufferedWrite( mtbmpi::RunLogMgr::Flush_Interval, line, numLines ), numLines, endlSeconds );
+
+    std::remove( fileName );
+    return 0;
+}
@@ -0,0 +1,95 @@
+//------------------------------------------------------------------------------------------------------------
+// File: Bench_TimeStamp.cpp
+// Benchmark of mtbmpi::FormatTimeStamp.
+// Compares the previous MakeDateTimeStamp( DateStr(), TimeStr() ),
+// which formats the date and time through strftime and string streams,
+// to FormatTimeStamp, which caches the current second per thread,
+// with the system clock and the monotonic clock.
+// Build:
+//	mpicxx -O2 -I../src -o Bench_TimeStamp Bench_TimeStamp.cpp ../build/cmake/libmtbmpi.a
+// Run:
+//	./Bench_TimeStamp [number of timestamps]
+//
+// project	Master-Task-Blackboard MPI Framework
+// author	Thomas E. Hilinski <https://github.com/tehilinski>
+// copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+// 		This software library, including source code and documentation,
+// 		is licensed under the Apache License version 2.0.
+// 		See "LICENSE.md" for more information.
+//------------------------------------------------------------------------------------------------------------
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include "timeutil.h"
+
+char const * const appTitle = "Benchmark of mtbmpi::FormatTimeStamp";
+
+typedef std::chrono::steady_clock	Clock;
+
+double Seconds ( Clock::time_point const start )
+{
+    return std::chrono::duration<double>( Clock::now() - start ).count();
+}
+
+void Report (
+    char const * const name,
+    double const seconds,
+    int const count,
+    double const baseSeconds,
+    std::string const & example )
+{
+    cout << "  " << name
+	 << ": " << 1.0e9 * seconds / count << " ns each"
+	 << ", speedup = " << baseSeconds / seconds
+	 << ", e.g. " << example
+	 << endl;
+}
+
+int main (int argc, char **argv)
+{
+    int const count = ( argc > 1 ? std::atoi( argv[1] ) : 1000000 );
+    cout << appTitle << endl
+	 << "  timestamps = " << count << endl;
+
+    // previous: strftime twice, then parse and reformat through string streams
+    std::size_t checksum = 0;
+    std::string oldStamp;
+    Clock::time_point start = Clock::now();
+    for ( int i = 0; i < count; ++i )
+    {
+	oldStamp = mtbmpi::MakeDateTimeStamp( mtbmpi::DateStr(), mtbmpi::TimeStr() );
+	checksum += oldStamp.size();
+    }
+    double const oldSeconds = Seconds( start );
+    Report( "MakeDateTimeStamp (previous) ", oldSeconds, count, oldSeconds, oldStamp );
+
+    char buffer[mtbmpi::timeStampBufferSize];
+    start = Clock::now();
+    for ( int i = 0; i < count; ++i )
+	checksum += mtbmpi::FormatTimeStamp( buffer, sizeof(buffer) );
+    Report( "FormatTimeStamp              ", Seconds( start ), count, oldSeconds, buffer );
+
+    start = Clock::now();
+    for ( int i = 0; i < count; ++i )
+	checksum += mtbmpi::FormatTimeStamp( buffer, sizeof(buffer), 6 );
+    Report( "FormatTimeStamp, microseconds", Seconds( start ), count, oldSeconds, buffer );
+
+    mtbmpi::SetTimeStampClock( mtbmpi::TimeStamp_Monotonic );
+    start = Clock::now();
+    for ( int i = 0; i < count; ++i )
+	checksum += mtbmpi::FormatTimeStamp( buffer, sizeof(buffer), 6 );
+    Report( "FormatTimeStamp, monotonic   ", Seconds( start ), count, oldSeconds, buffer );
+
+    start = Clock::now();
+    for ( int i = 0; i < count; ++i )
+	checksum += mtbmpi::MakeDateTimeStamp().size();
+    Report( "MakeDateTimeStamp (now)      ", Seconds( start ), count, oldSeconds,
+	    mtbmpi::MakeDateTimeStamp() );
+
+    cout << "  checksum = " << checksum << endl;
+    return 0;
+}
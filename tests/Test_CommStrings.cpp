@@ -58,8 +58,8 @@ std::string MakeRanksString ( std::vector<int> const & ranks )
 
 void StopBlackboard ()
 {
-    // send request stop
-    mtbmpi::comm.Send ( 0, 0, MPI::BYTE, 1, mtbmpi::Tag_StopBlackboard );
+    // send request stop; on logComm, after this rank's log messages
+    mtbmpi::logComm.Send ( 0, 0, MPI::BYTE, 1, mtbmpi::Tag_StopBlackboard );
     // wait for confirmation
     mtbmpi::comm.Recv ( 0, 0, MPI::BYTE, 1, mtbmpi::Tag_Confirmation );
     // time for BB to actually stop
@@ -122,6 +122,35 @@ void ReceiveStrings (
     logger.Message( oss.str() );
 }
 
+void ScatterStrings (
+    mtbmpi::Communicator & comm )
+{
+    int const myRank = comm.GetGroup().Get_rank();
+    mtbmpi::LoggerMPI logger ( 1 );
+
+    // root makes different strings for each rank
+    std::vector< mtbmpi::StrVec > strVecs;
+    if ( myRank == 0 )
+    {
+	for ( int rank = 0; rank < comm.GetComm().Get_size(); ++rank )
+	{
+	    std::ostringstream oss;
+	    oss << "arguments for rank " << rank;
+	    strVecs.push_back( { oss.str(), "--option", std::string( 3000, 'x' ) } );
+	}
+    }
+
+    mtbmpi::StrVec strVec;
+    mtbmpi::CommStrings commStrings ( myRank, logger, comm );
+    commStrings.Scatterv( 0, strVecs, strVec );
+    std::ostringstream oss;
+    oss << "Scatterv received " << strVec.size() << " strings: "
+	<< ( strVec.empty() ? std::string() : strVec.front() )
+	<< ": last string length = "
+	<< ( strVec.empty() ? 0 : strVec.back().size() );
+    DisplayMsg( myRank, oss.str() );
+}
+
 //------------------------------------------------------------------------------------------------------------
 
 int main (int argc, char **argv)
@@ -132,6 +161,7 @@ int main (int argc, char **argv)
 	MPI::Init( argc, argv );
 	MPI::COMM_WORLD.Set_errhandler( MPI::ERRORS_THROW_EXCEPTIONS );
 	mtbmpi::comm = MPI::COMM_WORLD.Dup();
+	mtbmpi::CreateTrafficComms();		// log and result messages to the Blackboard
 
 	myRank = MPI::COMM_WORLD.Get_rank();
 	if ( myRank == 0 )
@@ -162,6 +192,10 @@ int main (int argc, char **argv)
 	    ReceiveStrings( comm );
 	}
 
+	/// test CommStrings::Scatterv
+	if ( myRank != 1 )			// Master and tasks
+	    ScatterStrings( comm );
+
 	if ( myRank == 0 )
 	    StopBlackboard();
 	comm.Close();
@@ -0,0 +1,239 @@
+//------------------------------------------------------------------------------------------------------------
+// File: mtbmpi-logdump.cpp
+// Converts binary MTBMPI log files (NAME.mtblog) to the text log format.
+// The binary log is written when the option `--mtbmpi-log-format=binary` is given;
+// its format is described in LogRecord.h.
+// Usage:
+//	mtbmpi-logdump [options] file...
+// Options:
+//	--rank=R[,R...]		only records from these ranks
+//	--level=NAME		only records at or above this level:
+//				trace, debug, info, warning, or error
+//	--from=TIME		only records at or after TIME
+//	--to=TIME		only records before TIME
+// TIME is a local date and time, yyyy-mm-dd_hh-mm-ss, or seconds since the epoch.
+// Rotated files are given in order; each one is decoded alone.
+// The payloads of records which are filtered out are skipped, not read.
+//
+// project	Master-Task-Blackboard MPI Framework
+// author	Thomas E. Hilinski <https://github.com/tehilinski>
+// copyright	Copyright 2020 Thomas E. Hilinski. All rights reserved.
+// 		This software library, including source code and documentation,
+// 		is licensed under the Apache License version 2.0.
+// 		See "LICENSE.md" for more information.
+//------------------------------------------------------------------------------------------------------------
+
+#include "LogRecord.h"
+#include "LogLevel.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+
+using namespace mtbmpi;
+
+char const * const appName = "mtbmpi-logdump";
+
+struct Filter
+{
+    std::vector<int> ranks;		// empty = all
+    int minLevel;
+    std::int64_t from;			// nanoseconds
+    std::int64_t to;
+
+    Filter ()
+      : minLevel ( LogLevel_Trace ),
+	from ( INT64_MIN ),
+	to ( INT64_MAX )
+    {
+    }
+
+    bool Accept ( LogRecordHeader const & header ) const
+    {
+	if ( header.level < minLevel || header.time < from || header.time >= to )
+	    return false;
+	return ranks.empty() ||
+	       std::find( ranks.begin(), ranks.end(), header.rank ) != ranks.end();
+    }
+};
+
+void Usage ()
+{
+    std::cerr << "Usage: " << appName
+	      << " [--rank=R[,R...]] [--level=NAME] [--from=TIME] [--to=TIME] file..." << '\n'
+	      << "  NAME = trace, debug, info, warning, or error" << '\n'
+	      << "  TIME = yyyy-mm-dd_hh-mm-ss (local time) or seconds since the epoch" << '\n';
+}
+
+// Returns false if not a time
+bool ParseTime ( std::string const & value, std::int64_t & nanoseconds )
+{
+    std::tm lt = std::tm();
+    char extra = 0;
+    if ( std::sscanf( value.c_str(), "%d-%d-%d_%d-%d-%d%c",
+		      &lt.tm_year, &lt.tm_mon, &lt.tm_mday,
+		      &lt.tm_hour, &lt.tm_min, &lt.tm_sec, &extra ) == 6 )
+    {
+	lt.tm_year -= 1900;
+	lt.tm_mon -= 1;
+	lt.tm_isdst = -1;
+	std::time_t const seconds = std::mktime( &lt );
+	if ( seconds == static_cast<std::time_t>( -1 ) )
+	    return false;
+	nanoseconds = static_cast<std::int64_t>( seconds ) * 1000000000LL;
+	return true;
+    }
+    char * end = nullptr;
+    long long const seconds = std::strtoll( value.c_str(), &end, 10 );
+    if ( value.empty() || *end != '\0' )
+	return false;
+    nanoseconds = seconds * 1000000000LL;
+    return true;
+}
+
+// Returns false if not a rank list
+bool ParseRanks ( std::string const & value, std::vector<int> & ranks )
+{
+    char const * p = value.c_str();
+    while ( *p )
+    {
+	char * end = nullptr;
+	long const rank = std::strtol( p, &end, 10 );
+	if ( end == p || ( *end != ',' && *end != '\0' ) )
+	    return false;
+	ranks.push_back( static_cast<int>( rank ) );
+	p = ( *end == ',' ? end + 1 : end );
+    }
+    return !ranks.empty();
+}
+
+// Returns false if an option is not valid
+bool ParseOption ( std::string const & arg, Filter & filter )
+{
+    std::string::size_type const eq = arg.find( '=' );
+    if ( eq == std::string::npos )
+	return false;
+    std::string const name = arg.substr( 0, eq );
+    std::string const value = arg.substr( eq + 1 );
+    if ( name == "--rank" )
+	return ParseRanks( value, filter.ranks );
+    if ( name == "--level" )
+    {
+	filter.minLevel = ToLogLevel( value, LogLevel_Off );
+	return filter.minLevel != LogLevel_Off;
+    }
+    if ( name == "--from" )
+	return ParseTime( value, filter.from );
+    if ( name == "--to" )
+	return ParseTime( value, filter.to );
+    return false;
+}
+
+// Returns the number of records written, or -1 if the file cannot be read
+long long Dump ( std::string const & fileName, Filter const & filter, std::ostream & os )
+{
+    std::ifstream ifs ( fileName.c_str(), std::ios::in | std::ios::binary );
+    char fileHeader[logFileHeaderSize];
+    if ( !ifs.read( fileHeader, logFileHeaderSize ) ||
+	 !IsLogFileHeader( fileHeader, logFileHeaderSize ) )
+    {
+	std::cerr << appName << ": not a binary log file: " << fileName << '\n';
+	return -1;
+    }
+
+    typedef std::map<std::uint32_t, std::string>	TemplateMap;
+    TemplateMap templates;
+    char encoded[logRecordHeaderSize];
+    LogRecordHeader header;
+    std::string payload;
+    std::string msg;
+    std::string line;
+    long long count = 0;
+    while ( ifs.read( encoded, logRecordHeaderSize ) )
+    {
+	DecodeLogRecordHeader( encoded, header );
+	bool const isTemplate = ( header.kind == LogRecord_Template );
+	if ( !isTemplate && !filter.Accept( header ) )
+	{
+	    ifs.seekg( header.size, std::ios::cur );
+	    continue;
+	}
+	payload.resize( header.size );
+	if ( header.size > 0 && !ifs.read( &payload[0], header.size ) )
+	    break;
+	if ( isTemplate )
+	{
+	    templates[header.templateID] = payload;
+	    continue;
+	}
+	if ( header.kind == LogRecord_Message && header.templateID != 0 )
+	{
+	    TemplateMap::const_iterator const t = templates.find( header.templateID );
+	    if ( t == templates.end() ||
+		 !ExpandLogTemplate( t->second, payload.data(), payload.size(), msg ) )
+	    {
+		std::cerr << appName << ": bad record in " << fileName
+			  << ": template " << header.templateID << '\n';
+		continue;
+	    }
+	}
+	else
+	{
+	    msg.swap( payload );
+	}
+	FormatLogRecord( header, msg, line );
+	os << line << '\n';
+	++count;
+    }
+    if ( !ifs.eof() )
+	std::cerr << appName << ": read error in " << fileName << '\n';
+    else if ( ifs.gcount() != 0 )
+	std::cerr << appName << ": incomplete record at the end of " << fileName << '\n';
+    return count;
+}
+
+int main (int argc, char **argv)
+{
+    std::ios::sync_with_stdio( false );
+    Filter filter;
+    std::vector<std::string> files;
+    for ( int i = 1; i < argc; ++i )
+    {
+	std::string const arg = argv[i];
+	if ( arg == "-h" || arg == "--help" )
+	{
+	    Usage ();
+	    return 0;
+	}
+	if ( arg.compare( 0, 2, "--" ) == 0 )
+	{
+	    if ( !ParseOption( arg, filter ) )
+	    {
+		std::cerr << appName << ": invalid option: " << arg << '\n';
+		Usage ();
+		return 1;
+	    }
+	}
+	else
+	    files.push_back( arg );
+    }
+    if ( files.empty() )
+    {
+	Usage ();
+	return 1;
+    }
+
+    int status = 0;
+    for ( std::vector<std::string>::const_iterator f = files.begin(); f != files.end(); ++f )
+    {
+	if ( Dump( *f, filter, std::cout ) < 0 )
+	    status = 1;
+    }
+    std::cout.flush();
+    return status;
+}